@@ -2,7 +2,7 @@
 
 #include <algorithm>
 #include <cstdint>
-#include <list>
+#include <cstring>
 
 #include "automap.h"
 #include "control.h"
@@ -234,55 +234,89 @@ void FindRangedTarget()
 	}
 }
 
-void FindMeleeTarget()
+/** Counts the game logic iterations, the targets of a search can only change between iterations */
+uint32_t GameLogicTicks;
+
+struct MeleeSearchNode {
+	Point position;
+	int steps;
+};
+
+/** Each tile is queued at most once per search, so the queue never has to wrap */
+MeleeSearchNode MeleeSearchQueue[MAXDUNX * MAXDUNY];
+/** Tiles marked with an older generation haven't been visited by the current search */
+uint16_t MeleeSearchVisited[MAXDUNX][MAXDUNY];
+uint16_t MeleeSearchGeneration;
+
+/** The outcome of the last melee target search and what it depended on */
+struct MeleeSearchResult {
+	bool valid;
+	uint32_t tick;
+	int level;
+	bool isSetLevel;
+	Point position;
+	Direction facing;
+	int target;
+} LastMeleeSearch;
+
+void StartMeleeSearch()
+{
+	MeleeSearchGeneration++;
+	if (MeleeSearchGeneration == 0) {
+		memset(MeleeSearchVisited, 0, sizeof(MeleeSearchVisited));
+		MeleeSearchGeneration = 1;
+	}
+}
+
+bool IsVisited(Point position)
+{
+	return MeleeSearchVisited[position.x][position.y] == MeleeSearchGeneration;
+}
+
+void MarkVisited(Point position)
+{
+	MeleeSearchVisited[position.x][position.y] = MeleeSearchGeneration;
+}
+
+void SearchMeleeTarget()
 {
-	bool visited[MAXDUNX][MAXDUNY] = { {} };
 	int maxSteps = 25; // Max steps for FindPath is 25
 	int rotations = 0;
 	bool canTalk = false;
 
-	struct SearchNode {
-		int x, y;
-		int steps;
-	};
-	std::list<SearchNode> queue;
-
 	auto &myPlayer = Players[MyPlayerId];
 
-	{
-		const int startX = myPlayer.position.future.x;
-		const int startY = myPlayer.position.future.y;
-		visited[startX][startY] = true;
-		queue.push_back({ startX, startY, 0 });
-	}
+	StartMeleeSearch();
+	size_t queueBegin = 0;
+	size_t queueEnd = 0;
+	MarkVisited(myPlayer.position.future);
+	MeleeSearchQueue[queueEnd++] = { myPlayer.position.future, 0 };
 
-	while (!queue.empty()) {
-		SearchNode node = queue.front();
-		queue.pop_front();
+	while (queueBegin < queueEnd) {
+		const MeleeSearchNode node = MeleeSearchQueue[queueBegin++];
 
 		for (auto pathDir : PathDirs) {
-			const int dx = node.x + pathDir.deltaX;
-			const int dy = node.y + pathDir.deltaY;
+			const Point tile = node.position + pathDir;
 
-			if (visited[dx][dy])
+			if (IsVisited(tile))
 				continue; // already visisted
 
 			if (node.steps > maxSteps) {
-				visited[dx][dy] = true;
+				MarkVisited(tile);
 				continue;
 			}
 
-			if (!PosOkPlayer(myPlayer, { dx, dy })) {
-				visited[dx][dy] = true;
+			if (!PosOkPlayer(myPlayer, tile)) {
+				MarkVisited(tile);
 
-				if (dMonster[dx][dy] != 0) {
-					const int mi = dMonster[dx][dy] > 0 ? dMonster[dx][dy] - 1 : -(dMonster[dx][dy] + 1);
+				if (dMonster[tile.x][tile.y] != 0) {
+					const int mi = dMonster[tile.x][tile.y] > 0 ? dMonster[tile.x][tile.y] - 1 : -(dMonster[tile.x][tile.y] + 1);
 					const auto &monster = Monsters[mi];
 					if (CanTargetMonster(monster)) {
 						const bool newCanTalk = CanTalkToMonst(monster);
 						if (pcursmonst != -1 && !canTalk && newCanTalk)
 							continue;
-						const int newRotations = GetRotaryDistance({ dx, dy });
+						const int newRotations = GetRotaryDistance(tile);
 						if (pcursmonst != -1 && canTalk == newCanTalk && rotations < newRotations)
 							continue;
 						rotations = newRotations;
@@ -296,14 +330,42 @@ void FindMeleeTarget()
 				continue;
 			}
 
-			if (path_solid_pieces({ node.x, node.y }, { dx, dy })) {
-				queue.push_back({ dx, dy, node.steps + 1 });
-				visited[dx][dy] = true;
+			if (path_solid_pieces(node.position, tile)) {
+				MeleeSearchQueue[queueEnd++] = { tile, node.steps + 1 };
+				MarkVisited(tile);
 			}
 		}
 	}
 }
 
+/**
+ * @brief Search the monster closest to the player by walking distance
+ *
+ * The search is only repeated when the game logic ran or the player moved or turned, as it gives the same answer
+ * for every frame in between.
+ */
+void FindMeleeTarget()
+{
+	const auto &myPlayer = Players[MyPlayerId];
+	MeleeSearchResult &last = LastMeleeSearch;
+	if (last.valid
+	    && last.tick == GameLogicTicks
+	    && last.level == currlevel
+	    && last.isSetLevel == setlevel
+	    && last.position == myPlayer.position.future
+	    && last.facing == myPlayer._pdir
+	    && pcursmonst == -1
+	    && (last.target == -1 || CanTargetMonster(Monsters[last.target]))) {
+		pcursmonst = last.target;
+		return;
+	}
+
+	const bool fromScratch = pcursmonst == -1;
+	SearchMeleeTarget();
+	// The search also depends on the target that was found before it, only reuse searches that start without one
+	last = { fromScratch, GameLogicTicks, currlevel, setlevel, myPlayer.position.future, myPlayer._pdir, pcursmonst };
+}
+
 void CheckMonstersNearby()
 {
 	if (Players[MyPlayerId].UsesRangedWeapon() || HasRangedSpell()) {
@@ -1335,6 +1397,7 @@ void plrctrls_every_frame()
 
 void plrctrls_after_game_logic()
 {
+	GameLogicTicks++;
 	Movement(MyPlayerId);
 }
 
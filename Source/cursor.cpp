@@ -119,9 +119,9 @@ int icursW;
 /** Pixel height of the current cursor image */
 int icursH;
 /** Current highlighted item */
-int8_t pcursitem;
+int pcursitem;
 /** Current highlighted object */
-int8_t pcursobj;
+int pcursobj;
 /** Current highlighted player */
 int8_t pcursplr;
 /** Current highlighted tile row */
@@ -650,7 +650,7 @@ void CheckCursMove()
 	}
 	if (pcursmonst == -1 && pcursplr == -1) {
 		if (!flipflag && mx + 1 < MAXDUNX && dObject[mx + 1][my] != 0) {
-			int8_t bv = dObject[mx + 1][my] > 0 ? dObject[mx + 1][my] - 1 : -(dObject[mx + 1][my] + 1);
+			int bv = dObject[mx + 1][my] > 0 ? dObject[mx + 1][my] - 1 : -(dObject[mx + 1][my] + 1);
 			if (Objects[bv]._oSelFlag >= 2) {
 				cursmx = mx + 1;
 				cursmy = my;
@@ -658,7 +658,7 @@ void CheckCursMove()
 			}
 		}
 		if (flipflag && my + 1 < MAXDUNY && dObject[mx][my + 1] != 0) {
-			int8_t bv = dObject[mx][my + 1] > 0 ? dObject[mx][my + 1] - 1 : -(dObject[mx][my + 1] + 1);
+			int bv = dObject[mx][my + 1] > 0 ? dObject[mx][my + 1] - 1 : -(dObject[mx][my + 1] + 1);
 			if (Objects[bv]._oSelFlag >= 2) {
 				cursmx = mx;
 				cursmy = my + 1;
@@ -666,7 +666,7 @@ void CheckCursMove()
 			}
 		}
 		if (dObject[mx][my] != 0) {
-			int8_t bv = dObject[mx][my] > 0 ? dObject[mx][my] - 1 : -(dObject[mx][my] + 1);
+			int bv = dObject[mx][my] > 0 ? dObject[mx][my] - 1 : -(dObject[mx][my] + 1);
 			if (Objects[bv]._oSelFlag == 1 || Objects[bv]._oSelFlag == 3) {
 				cursmx = mx;
 				cursmy = my;
@@ -674,7 +674,7 @@ void CheckCursMove()
 			}
 		}
 		if (mx + 1 < MAXDUNX && my + 1 < MAXDUNY && dObject[mx + 1][my + 1] != 0) {
-			int8_t bv = dObject[mx + 1][my + 1] > 0 ? dObject[mx + 1][my + 1] - 1 : -(dObject[mx + 1][my + 1] + 1);
+			int bv = dObject[mx + 1][my + 1] > 0 ? dObject[mx + 1][my + 1] - 1 : -(dObject[mx + 1][my + 1] + 1);
 			if (Objects[bv]._oSelFlag >= 2) {
 				cursmx = mx + 1;
 				cursmy = my + 1;
@@ -684,7 +684,7 @@ void CheckCursMove()
 	}
 	if (pcursplr == -1 && pcursobj == -1 && pcursmonst == -1) {
 		if (!flipflag && mx + 1 < MAXDUNX && dItem[mx + 1][my] > 0) {
-			int8_t bv = dItem[mx + 1][my] - 1;
+			int bv = dItem[mx + 1][my] - 1;
 			if (Items[bv]._iSelFlag >= 2) {
 				cursmx = mx + 1;
 				cursmy = my;
@@ -692,7 +692,7 @@ void CheckCursMove()
 			}
 		}
 		if (flipflag && my + 1 < MAXDUNY && dItem[mx][my + 1] > 0) {
-			int8_t bv = dItem[mx][my + 1] - 1;
+			int bv = dItem[mx][my + 1] - 1;
 			if (Items[bv]._iSelFlag >= 2) {
 				cursmx = mx;
 				cursmy = my + 1;
@@ -700,7 +700,7 @@ void CheckCursMove()
 			}
 		}
 		if (dItem[mx][my] > 0) {
-			int8_t bv = dItem[mx][my] - 1;
+			int bv = dItem[mx][my] - 1;
 			if (Items[bv]._iSelFlag == 1 || Items[bv]._iSelFlag == 3) {
 				cursmx = mx;
 				cursmy = my;
@@ -708,7 +708,7 @@ void CheckCursMove()
 			}
 		}
 		if (mx + 1 < MAXDUNX && my + 1 < MAXDUNY && dItem[mx + 1][my + 1] > 0) {
-			int8_t bv = dItem[mx + 1][my + 1] - 1;
+			int bv = dItem[mx + 1][my + 1] - 1;
 			if (Items[bv]._iSelFlag >= 2) {
 				cursmx = mx + 1;
 				cursmy = my + 1;
@@ -39,8 +39,8 @@ extern int icursH28;
 extern int icursH;
 extern int8_t pcursinvitem;
 extern int icursW;
-extern int8_t pcursitem;
-extern int8_t pcursobj;
+extern int pcursitem;
+extern int pcursobj;
 extern int8_t pcursplr;
 extern int cursmx;
 extern int cursmy;
@@ -25,6 +25,7 @@
 #include "drlg_l2.h"
 #include "drlg_l3.h"
 #include "drlg_l4.h"
+#include "dvlnet/link_simulator.h"
 #include "dx.h"
 #include "encrypt.h"
 #include "engine/cel_sprite.hpp"
@@ -37,6 +38,7 @@
 #include "gmenu.h"
 #include "help.h"
 #include "init.h"
+#include "level_pregen.h"
 #include "lighting.h"
 #include "loadsave.h"
 #include "menu.h"
@@ -47,6 +49,7 @@
 #include "nthread.h"
 #include "objects.h"
 #include "options.h"
+#include "path_cache.h"
 #include "pfile.h"
 #include "plrmsg.h"
 #include "qol/common.h"
@@ -62,7 +65,11 @@
 #include "trigs.h"
 #include "utils/console.h"
 #include "utils/language.h"
+#include "utils/net_stats.h"
 #include "utils/paths.h"
+#include "utils/profiler.h"
+#include "utils/stdcompat/algorithm.hpp"
+#include "utils/timedemo.h"
 
 #ifndef NOSOUND
 #include "sound.h"
@@ -90,6 +97,7 @@ bool gbNestArt;
 bool gbBard;
 bool gbBarbarian;
 bool gbQuietMode = false;
+bool HeadlessMode = false;
 clicktype sgbMouseDown;
 uint16_t gnTickDelay = 50;
 char gszProductName[64] = "DevilutionX vUnknown";
@@ -192,6 +200,7 @@ void FreeGame()
 #ifdef _DEBUG
 	FreeDebugGFX();
 #endif
+	FreePregeneratedLevels();
 	FreeGameMem();
 }
 
@@ -797,6 +806,7 @@ void RunGameLoop(interface_mode uMsg)
 #endif
 
 	while (gbRunGame) {
+		demo::ProcessKeyframe();
 		while (FetchMessage(&msg)) {
 			if (msg.message == DVL_WM_QUIT) {
 				gbRunGameResult = false;
@@ -817,19 +827,29 @@ void RunGameLoop(interface_mode uMsg)
 		if (!runGameLoop) {
 			if (processInput)
 				ProcessInput();
+			// Nothing to simulate until the next tick, get the levels behind the stairs ready in the meantime, a couple of
+			// milliseconds at a time so frames keep coming. Demos are left alone, it would only skew the timedemo results.
+			if (!demo::IsRunning())
+				PregenerateAdjacentLevel(/*timeLimit=*/2);
 			if (!drawGame)
 				continue;
 			force_redraw |= 1;
 			DrawAndBlit();
+			timedemo::EndFrame();
 			continue;
 		}
 
 		diablo_color_cyc_logic();
 		multi_process_network_packets();
+		netstats::Update();
+		timedemo::BeginTick();
 		game_loop(gbGameLoopStartup);
+		timedemo::EndTick();
 		gbGameLoopStartup = false;
-		if (drawGame)
+		if (drawGame) {
 			DrawAndBlit();
+			timedemo::EndFrame();
+		}
 #ifdef GPERF_HEAP_FIRST_GAME_ITERATION
 		if (run_game_iteration++ == 0)
 			HeapProfilerDump("first_game_iteration");
@@ -874,7 +894,20 @@ void RunGameLoop(interface_mode uMsg)
 	printInConsole("    %-20s %-30s\n", /* TRANSLATORS: Commandline Option */ "--spawn", _("Force spawn mode even if diabdat.mpq is found"));
 	printInConsole("    %-20s %-30s\n", /* TRANSLATORS: Commandline Option */ "--record <#>", _("Record a demo file"));
 	printInConsole("    %-20s %-30s\n", /* TRANSLATORS: Commandline Option */ "--demo <#>", _("Play a demo file"));
+	printInConsole("    %-20s %-30s\n", /* TRANSLATORS: Commandline Option */ "--demo-seek <#>", _("Start demo playback at the given game tick"));
 	printInConsole("    %-20s %-30s\n", /* TRANSLATORS: Commandline Option */ "--timedemo", _("Disable all frame limiting during demo playback"));
+	printInConsole("    %-20s %-30s\n", /* TRANSLATORS: Commandline Option */ "--bench-json <file>", _("Write frame and tick time percentiles of the demo playback"));
+	printInConsole("    %-20s %-30s\n", /* TRANSLATORS: Commandline Option */ "--headless", _("Play a demo without window, rendering or audio"));
+	printInConsole("    %-20s %-30s\n", /* TRANSLATORS: Commandline Option */ "--tick-profiler", _("Show the time spent in each part of the game logic"));
+	printInConsole("    %-20s %-30s\n", /* TRANSLATORS: Commandline Option */ "--render-profiler", _("Show a graph of the time spent rendering each frame"));
+	printInConsole("    %-20s %-30s\n", /* TRANSLATORS: Commandline Option */ "--render-csv <file>", _("Write the render stage timings of recent frames on exit"));
+	printInConsole("    %-20s %-30s\n", /* TRANSLATORS: Commandline Option */ "--trace <file>", _("Write a Chrome trace of the game ticks and frames on exit"));
+	printInConsole("    %-20s %-30s\n", /* TRANSLATORS: Commandline Option */ "--net-stats", _("Show the latency and traffic of each player in multiplayer games"));
+	printInConsole("    %-20s %-30s\n", /* TRANSLATORS: Commandline Option */ "--net-stats-log <file>", _("Write the network statistics as JSON lines every second"));
+	printInConsole("    %-20s %-30s\n", /* TRANSLATORS: Commandline Option */ "--net-latency <ms>", _("Delay the packets sent in network games"));
+	printInConsole("    %-20s %-30s\n", /* TRANSLATORS: Commandline Option */ "--net-jitter <ms>", _("Delay the packets sent in network games by a random extra time"));
+	printInConsole("    %-20s %-30s\n", /* TRANSLATORS: Commandline Option */ "--net-loss <%>", _("Percentage of the packets sent in network games that have to be sent again"));
+	printInConsole("    %-20s %-30s\n", /* TRANSLATORS: Commandline Option */ "--net-bandwidth <KiB/s>", _("Limit the bandwidth of network games"));
 	printInConsole("%s", _(/* TRANSLATORS: Commandline Option */ "\nHellfire options:\n"));
 	printInConsole("    %-20s %-30s\n", /* TRANSLATORS: Commandline Option */ "--diablo", _("Force diablo mode even if hellfire.mpq is found"));
 	printInConsole("    %-20s %-30s\n", /* TRANSLATORS: Commandline Option */ "--nestart", _("Use alternate nest palette"));
@@ -898,8 +931,9 @@ void RunGameLoop(interface_mode uMsg)
 
 void DiabloParseFlags(int argc, char **argv)
 {
-	bool timedemo = false;
+	bool timeDemo = false;
 	int demoNumber = -1;
+	int demoSeekTick = 0;
 	int recordNumber = -1;
 	for (int i = 1; i < argc; i++) {
 		if (strcasecmp("-h", argv[i]) == 0 || strcasecmp("--help", argv[i]) == 0) {
@@ -914,8 +948,38 @@ void DiabloParseFlags(int argc, char **argv)
 		} else if (strcasecmp("--demo", argv[i]) == 0) {
 			demoNumber = SDL_atoi(argv[++i]);
 			gbShowIntro = false;
+		} else if (strcasecmp("--demo-seek", argv[i]) == 0) {
+			demoSeekTick = SDL_atoi(argv[++i]);
 		} else if (strcasecmp("--timedemo", argv[i]) == 0) {
-			timedemo = true;
+			timeDemo = true;
+		} else if (strcasecmp("--bench-json", argv[i]) == 0) {
+			timedemo::SetResultPath(argv[++i]);
+			timeDemo = true;
+		} else if (strcasecmp("--headless", argv[i]) == 0) {
+			HeadlessMode = true;
+			timeDemo = true;
+			gbShowIntro = false;
+		} else if (strcasecmp("--tick-profiler", argv[i]) == 0) {
+			profiler::EnableOverlay();
+		} else if (strcasecmp("--render-profiler", argv[i]) == 0) {
+			profiler::EnableRenderOverlay();
+		} else if (strcasecmp("--render-csv", argv[i]) == 0) {
+			profiler::SetRenderCsvPath(argv[++i]);
+		} else if (strcasecmp("--trace", argv[i]) == 0) {
+			profiler::SetTracePath(argv[++i]);
+			profiler::EnableRenderProfiler();
+		} else if (strcasecmp("--net-stats", argv[i]) == 0) {
+			netstats::EnableOverlay();
+		} else if (strcasecmp("--net-stats-log", argv[i]) == 0) {
+			netstats::SetLogPath(argv[++i]);
+		} else if (strcasecmp("--net-latency", argv[i]) == 0) {
+			net::simulated_conditions.latency = std::max(SDL_atoi(argv[++i]), 0);
+		} else if (strcasecmp("--net-jitter", argv[i]) == 0) {
+			net::simulated_conditions.jitter = std::max(SDL_atoi(argv[++i]), 0);
+		} else if (strcasecmp("--net-loss", argv[i]) == 0) {
+			net::simulated_conditions.loss = clamp(SDL_atoi(argv[++i]), 0, 100);
+		} else if (strcasecmp("--net-bandwidth", argv[i]) == 0) {
+			net::simulated_conditions.bandwidth = std::max(SDL_atoi(argv[++i]), 0) * 1024;
 		} else if (strcasecmp("--record", argv[i]) == 0) {
 			recordNumber = SDL_atoi(argv[++i]);
 		} else if (strcasecmp("--config-dir", argv[i]) == 0) {
@@ -979,8 +1043,20 @@ void DiabloParseFlags(int argc, char **argv)
 		}
 	}
 
-	if (demoNumber != -1)
-		demo::InitPlayBack(demoNumber, timedemo);
+	if (HeadlessMode && demoNumber == -1) {
+		// Without a window the demo is the only source of input
+		printInConsole("%s", _("--headless requires --demo <#>\n"));
+		diablo_quit(1);
+	}
+	if (timedemo::IsEnabled() && demoNumber == -1) {
+		printInConsole("%s", _("--bench-json requires --demo <#>\n"));
+		diablo_quit(1);
+	}
+
+	if (demoNumber != -1) {
+		demo::InitPlayBack(demoNumber, timeDemo);
+		demo::InitSeek(demoSeekTick);
+	}
 	if (recordNumber != -1)
 		demo::InitRecording(recordNumber);
 }
@@ -1042,8 +1118,13 @@ void DiabloInit()
 	DiabloInitScreen();
 
 #ifndef NOSOUND
-	snd_init();
-	was_snd_init = true;
+	if (HeadlessMode) {
+		gbSoundOn = false;
+		gbMusicOn = false;
+	} else {
+		snd_init();
+		was_snd_init = true;
+	}
 #endif
 
 	ui_sound_init();
@@ -1075,6 +1156,8 @@ void DiabloDeinit()
 {
 	FreeItemGFX();
 
+	profiler::Shutdown();
+
 	if (sbWasOptionsLoaded && !demo::IsRunning())
 		SaveOptions();
 	if (was_snd_init)
@@ -1176,7 +1259,7 @@ void CreateLevel(lvl_entry lvldir)
 		LoadRndLvlPal(DTYPE_TOWN);
 		break;
 	case DTYPE_CATHEDRAL:
-		CreateL5Dungeon(glSeedTbl[currlevel], lvldir);
+		CreateDungeonLayout(lvldir);
 		InitL1Triggers();
 		Freeupstairs();
 		if (currlevel < 21) {
@@ -1186,13 +1269,13 @@ void CreateLevel(lvl_entry lvldir)
 		}
 		break;
 	case DTYPE_CATACOMBS:
-		CreateL2Dungeon(glSeedTbl[currlevel], lvldir);
+		CreateDungeonLayout(lvldir);
 		InitL2Triggers();
 		Freeupstairs();
 		LoadRndLvlPal(DTYPE_CATACOMBS);
 		break;
 	case DTYPE_CAVES:
-		CreateL3Dungeon(glSeedTbl[currlevel], lvldir);
+		CreateDungeonLayout(lvldir);
 		InitL3Triggers();
 		Freeupstairs();
 		if (currlevel < 17) {
@@ -1202,7 +1285,7 @@ void CreateLevel(lvl_entry lvldir)
 		}
 		break;
 	case DTYPE_HELL:
-		CreateL4Dungeon(glSeedTbl[currlevel], lvldir);
+		CreateDungeonLayout(lvldir);
 		InitL4Triggers();
 		Freeupstairs();
 		LoadRndLvlPal(DTYPE_HELL);
@@ -1230,35 +1313,74 @@ void UpdateMonsterLights()
 	}
 }
 
+/**
+ * @brief Tags the part of the game logic that is about to run and starts timing it
+ */
+void SetGameLogicStep(GameLogicStep step)
+{
+	gGameLogicStep = step;
+
+	switch (step) {
+	case GameLogicStep::None:
+		profiler::EndPhase();
+		break;
+	case GameLogicStep::ProcessPlayers:
+		profiler::BeginPhase(profiler::TickPhase::ProcessPlayers);
+		break;
+	case GameLogicStep::ProcessMonsters:
+		profiler::BeginPhase(profiler::TickPhase::ProcessMonsters);
+		break;
+	case GameLogicStep::ProcessObjects:
+		profiler::BeginPhase(profiler::TickPhase::ProcessObjects);
+		break;
+	case GameLogicStep::ProcessMissiles:
+	case GameLogicStep::ProcessMissilesTown:
+		profiler::BeginPhase(profiler::TickPhase::ProcessMissiles);
+		break;
+	case GameLogicStep::ProcessItems:
+	case GameLogicStep::ProcessItemsTown:
+		profiler::BeginPhase(profiler::TickPhase::ProcessItems);
+		break;
+	case GameLogicStep::ProcessTowners:
+		profiler::BeginPhase(profiler::TickPhase::ProcessTowners);
+		break;
+	}
+}
+
 void GameLogic()
 {
+	profiler::BeginTick();
+	profiler::BeginPhase(profiler::TickPhase::ProcessInput);
 	if (!ProcessInput()) {
+		profiler::EndTick();
 		return;
 	}
 	if (gbProcessPlayers) {
-		gGameLogicStep = GameLogicStep::ProcessPlayers;
+		SetGameLogicStep(GameLogicStep::ProcessPlayers);
 		ProcessPlayers();
 	}
 	if (leveltype != DTYPE_TOWN) {
-		gGameLogicStep = GameLogicStep::ProcessMonsters;
+		SetGameLogicStep(GameLogicStep::ProcessMonsters);
 		ProcessMonsters();
-		gGameLogicStep = GameLogicStep::ProcessObjects;
+		SetGameLogicStep(GameLogicStep::ProcessObjects);
 		ProcessObjects();
-		gGameLogicStep = GameLogicStep::ProcessMissiles;
+		SetGameLogicStep(GameLogicStep::ProcessMissiles);
 		ProcessMissiles();
-		gGameLogicStep = GameLogicStep::ProcessItems;
+		SetGameLogicStep(GameLogicStep::ProcessItems);
 		ProcessItems();
+		profiler::BeginPhase(profiler::TickPhase::ProcessLightList);
 		ProcessLightList();
+		profiler::BeginPhase(profiler::TickPhase::ProcessVisionList);
 		ProcessVisionList();
 	} else {
-		gGameLogicStep = GameLogicStep::ProcessTowners;
+		SetGameLogicStep(GameLogicStep::ProcessTowners);
 		ProcessTowners();
-		gGameLogicStep = GameLogicStep::ProcessItemsTown;
+		SetGameLogicStep(GameLogicStep::ProcessItemsTown);
 		ProcessItems();
-		gGameLogicStep = GameLogicStep::ProcessMissilesTown;
+		SetGameLogicStep(GameLogicStep::ProcessMissilesTown);
 		ProcessMissiles();
 	}
-	gGameLogicStep = GameLogicStep::None;
+	SetGameLogicStep(GameLogicStep::None);
 
 #ifdef _DEBUG
 	if (debug_mode_key_inverted_v && GetAsyncKeyState(DVL_VK_SHIFT)) {
@@ -1266,14 +1388,20 @@ void GameLogic()
 	}
 #endif
 
+	profiler::BeginPhase(profiler::TickPhase::SoundUpdate);
 	sound_update();
 	ClearPlrMsg();
+	profiler::BeginPhase(profiler::TickPhase::CheckTriggers);
 	CheckTriggers();
+	profiler::BeginPhase(profiler::TickPhase::CheckQuests);
 	CheckQuests();
 	force_redraw |= 1;
+	profiler::BeginPhase(profiler::TickPhase::PfileUpdate);
 	pfile_update(false);
+	profiler::EndPhase();
 
 	plrctrls_after_game_logic();
+	profiler::EndTick();
 }
 
 void TimeoutCursor(bool bTimeout)
@@ -1908,6 +2036,9 @@ void DisableInputWndProc(uint32_t uMsg, int32_t /*wParam*/, int32_t lParam)
 
 void LoadGameLevel(bool firstflag, lvl_entry lvldir)
 {
+	// Before the tiles it works with get replaced
+	FinishPregeneration();
+
 	if (setseed != 0)
 		glSeedTbl[currlevel] = setseed;
 
@@ -2111,6 +2242,7 @@ void LoadGameLevel(bool firstflag, lvl_entry lvldir)
 	}
 
 	SetDungeonMicros();
+	InvalidateVision();
 
 	InitLightMax();
 	IncProgress();
@@ -2125,6 +2257,7 @@ void LoadGameLevel(bool firstflag, lvl_entry lvldir)
 		ProcessLightList();
 		ProcessVisionList();
 	}
+	InvalidatePathCache();
 
 	if (currlevel >= 21) {
 		if (currlevel == 21) {
@@ -18,7 +18,11 @@
 
 namespace devilution {
 
+#ifdef EXTENDED_LIMITS
+#define GAME_ID (gbIsHellfire ? (gbIsSpawn ? LoadBE32("HSHX") : LoadBE32("HRTX")) : (gbIsSpawn ? LoadBE32("DSHX") : LoadBE32("DRTX")))
+#else
 #define GAME_ID (gbIsHellfire ? (gbIsSpawn ? LoadBE32("HSHR") : LoadBE32("HRTL")) : (gbIsSpawn ? LoadBE32("DSHR") : LoadBE32("DRTL")))
+#endif
 
 #define NUMLEVELS 25
 
@@ -77,6 +81,11 @@ extern bool gbBarbarian;
  * @brief Don't show Messageboxes or other user-interaction. Needed for UnitTests.
  */
 extern bool gbQuietMode;
+/**
+ * @brief Run without window output, rendering or audio and tick the game logic as fast as possible.
+ * Only supported during demo playback, which provides the input.
+ */
+extern bool HeadlessMode;
 extern clicktype sgbMouseDown;
 extern uint16_t gnTickDelay;
 extern char gszProductName[64];
@@ -9,6 +9,7 @@
 #include "engine/point.hpp"
 #include "engine/random.hpp"
 #include "gendung.h"
+#include "level_pregen.h"
 #include "player.h"
 #include "quests.h"
 
@@ -2188,6 +2189,7 @@ void GenerateLevel(lvl_entry entry)
 		DRLG_InitTrans();
 
 		do {
+			PregenerationCheckpoint();
 			InitDungeonFlags();
 			FirstRoom();
 		} while (FindArea() < minarea);
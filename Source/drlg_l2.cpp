@@ -12,6 +12,7 @@
 #include "engine/load_file.hpp"
 #include "engine/random.hpp"
 #include "gendung.h"
+#include "level_pregen.h"
 #include "player.h"
 #include "quests.h"
 #include "setmaps.h"
@@ -2905,6 +2906,7 @@ void GenerateLevel(lvl_entry entry)
 {
 	bool doneflag = false;
 	while (!doneflag) {
+		PregenerationCheckpoint();
 		nRoomCnt = 0;
 		InitDungeonFlags();
 		DRLG_InitTrans();
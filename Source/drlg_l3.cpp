@@ -9,6 +9,7 @@
 #include "engine/load_file.hpp"
 #include "engine/random.hpp"
 #include "gendung.h"
+#include "level_pregen.h"
 #include "lighting.h"
 #include "monster.h"
 #include "objdat.h"
@@ -2229,6 +2230,7 @@ void GenerateLevel(lvl_entry entry)
 	do {
 		do {
 			do {
+				PregenerationCheckpoint();
 				InitDungeonFlags();
 				int x1 = GenerateRnd(20) + 10;
 				int y1 = GenerateRnd(20) + 10;
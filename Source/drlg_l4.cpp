@@ -8,6 +8,7 @@
 #include "engine/load_file.hpp"
 #include "engine/random.hpp"
 #include "gendung.h"
+#include "level_pregen.h"
 #include "monster.h"
 #include "multi.h"
 #include "objdat.h"
@@ -1310,6 +1311,7 @@ void GenerateLevel(lvl_entry entry)
 		DRLG_InitTrans();
 
 		do {
+			PregenerationCheckpoint();
 			InitDungeonFlags();
 			FirstRoom();
 			FixRim();
@@ -4,6 +4,7 @@
 #ifndef NONET
 #include "dvlnet/base_protocol.h"
 #include "dvlnet/cdwrap.h"
+#include "dvlnet/netsim.h"
 #ifndef DISABLE_ZERO_TIER
 #include "dvlnet/protocol_zt.h"
 #endif
@@ -25,10 +26,14 @@ std::unique_ptr<abstract_net> abstract_net::MakeNet(provider_t provider)
 	switch (provider) {
 #ifndef DISABLE_TCP
 	case SELCONN_TCP:
+		if (simulated_conditions.IsActive())
+			return std::make_unique<cdwrap<netsim<tcp_client>>>();
 		return std::make_unique<cdwrap<tcp_client>>();
 #endif
 #ifndef DISABLE_ZERO_TIER
 	case SELCONN_ZT:
+		if (simulated_conditions.IsActive())
+			return std::make_unique<cdwrap<netsim<base_protocol<protocol_zt>>>>();
 		return std::make_unique<cdwrap<base_protocol<protocol_zt>>>();
 #endif
 	case SELCONN_LOOPBACK:
@@ -12,6 +12,13 @@ namespace net {
 
 typedef std::vector<unsigned char> buffer_t;
 typedef unsigned long provider_t;
+
+/** Bytes owned by somebody else, like a frame inside a frame_queue */
+struct buffer_view {
+	const unsigned char *data;
+	size_t size;
+};
+
 class dvlnet_exception : public std::exception {
 public:
 	const char *what() const throw() override
@@ -28,6 +35,7 @@ public:
 	virtual bool SNetSendMessage(int dest, void *data, unsigned int size) = 0;
 	virtual bool SNetReceiveTurns(char **data, size_t *size, uint32_t *status) = 0;
 	virtual bool SNetSendTurn(char *data, unsigned int size) = 0;
+	virtual bool SNetFlush() = 0;
 	virtual void SNetGetProviderCaps(struct _SNETCAPS *caps) = 0;
 	virtual bool SNetRegisterEventHandler(event_type evtype, SEVTHANDLER func) = 0;
 	virtual bool SNetUnregisterEventHandler(event_type evtype) = 0;
@@ -35,6 +43,7 @@ public:
 	virtual bool SNetDropPlayer(int playerid, uint32_t flags) = 0;
 	virtual bool SNetGetOwnerTurnsWaiting(uint32_t *turns) = 0;
 	virtual bool SNetGetTurnsInTransit(uint32_t *turns) = 0;
+	virtual bool SNetGetNetStats(NetStats *stats) = 0;
 	virtual void setup_gameinfo(buffer_t info) = 0;
 	virtual ~abstract_net() = default;
 
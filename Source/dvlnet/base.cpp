@@ -1,12 +1,51 @@
 #include "dvlnet/base.h"
 
 #include <algorithm>
+#include <chrono>
 #include <cstring>
 #include <memory>
 
 namespace devilution {
 namespace net {
 
+namespace {
+
+/**
+ * @brief The kinds of entries of a PT_BUNDLE
+ *
+ * Each entry is the kind, the size of the data as a uint16_t and the data.
+ */
+enum bundle_entry : uint8_t {
+	BUNDLE_MESSAGE = 0x01,
+	BUNDLE_TURN = 0x02,
+	/** The time the bundle was sent, in milliseconds on the clock of the sender */
+	BUNDLE_TIMESTAMP = 0x03,
+	/** A BUNDLE_TIMESTAMP sent back to the player it came from, see bundle_echo */
+	BUNDLE_ECHO = 0x04,
+};
+
+#pragma pack(push, 1)
+struct bundle_echo {
+	plr_t player;
+	uint32_t timestamp;
+	/** Milliseconds from receiving the timestamp until sending it back */
+	uint16_t delay;
+};
+#pragma pack(pop)
+
+constexpr size_t BundleEntryHeaderSize = sizeof(uint8_t) + sizeof(uint16_t);
+
+uint32_t NowMs()
+{
+	using namespace std::chrono;
+	return static_cast<uint32_t>(duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count());
+}
+
+/** Queued entries are sent before the bundle outgrows this, well below the largest packet */
+constexpr size_t MaxBundleSize = 0x8000;
+
+} // namespace
+
 void base::setup_gameinfo(buffer_t info)
 {
 	game_init_info = std::move(info);
@@ -67,6 +106,8 @@ void base::RecvLocal(packet &pkt)
 {
 	if (pkt.Source() < MAX_PLRS) {
 		connected_table[pkt.Source()] = true;
+		peer_stats[pkt.Source()].packetsReceived++;
+		peer_stats[pkt.Source()].bytesReceived += pkt.Data().size();
 	}
 	switch (pkt.Type()) {
 	case PT_MESSAGE:
@@ -75,6 +116,9 @@ void base::RecvLocal(packet &pkt)
 	case PT_TURN:
 		turn_queue[pkt.Source()].push_back(pkt.Turn());
 		break;
+	case PT_BUNDLE:
+		RecvBundle(pkt);
+		break;
 	case PT_JOIN_ACCEPT:
 		HandleAccept(pkt);
 		break;
@@ -95,6 +139,8 @@ void base::RecvLocal(packet &pkt)
 				DisconnectNet(pkt.NewPlayer());
 				ClearMsg(pkt.NewPlayer());
 				turn_queue[pkt.NewPlayer()].clear();
+				peer_stats[pkt.NewPlayer()] = {};
+				echoes[pkt.NewPlayer()] = {};
 			}
 		} else {
 			ABORT(); // we were dropped by the owner?!?
@@ -125,18 +171,15 @@ bool base::SNetSendMessage(int playerId, void *data, unsigned int size)
 	    && (playerId < 0 || playerId >= MAX_PLRS))
 		abort();
 	auto *rawMessage = reinterpret_cast<unsigned char *>(data);
-	buffer_t message(rawMessage, rawMessage + size);
 	if (playerId == plr_self || playerId == SNPLAYER_ALL)
-		message_queue.emplace_back(plr_self, message);
+		message_queue.emplace_back(plr_self, buffer_t(rawMessage, rawMessage + size));
 	plr_t dest;
 	if (playerId == SNPLAYER_ALL || playerId == SNPLAYER_OTHERS)
 		dest = PLR_BROADCAST;
 	else
 		dest = playerId;
-	if (dest != plr_self) {
-		auto pkt = pktfty->make_packet<PT_MESSAGE>(plr_self, dest, message);
-		send(*pkt);
-	}
+	if (dest != plr_self)
+		QueueBundleEntry(dest, BUNDLE_MESSAGE, rawMessage, size);
 	return true;
 }
 
@@ -181,12 +224,118 @@ bool base::SNetSendTurn(char *data, unsigned int size)
 		ABORT();
 	turn_t turn;
 	std::memcpy(&turn, data, sizeof(turn));
-	auto pkt = pktfty->make_packet<PT_TURN>(plr_self, PLR_BROADCAST, turn);
-	send(*pkt);
-	turn_queue[plr_self].push_back(pkt->Turn());
+	QueueBundleEntry(PLR_BROADCAST, BUNDLE_TURN, &turn, sizeof(turn));
+	turn_queue[plr_self].push_back(turn);
 	return true;
 }
 
+bool base::SNetFlush()
+{
+	SendBundle();
+	return true;
+}
+
+void base::QueueBundleEntry(plr_t dest, uint8_t kind, const void *data, size_t size)
+{
+	if (size > UINT16_MAX)
+		ABORT();
+	// Entries for another destination start a new bundle, so that everybody receives them in the order they were sent
+	if (!bundle.empty() && (dest != bundle_dest || bundle.size() + BundleEntryHeaderSize + size > MaxBundleSize))
+		SendBundle();
+	bundle_dest = dest;
+	AppendBundleEntry(kind, data, size);
+}
+
+void base::AppendBundleEntry(uint8_t kind, const void *data, size_t size)
+{
+	const auto entrySize = static_cast<uint16_t>(size);
+	const auto *bytes = reinterpret_cast<const unsigned char *>(data);
+	bundle.push_back(kind);
+	bundle.insert(bundle.end(), packet_out::begin(entrySize), packet_out::end(entrySize));
+	bundle.insert(bundle.end(), bytes, bytes + size);
+}
+
+void base::SendBundle()
+{
+	if (bundle.empty())
+		return;
+
+	// Broadcasts go out every tick with the turns, they carry the round trip time measurements
+	if (bundle_dest == PLR_BROADCAST) {
+		const uint32_t now = NowMs();
+		AppendBundleEntry(BUNDLE_TIMESTAMP, &now, sizeof(now));
+		for (plr_t i = 0; i < MAX_PLRS; i++) {
+			echo_t &echo = echoes[i];
+			if (!echo.pending)
+				continue;
+			const bundle_echo entry { i, echo.timestamp, static_cast<uint16_t>(std::min<uint32_t>(now - echo.receivedAt, UINT16_MAX)) };
+			AppendBundleEntry(BUNDLE_ECHO, &entry, sizeof(entry));
+			echo.pending = false;
+		}
+	}
+
+	auto pkt = pktfty->make_packet<PT_BUNDLE>(plr_self, bundle_dest, bundle);
+	bundle.clear();
+	send(*pkt);
+
+	for (plr_t i = 0; i < MAX_PLRS; i++) {
+		if (i == plr_self || !connected_table[i] || (bundle_dest != PLR_BROADCAST && bundle_dest != i))
+			continue;
+		peer_stats[i].packetsSent++;
+		peer_stats[i].bytesSent += pkt->Data().size();
+	}
+}
+
+void base::RecvBundle(packet &pkt)
+{
+	const buffer_t &body = pkt.Message();
+	size_t offset = 0;
+	while (body.size() - offset >= BundleEntryHeaderSize) {
+		const uint8_t kind = body[offset];
+		uint16_t size;
+		std::memcpy(&size, &body[offset + 1], sizeof(size));
+		offset += BundleEntryHeaderSize;
+		if (size > body.size() - offset)
+			return;
+		const unsigned char *data = body.data() + offset;
+		offset += size;
+
+		switch (kind) {
+		case BUNDLE_MESSAGE:
+			message_queue.emplace_back(pkt.Source(), buffer_t(data, data + size));
+			break;
+		case BUNDLE_TURN:
+			if (size == sizeof(turn_t)) {
+				turn_t turn;
+				std::memcpy(&turn, data, sizeof(turn));
+				turn_queue[pkt.Source()].push_back(turn);
+			}
+			break;
+		case BUNDLE_TIMESTAMP:
+			if (size == sizeof(uint32_t) && pkt.Source() < MAX_PLRS) {
+				echo_t &echo = echoes[pkt.Source()];
+				std::memcpy(&echo.timestamp, data, sizeof(echo.timestamp));
+				echo.receivedAt = NowMs();
+				echo.pending = true;
+			}
+			break;
+		case BUNDLE_ECHO:
+			if (size == sizeof(bundle_echo) && pkt.Source() < MAX_PLRS) {
+				bundle_echo entry;
+				std::memcpy(&entry, data, sizeof(entry));
+				if (entry.player != plr_self)
+					break;
+				const uint32_t roundTripTime = std::max<int32_t>(static_cast<int32_t>(NowMs() - entry.timestamp - entry.delay), 0);
+				uint32_t &average = peer_stats[pkt.Source()].roundTripTime;
+				average = average == 0 ? roundTripTime : (7 * average + roundTripTime) / 8;
+			}
+			break;
+		default:
+			break;
+		}
+	}
+}
+
 void base::SNetGetProviderCaps(struct _SNETCAPS *caps)
 {
 	caps->size = 0;                  // engine writes only ?!?
@@ -223,6 +372,7 @@ bool base::SNetRegisterEventHandler(event_type evtype, SEVTHANDLER func)
 
 bool base::SNetLeaveGame(int type)
 {
+	SendBundle();
 	auto pkt = pktfty->make_packet<PT_DISCONNECT>(plr_self, PLR_BROADCAST,
 	    plr_self, type);
 	send(*pkt);
@@ -231,6 +381,7 @@ bool base::SNetLeaveGame(int type)
 
 bool base::SNetDropPlayer(int playerid, uint32_t flags)
 {
+	SendBundle();
 	auto pkt = pktfty->make_packet<PT_DISCONNECT>(plr_self,
 	    PLR_BROADCAST,
 	    (plr_t)playerid,
@@ -262,5 +413,19 @@ bool base::SNetGetTurnsInTransit(uint32_t *turns)
 	return true;
 }
 
+bool base::SNetGetNetStats(NetStats *stats)
+{
+	for (auto i = 0; i < MAX_PLRS; ++i) {
+		stats->peers[i] = peer_stats[i];
+		stats->peers[i].connected = i != plr_self && connected_table[i];
+		stats->peers[i].turnsQueued = turn_queue[i].size();
+	}
+	stats->turnsInTransit = turn_queue[plr_self].size();
+	stats->messagesQueued = message_queue.size();
+	stats->decryptFailures = pktfty != nullptr ? pktfty->DecryptFailures() : 0;
+	stats->cryptoTime = pktfty != nullptr ? std::chrono::duration_cast<std::chrono::microseconds>(pktfty->CryptoTime()).count() : 0;
+	return true;
+}
+
 } // namespace net
 } // namespace devilution
@@ -21,6 +21,7 @@ public:
 	virtual bool SNetSendMessage(int playerId, void *data, unsigned int size);
 	virtual bool SNetReceiveTurns(char **data, size_t *size, uint32_t *status);
 	virtual bool SNetSendTurn(char *data, unsigned int size);
+	virtual bool SNetFlush();
 	virtual void SNetGetProviderCaps(struct _SNETCAPS *caps);
 	virtual bool SNetRegisterEventHandler(event_type evtype,
 	    SEVTHANDLER func);
@@ -29,6 +30,7 @@ public:
 	virtual bool SNetDropPlayer(int playerid, uint32_t flags);
 	virtual bool SNetGetOwnerTurnsWaiting(uint32_t *turns);
 	virtual bool SNetGetTurnsInTransit(uint32_t *turns);
+	virtual bool SNetGetNetStats(NetStats *stats);
 
 	virtual void poll() = 0;
 	virtual void send(packet &pkt) = 0;
@@ -70,6 +72,25 @@ protected:
 
 	std::unique_ptr<packet_factory> pktfty;
 
+	/** Messages and turns for bundle_dest that haven't been sent yet, in the order they were queued */
+	buffer_t bundle;
+	plr_t bundle_dest = PLR_BROADCAST;
+
+	/** Counters reported by SNetGetNetStats */
+	std::array<NetPeerStats, MAX_PLRS> peer_stats = {};
+
+	/** Timestamp of the last bundle from a player, to be sent back for measuring the round trip time */
+	struct echo_t {
+		bool pending;
+		uint32_t timestamp;
+		uint32_t receivedAt;
+	};
+	std::array<echo_t, MAX_PLRS> echoes = {};
+
+	void QueueBundleEntry(plr_t dest, uint8_t kind, const void *data, size_t size);
+	void AppendBundleEntry(uint8_t kind, const void *data, size_t size);
+	void SendBundle();
+	void RecvBundle(packet &pkt);
 	void HandleAccept(packet &pkt);
 	void RecvLocal(packet &pkt);
 	void RunEventHandler(_SNETEVENT &ev);
@@ -203,6 +203,10 @@ void base_protocol<P>::recv()
 template <class P>
 void base_protocol<P>::handle_join_request(packet &pkt, endpoint sender)
 {
+	if (pkt.Version() != ProtocolVersion) {
+		// a build speaking another protocol
+		return;
+	}
 	plr_t i;
 	for (i = 0; i < MAX_PLRS; ++i) {
 		if (i != plr_self && !peers[i]) {
@@ -27,6 +27,7 @@ public:
 	virtual bool SNetSendMessage(int dest, void *data, unsigned int size);
 	virtual bool SNetReceiveTurns(char **data, size_t *size, uint32_t *status);
 	virtual bool SNetSendTurn(char *data, unsigned int size);
+	virtual bool SNetFlush();
 	virtual void SNetGetProviderCaps(struct _SNETCAPS *caps);
 	virtual bool SNetRegisterEventHandler(event_type evtype,
 	    SEVTHANDLER func);
@@ -35,6 +36,7 @@ public:
 	virtual bool SNetDropPlayer(int playerid, uint32_t flags);
 	virtual bool SNetGetOwnerTurnsWaiting(uint32_t *turns);
 	virtual bool SNetGetTurnsInTransit(uint32_t *turns);
+	virtual bool SNetGetNetStats(NetStats *stats);
 	virtual void setup_gameinfo(buffer_t info);
 	virtual std::string make_default_gamename();
 
@@ -105,6 +107,12 @@ bool cdwrap<T>::SNetSendTurn(char *data, unsigned int size)
 	return dvlnet_wrap->SNetSendTurn(data, size);
 }
 
+template <class T>
+bool cdwrap<T>::SNetFlush()
+{
+	return dvlnet_wrap->SNetFlush();
+}
+
 template <class T>
 void cdwrap<T>::SNetGetProviderCaps(struct _SNETCAPS *caps)
 {
@@ -155,6 +163,12 @@ bool cdwrap<T>::SNetGetTurnsInTransit(uint32_t *turns)
 	return dvlnet_wrap->SNetGetTurnsInTransit(turns);
 }
 
+template <class T>
+bool cdwrap<T>::SNetGetNetStats(NetStats *stats)
+{
+	return dvlnet_wrap->SNetGetNetStats(stats);
+}
+
 template <class T>
 std::string cdwrap<T>::make_default_gamename()
 {
@@ -0,0 +1,215 @@
+/**
+ * @file dedicated_server.cpp
+ *
+ * Headless server for TCP multiplayer games, it only relays the packets of the players and doesn't play itself.
+ *
+ * Each session is a tcp_server hosting one game on its own port. The sessions are spread over worker threads, each
+ * with its own io_context, so the sessions of one thread never run concurrently and need no locking.
+ */
+// A console program, SDL must not replace main
+#define SDL_MAIN_HANDLED
+
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <asio/signal_set.hpp>
+#include <asio/steady_timer.hpp>
+#include <asio/ts/io_context.hpp>
+
+#include "dvlnet/tcp_server.h"
+
+namespace devilution {
+namespace net {
+namespace {
+
+struct ServerOptions {
+	std::string bindAddress = "0.0.0.0";
+	unsigned short port = 6112;
+	std::string password;
+	int sessions = 1;
+	int threads = 0;
+	int statsInterval = 10;
+};
+
+void PrintUsage()
+{
+	std::cout << "Usage: devilutionx-server [options]\n\n"
+	          << "Hosts TCP multiplayer games, one game per port starting at --port. The first player to join a session\n"
+	          << "creates the game, with \"Relay Server\" set in the [Network] section of diablo.ini.\n\n"
+	          << "    --bind <address>        Address to listen on, defaults to 0.0.0.0\n"
+	          << "    --port <#>              Port of the first session, defaults to 6112\n"
+	          << "    --sessions <#>          Number of games to host, defaults to 1\n"
+	          << "    --password <password>   Password of the games, public games use none\n"
+	          << "    --threads <#>           Worker threads, defaults to one per core and at most one per session\n"
+	          << "    --stats-interval <#>    Seconds between the traffic reports, 0 to turn them off\n";
+}
+
+bool ParseOptions(int argc, char **argv, ServerOptions &options)
+{
+	for (int i = 1; i < argc; i++) {
+		const bool hasValue = i + 1 < argc;
+		if (strcmp(argv[i], "--bind") == 0 && hasValue) {
+			options.bindAddress = argv[++i];
+		} else if (strcmp(argv[i], "--port") == 0 && hasValue) {
+			options.port = static_cast<unsigned short>(atoi(argv[++i]));
+		} else if (strcmp(argv[i], "--sessions") == 0 && hasValue) {
+			options.sessions = std::max(atoi(argv[++i]), 1);
+		} else if (strcmp(argv[i], "--password") == 0 && hasValue) {
+			options.password = argv[++i];
+		} else if (strcmp(argv[i], "--threads") == 0 && hasValue) {
+			options.threads = std::max(atoi(argv[++i]), 1);
+		} else if (strcmp(argv[i], "--stats-interval") == 0 && hasValue) {
+			options.statsInterval = std::max(atoi(argv[++i]), 0);
+		} else {
+			return false;
+		}
+	}
+	return options.port != 0 && options.port + options.sessions - 1 <= 0xFFFF;
+}
+
+/** Keeps the reports of the worker threads from interleaving */
+std::mutex OutputMutex;
+
+void PrintStats(tcp_server &session, double seconds)
+{
+	const tcp_server_stats stats = session.TakeStats();
+	const int players = session.PlayerCount();
+	if (players == 0 && stats.packetsReceived == 0)
+		return;
+
+	const double relayTimeAverage = stats.writes > 0 ? stats.relayTimeTotal.count() / 1000.0 / stats.writes : 0;
+	std::lock_guard<std::mutex> lock(OutputMutex);
+	std::cout << std::fixed << std::setprecision(1)
+	          << "port " << session.Port() << ": " << players << " players"
+	          << ", in " << stats.packetsReceived / seconds << " packets/s " << stats.bytesReceived / seconds / 1024 << " KiB/s"
+	          << ", out " << stats.packetsSent / seconds << " packets/s " << stats.bytesSent / seconds / 1024 << " KiB/s"
+	          << std::setprecision(2)
+	          << ", relay time avg " << relayTimeAverage << " ms max " << stats.relayTimeMax.count() / 1000.0 << " ms"
+	          << std::endl;
+}
+
+class Worker {
+public:
+	explicit Worker(int statsInterval)
+	    : statsInterval_(statsInterval)
+	{
+	}
+
+	void AddSession(const ServerOptions &options, unsigned short port)
+	{
+		sessions_.push_back(std::make_unique<tcp_server>(ioc_, options.bindAddress, port, options.password));
+	}
+
+	void Start()
+	{
+		if (statsInterval_ > 0)
+			StartStatsTimer();
+		thread_ = std::thread([this]() { Run(); });
+	}
+
+	void Stop()
+	{
+		ioc_.stop();
+	}
+
+	void Join()
+	{
+		thread_.join();
+	}
+
+private:
+	asio::io_context ioc_;
+	asio::steady_timer statsTimer_ { ioc_ };
+	std::vector<std::unique_ptr<tcp_server>> sessions_;
+	std::thread thread_;
+	int statsInterval_;
+
+	void Run()
+	{
+		while (true) {
+			try {
+				ioc_.run();
+				return;
+			} catch (const std::exception &e) {
+				// tcp_server drops the connection whose packet it fails to handle, what ends up here isn't tied to a
+				// connection, so keep serving the sessions
+				std::lock_guard<std::mutex> lock(OutputMutex);
+				std::cerr << "Network error: " << e.what() << std::endl;
+			}
+		}
+	}
+
+	void StartStatsTimer()
+	{
+		statsTimer_.expires_after(std::chrono::seconds(statsInterval_));
+		statsTimer_.async_wait([this](const asio::error_code &ec) {
+			if (ec)
+				return;
+			for (auto &session : sessions_)
+				PrintStats(*session, statsInterval_);
+			StartStatsTimer();
+		});
+	}
+};
+
+int RunServer(const ServerOptions &options)
+{
+	int threads = options.threads;
+	if (threads == 0)
+		threads = std::max(static_cast<int>(std::thread::hardware_concurrency()), 1);
+	threads = std::min(threads, options.sessions);
+
+	std::vector<std::unique_ptr<Worker>> workers;
+	for (int i = 0; i < threads; i++)
+		workers.push_back(std::make_unique<Worker>(options.statsInterval));
+	try {
+		for (int i = 0; i < options.sessions; i++)
+			workers[i % threads]->AddSession(options, static_cast<unsigned short>(options.port + i));
+	} catch (const std::system_error &e) {
+		std::cerr << "Unable to listen on " << options.bindAddress << ": " << e.what() << std::endl;
+		return 1;
+	}
+
+	for (auto &worker : workers)
+		worker->Start();
+	std::cout << "Hosting " << options.sessions << " sessions on ports " << options.port << "-" << options.port + options.sessions - 1
+	          << " with " << threads << " threads" << std::endl;
+
+	asio::io_context control;
+	asio::signal_set signals(control, SIGINT, SIGTERM);
+	signals.async_wait([&workers](const asio::error_code &, int) {
+		for (auto &worker : workers)
+			worker->Stop();
+	});
+	control.run();
+
+	for (auto &worker : workers)
+		worker->Join();
+	return 0;
+}
+
+} // namespace
+} // namespace net
+} // namespace devilution
+
+int main(int argc, char **argv)
+{
+	devilution::net::ServerOptions options;
+	if (!devilution::net::ParseOptions(argc, argv, options)) {
+		devilution::net::PrintUsage();
+		return 1;
+	}
+	return devilution::net::RunServer(options);
+}
@@ -1,79 +1,137 @@
 #include "dvlnet/frame_queue.h"
 
 #include <cstring>
+#include <utility>
 
 #include "dvlnet/packet.h"
 
 namespace devilution {
 namespace net {
 
-framesize_t frame_queue::Size() const
+namespace {
+
+/** Size of a frame of maximal size including the frame header */
+constexpr size_t MaxFrameWithHeader = sizeof(framesize_t) + frame_queue::max_frame_size;
+
+} // namespace
+
+frame_queue::frame_queue()
+    : buffer(2 * MaxFrameWithHeader)
 {
-	return current_size;
 }
 
-buffer_t frame_queue::Read(framesize_t s)
+size_t frame_queue::Size() const
 {
-	if (current_size < s)
-		throw frame_queue_exception();
-	buffer_t ret;
-	while (s > 0 && s >= buffer_deque.front().size()) {
-		s -= buffer_deque.front().size();
-		current_size -= buffer_deque.front().size();
-		ret.insert(ret.end(),
-		    buffer_deque.front().begin(),
-		    buffer_deque.front().end());
-		buffer_deque.pop_front();
-	}
-	if (s > 0) {
-		ret.insert(ret.end(),
-		    buffer_deque.front().begin(),
-		    buffer_deque.front().begin() + s);
-		buffer_deque.front().erase(buffer_deque.front().begin(),
-		    buffer_deque.front().begin() + s);
-		current_size -= s;
+	return end - begin;
+}
+
+void frame_queue::MakeRoom(size_t size)
+{
+	if (buffer.size() - end >= size)
+		return;
+	if (begin != 0) {
+		std::memmove(buffer.data(), buffer.data() + begin, Size());
+		end -= begin;
+		begin = 0;
 	}
-	return ret;
+	if (buffer.size() - end < size)
+		buffer.resize(end + size);
+}
+
+unsigned char *frame_queue::WriteBuffer()
+{
+	return buffer.data() + end;
+}
+
+size_t frame_queue::WriteBufferSize() const
+{
+	return buffer.size() - end;
+}
+
+void frame_queue::CommitWrite(size_t size)
+{
+	if (size > WriteBufferSize())
+		ABORT();
+	end += size;
 }
 
-void frame_queue::Write(buffer_t buf)
+void frame_queue::Write(const unsigned char *data, size_t size)
 {
-	current_size += buf.size();
-	buffer_deque.push_back(std::move(buf));
+	MakeRoom(size);
+	std::memcpy(buffer.data() + end, data, size);
+	end += size;
 }
 
 bool frame_queue::PacketReady()
 {
-	if (nextsize == 0) {
-		if (Size() < sizeof(framesize_t))
-			return false;
-		auto szbuf = Read(sizeof(framesize_t));
-		std::memcpy(&nextsize, &szbuf[0], sizeof(framesize_t));
-		if (nextsize == 0)
+	if (nextsize == 0 && Size() >= sizeof(framesize_t)) {
+		std::memcpy(&nextsize, buffer.data() + begin, sizeof(framesize_t));
+		if (nextsize == 0 || nextsize > max_frame_size)
 			throw frame_queue_exception();
+		begin += sizeof(framesize_t);
 	}
-	return Size() >= nextsize;
+	if (nextsize != 0 && Size() >= nextsize)
+		return true;
+
+	// All ready packets have been read, only the start of the next frame is left
+	if (begin == end) {
+		begin = 0;
+		end = 0;
+	} else {
+		MakeRoom(MaxFrameWithHeader);
+	}
+	return false;
 }
 
-buffer_t frame_queue::ReadPacket()
+buffer_view frame_queue::ReadPacket()
 {
 	if (nextsize == 0 || Size() < nextsize)
 		throw frame_queue_exception();
-	auto ret = Read(nextsize);
+	buffer_view ret { buffer.data() + begin, nextsize };
+	begin += nextsize;
 	nextsize = 0;
 	return ret;
 }
 
-buffer_t frame_queue::MakeFrame(buffer_t packetbuf)
+void frame_queue::AppendFrame(buffer_t &frames, const buffer_t &packetbuf)
 {
-	buffer_t ret;
 	if (packetbuf.size() > max_frame_size)
 		ABORT();
 	framesize_t size = packetbuf.size();
-	ret.insert(ret.end(), packet_out::begin(size), packet_out::end(size));
-	ret.insert(ret.end(), packetbuf.begin(), packetbuf.end());
+	frames.insert(frames.end(), packet_out::begin(size), packet_out::end(size));
+	frames.insert(frames.end(), packetbuf.begin(), packetbuf.end());
+}
+
+buffer_t frame_queue::MakeFrame(const buffer_t &packetbuf)
+{
+	buffer_t ret;
+	ret.reserve(sizeof(framesize_t) + packetbuf.size());
+	AppendFrame(ret, packetbuf);
 	return ret;
 }
 
+void frame_send_queue::Push(const buffer_t &packetbuf)
+{
+	frame_queue::AppendFrame(pending, packetbuf);
+}
+
+bool frame_send_queue::ReadyToSend() const
+{
+	return !busy && !pending.empty();
+}
+
+const buffer_t &frame_send_queue::BeginSend()
+{
+	std::swap(pending, sending);
+	pending.clear();
+	busy = true;
+	return sending;
+}
+
+void frame_send_queue::EndSend()
+{
+	busy = false;
+}
+
 } // namespace net
 } // namespace devilution
@@ -1,16 +1,14 @@
 #pragma once
 
-#include <deque>
-#include <exception>
-#include <vector>
 #include <cstdint>
+#include <exception>
+
+#include "dvlnet/abstract_net.h"
 
 namespace devilution {
 namespace net {
 
-typedef std::vector<unsigned char> buffer_t;
-
-class frame_queue_exception : public std::exception {
+class frame_queue_exception : public dvlnet_exception {
 public:
 	const char *what() const throw() override
 	{
@@ -20,24 +18,68 @@ public:
 
 typedef uint32_t framesize_t;
 
+/**
+ * @brief Splits a stream of bytes into frames, each one a packet preceded by its size
+ *
+ * The bytes are kept in one contiguous buffer that is reused for the whole stream. Frames are parsed and handed out in
+ * place, the buffer is only moved around when the unread rest of the stream needs to go back to the front.
+ */
 class frame_queue {
 public:
 	constexpr static framesize_t max_frame_size = 0xFFFF;
 
+	frame_queue();
+
+	/**
+	 * @brief Free space at the end of the queue, for receiving into the queue without copying
+	 *
+	 * There is room for at least a whole frame as long as all ready packets get read. Pass the number of bytes
+	 * received to CommitWrite.
+	 */
+	unsigned char *WriteBuffer();
+	size_t WriteBufferSize() const;
+	void CommitWrite(size_t size);
+	void Write(const unsigned char *data, size_t size);
+
+	bool PacketReady();
+	/**
+	 * @brief The next packet, valid until PacketReady is called again or the queue is written to
+	 */
+	buffer_view ReadPacket();
+
+	static buffer_t MakeFrame(const buffer_t &packetbuf);
+	static void AppendFrame(buffer_t &frames, const buffer_t &packetbuf);
+
 private:
-	framesize_t current_size = 0;
-	std::deque<buffer_t> buffer_deque;
+	buffer_t buffer;
+	/** The unread part of the stream */
+	size_t begin = 0;
+	size_t end = 0;
 	framesize_t nextsize = 0;
 
-	framesize_t Size() const;
-	buffer_t Read(framesize_t s);
+	size_t Size() const;
+	void MakeRoom(size_t size);
+};
 
+/**
+ * @brief Frames waiting to be sent on a stream, with at most one write in progress
+ *
+ * Frames are gathered in a buffer that is reused for every write, the ones added while a write is in progress go out
+ * together with the next write.
+ */
+class frame_send_queue {
 public:
-	bool PacketReady();
-	buffer_t ReadPacket();
-	void Write(buffer_t buf);
+	void Push(const buffer_t &packetbuf);
+	/** True if frames are waiting and no write is in progress */
+	bool ReadyToSend() const;
+	/** The frames for the next write, they stay in place until EndSend is called */
+	const buffer_t &BeginSend();
+	void EndSend();
 
-	static buffer_t MakeFrame(buffer_t packetbuf);
+private:
+	buffer_t pending;
+	buffer_t sending;
+	bool busy = false;
 };
 
 } // namespace net
@@ -0,0 +1,50 @@
+#include "dvlnet/link_simulator.h"
+
+#include <algorithm>
+
+namespace devilution {
+namespace net {
+
+namespace {
+
+/** Lower bound of the retransmission timeout, as in common TCP stacks */
+constexpr uint32_t MinRetransmitTimeout = 200;
+
+/** A packet that keeps getting lost still arrives after this many retransmissions */
+constexpr int MaxRetransmits = 5;
+
+} // namespace
+
+net_conditions simulated_conditions;
+
+link_simulator::link_simulator(const net_conditions &conditions, uint32_t seed)
+    : conditions(conditions)
+    , rng(seed)
+{
+}
+
+link_simulator::clock::duration link_simulator::RetransmitTimeout() const
+{
+	return std::chrono::milliseconds(std::max(MinRetransmitTimeout, 2 * (conditions.latency + conditions.jitter)));
+}
+
+link_simulator::clock::time_point link_simulator::Schedule(clock::time_point now, size_t size)
+{
+	// The packet is transmitted after the ones before it
+	clock::time_point transmitted = std::max(now, link_free);
+	if (conditions.bandwidth != 0)
+		transmitted += std::chrono::microseconds(static_cast<uint64_t>(size) * 1000000 / conditions.bandwidth);
+	link_free = transmitted;
+
+	clock::duration delay = std::chrono::milliseconds(conditions.latency);
+	if (conditions.jitter != 0)
+		delay += std::chrono::milliseconds(rng() % (conditions.jitter + 1));
+	for (int i = 0; i < MaxRetransmits && rng() % 100 < conditions.loss; i++)
+		delay += RetransmitTimeout();
+
+	last_arrival = std::max(transmitted + delay, last_arrival);
+	return last_arrival;
+}
+
+} // namespace net
+} // namespace devilution
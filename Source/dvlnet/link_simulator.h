@@ -0,0 +1,59 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+
+namespace devilution {
+namespace net {
+
+/**
+ * @brief Conditions of a slow network, for testing multiplayer games on one machine
+ */
+struct net_conditions {
+	/** Milliseconds added to every packet */
+	uint32_t latency = 0;
+	/** Up to this many milliseconds added at random to every packet */
+	uint32_t jitter = 0;
+	/** Percentage of packets that are lost and have to be sent again */
+	uint32_t loss = 0;
+	/** Bytes per second, 0 for no limit */
+	uint32_t bandwidth = 0;
+
+	bool IsActive() const
+	{
+		return latency != 0 || jitter != 0 || loss != 0 || bandwidth != 0;
+	}
+};
+
+/** The conditions simulated for the packets sent in network games, set from the command line */
+extern net_conditions simulated_conditions;
+
+/**
+ * @brief Decides when the packets sent over a simulated connection arrive
+ *
+ * The connection behaves like a stream: packets arrive in the order they were sent, so a packet that is delayed
+ * by jitter or lost and sent again holds up the ones behind it.
+ */
+class link_simulator {
+public:
+	using clock = std::chrono::steady_clock;
+
+	link_simulator(const net_conditions &conditions, uint32_t seed);
+
+	/** @brief The time at which a packet of the given size that is sent now arrives */
+	clock::time_point Schedule(clock::time_point now, size_t size);
+
+private:
+	net_conditions conditions;
+	std::minstd_rand rng;
+	/** The time the last packet has been transmitted, limited by the bandwidth */
+	clock::time_point link_free;
+	clock::time_point last_arrival;
+
+	clock::duration RetransmitTimeout() const;
+};
+
+} // namespace net
+} // namespace devilution
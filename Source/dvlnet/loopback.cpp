@@ -51,6 +51,11 @@ bool loopback::SNetSendTurn(char * /*data*/, unsigned int /*size*/)
 	return true;
 }
 
+bool loopback::SNetFlush()
+{
+	return true;
+}
+
 void loopback::SNetGetProviderCaps(struct _SNETCAPS *caps)
 {
 	caps->size = 0;                  // engine writes only ?!?
@@ -106,6 +111,11 @@ bool loopback::SNetGetTurnsInTransit(uint32_t *turns)
 	return true;
 }
 
+bool loopback::SNetGetNetStats(NetStats * /*stats*/)
+{
+	return false;
+}
+
 std::string loopback::make_default_gamename()
 {
 	return std::string(_("loopback"));
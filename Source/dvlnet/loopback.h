@@ -26,6 +26,7 @@ public:
 	virtual bool SNetSendMessage(int dest, void *data, unsigned int size);
 	virtual bool SNetReceiveTurns(char **data, size_t *size, uint32_t *status);
 	virtual bool SNetSendTurn(char *data, unsigned int size);
+	virtual bool SNetFlush();
 	virtual void SNetGetProviderCaps(struct _SNETCAPS *caps);
 	virtual bool SNetRegisterEventHandler(event_type evtype, SEVTHANDLER func);
 	virtual bool SNetUnregisterEventHandler(event_type evtype);
@@ -33,6 +34,7 @@ public:
 	virtual bool SNetDropPlayer(int playerid, uint32_t flags);
 	virtual bool SNetGetOwnerTurnsWaiting(uint32_t *turns);
 	virtual bool SNetGetTurnsInTransit(uint32_t *turns);
+	virtual bool SNetGetNetStats(NetStats *stats);
 	virtual void setup_gameinfo(buffer_t info);
 	virtual std::string make_default_gamename();
 };
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <deque>
+#include <memory>
+#include <random>
+
+#include "dvlnet/link_simulator.h"
+#include "dvlnet/packet.h"
+
+namespace devilution {
+namespace net {
+
+/**
+ * @brief Holds back the packets sent by T as if they went over a slow network, see simulated_conditions
+ *
+ * Only the packets this instance sends are delayed, the other players have to simulate the same conditions for the
+ * whole round trip to be affected.
+ */
+template <class T>
+class netsim : public T {
+public:
+	netsim()
+	    : link(simulated_conditions, std::random_device()())
+	{
+	}
+
+	virtual void poll();
+	virtual void send(packet &pkt);
+
+	virtual bool SNetLeaveGame(int type);
+
+	virtual ~netsim() = default;
+
+protected:
+	/** @brief The current time, tests replace it to control when the packets arrive */
+	virtual link_simulator::clock::time_point Now() const
+	{
+		return link_simulator::clock::now();
+	}
+
+private:
+	struct delayed_packet {
+		link_simulator::clock::time_point arrival;
+		std::unique_ptr<packet> pkt;
+	};
+
+	link_simulator link;
+	/** Packets in the order they arrive */
+	std::deque<delayed_packet> delayed;
+	bool leaving = false;
+
+	void SendArrived(link_simulator::clock::time_point now);
+};
+
+template <class T>
+void netsim<T>::SendArrived(link_simulator::clock::time_point now)
+{
+	while (!delayed.empty() && delayed.front().arrival <= now) {
+		T::send(*delayed.front().pkt);
+		delayed.pop_front();
+	}
+}
+
+template <class T>
+void netsim<T>::poll()
+{
+	SendArrived(Now());
+	T::poll();
+}
+
+template <class T>
+void netsim<T>::send(packet &pkt)
+{
+	if (leaving) {
+		T::send(pkt);
+		return;
+	}
+	const auto arrival = link.Schedule(Now(), pkt.Data().size());
+	delayed.push_back({ arrival, std::make_unique<packet>(pkt) });
+}
+
+template <class T>
+bool netsim<T>::SNetLeaveGame(int type)
+{
+	// The connection is closed right after the disconnect is sent, nothing may be left behind
+	leaving = true;
+	SendArrived(link_simulator::clock::time_point::max());
+	return T::SNetLeaveGame(type);
+}
+
+} // namespace net
+} // namespace devilution
@@ -14,6 +14,8 @@ const char *packet_type_to_string(uint8_t packetType)
 		return "PT_MESSAGE";
 	case PT_TURN:
 		return "PT_TURN";
+	case PT_BUNDLE:
+		return "PT_BUNDLE";
 	case PT_JOIN_REQUEST:
 		return "PT_JOIN_REQUEST";
 	case PT_JOIN_ACCEPT:
@@ -96,7 +98,7 @@ const buffer_t &packet::Message()
 {
 	if (!have_decrypted)
 		ABORT();
-	CheckPacketTypeOneOf({ PT_MESSAGE }, m_type);
+	CheckPacketTypeOneOf({ PT_MESSAGE, PT_BUNDLE }, m_type);
 	return m_message;
 }
 
@@ -108,6 +110,14 @@ turn_t packet::Turn()
 	return m_turn;
 }
 
+uint32_t packet::Version()
+{
+	if (!have_decrypted)
+		ABORT();
+	CheckPacketTypeOneOf({ PT_JOIN_REQUEST }, m_type);
+	return m_version;
+}
+
 cookie_t packet::Cookie()
 {
 	if (!have_decrypted)
@@ -148,6 +158,14 @@ void packet_in::Create(buffer_t buf)
 	have_encrypted = true;
 }
 
+void packet_in::Create(buffer_view buf)
+{
+	if (have_encrypted || have_decrypted)
+		ABORT();
+	encrypted_buffer.assign(buf.data, buf.data + buf.size);
+	have_encrypted = true;
+}
+
 void packet_in::Decrypt()
 {
 	if (!have_encrypted)
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <chrono>
 #include <cstdint>
 #include <string>
 #include <memory>
@@ -19,6 +20,7 @@ enum packet_type : uint8_t {
 	// clang-format off
 	PT_MESSAGE      = 0x01,
 	PT_TURN         = 0x02,
+	PT_BUNDLE       = 0x03,
 	PT_JOIN_REQUEST = 0x11,
 	PT_JOIN_ACCEPT  = 0x12,
 	PT_CONNECT      = 0x13,
@@ -45,6 +47,13 @@ using key_t = uint8_t;
 static constexpr plr_t PLR_MASTER = 0xFE;
 static constexpr plr_t PLR_BROADCAST = 0xFF;
 
+/**
+ * @brief Version of the packet layouts, sent with every join request, the host turns away any other version
+ *
+ * Bump it whenever a packet type is added or changes. 2: PT_BUNDLE, earlier builds send no version at all.
+ */
+static constexpr uint32_t ProtocolVersion = 2;
+
 class packet_exception : public dvlnet_exception {
 public:
 	const char *what() const throw() override
@@ -73,6 +82,7 @@ protected:
 	plr_t m_dest;
 	buffer_t m_message;
 	turn_t m_turn;
+	uint32_t m_version;
 	cookie_t m_cookie;
 	plr_t m_newplr;
 	buffer_t m_info;
@@ -95,6 +105,7 @@ public:
 	plr_t Destination() const;
 	const buffer_t &Message();
 	turn_t Turn();
+	uint32_t Version();
 	cookie_t Cookie();
 	plr_t NewPlayer();
 	const buffer_t &Info();
@@ -112,6 +123,7 @@ class packet_in : public packet_proc<packet_in> {
 public:
 	using packet_proc<packet_in>::packet_proc;
 	void Create(buffer_t buf);
+	void Create(buffer_view buf);
 	void process_element(buffer_t &x);
 	template <class T>
 	void process_element(T &x);
@@ -144,12 +156,14 @@ void packet_proc<P>::process_data()
 	self.process_element(m_dest);
 	switch (m_type) {
 	case PT_MESSAGE:
+	case PT_BUNDLE:
 		self.process_element(m_message);
 		break;
 	case PT_TURN:
 		self.process_element(m_turn);
 		break;
 	case PT_JOIN_REQUEST:
+		self.process_element(m_version);
 		self.process_element(m_cookie);
 		self.process_element(m_info);
 		break;
@@ -225,6 +239,18 @@ inline void packet_out::create<PT_MESSAGE>(plr_t s, plr_t d, buffer_t m)
 	m_message = std::move(m);
 }
 
+template <>
+inline void packet_out::create<PT_BUNDLE>(plr_t s, plr_t d, buffer_t m)
+{
+	if (have_encrypted || have_decrypted)
+		ABORT();
+	have_decrypted = true;
+	m_type = PT_BUNDLE;
+	m_src = s;
+	m_dest = d;
+	m_message = std::move(m);
+}
+
 template <>
 inline void packet_out::create<PT_TURN>(plr_t s, plr_t d, turn_t u)
 {
@@ -247,6 +273,7 @@ inline void packet_out::create<PT_JOIN_REQUEST>(plr_t s, plr_t d,
 	m_type = PT_JOIN_REQUEST;
 	m_src = s;
 	m_dest = d;
+	m_version = ProtocolVersion;
 	m_cookie = c;
 	m_info = i;
 }
@@ -330,21 +357,67 @@ const unsigned char *packet_out::end(const T &x)
 
 class packet_factory {
 	key_t key = {};
+	uint32_t decrypt_failures = 0;
+	std::chrono::nanoseconds crypto_time {};
+
+	void Decrypt(packet_in &pkt);
+	void Encrypt(packet_out &pkt);
 
 public:
 	static constexpr unsigned short max_packet_size = 0xFFFF;
 
 	packet_factory(std::string pw = "");
 	std::unique_ptr<packet> make_packet(buffer_t buf);
+	std::unique_ptr<packet> make_packet(buffer_view buf);
 	template <packet_type t, typename... Args>
 	std::unique_ptr<packet> make_packet(Args... args);
+
+	/** @brief Received packets that were rejected, because of a wrong password or because they were malformed */
+	uint32_t DecryptFailures() const
+	{
+		return decrypt_failures;
+	}
+
+	/** @brief Time spent encrypting and decrypting packets */
+	std::chrono::nanoseconds CryptoTime() const
+	{
+		return crypto_time;
+	}
 };
 
+inline void packet_factory::Decrypt(packet_in &pkt)
+{
+	const auto start = std::chrono::steady_clock::now();
+	try {
+		pkt.Decrypt();
+	} catch (packet_exception &) {
+		decrypt_failures++;
+		crypto_time += std::chrono::steady_clock::now() - start;
+		throw;
+	}
+	crypto_time += std::chrono::steady_clock::now() - start;
+}
+
+inline void packet_factory::Encrypt(packet_out &pkt)
+{
+	const auto start = std::chrono::steady_clock::now();
+	pkt.Encrypt();
+	crypto_time += std::chrono::steady_clock::now() - start;
+}
+
 inline std::unique_ptr<packet> packet_factory::make_packet(buffer_t buf)
 {
 	auto ret = std::make_unique<packet_in>(key);
 	ret->Create(std::move(buf));
-	ret->Decrypt();
+	Decrypt(*ret);
+	return ret;
+}
+
+inline std::unique_ptr<packet> packet_factory::make_packet(buffer_view buf)
+{
+	auto ret = std::make_unique<packet_in>(key);
+	ret->Create(buf);
+	Decrypt(*ret);
 	return ret;
 }
 
@@ -353,7 +426,7 @@ std::unique_ptr<packet> packet_factory::make_packet(Args... args)
 {
 	auto ret = std::make_unique<packet_out>(key);
 	ret->create<t>(args...);
-	ret->Encrypt();
+	Encrypt(*ret);
 	return ret;
 }
 
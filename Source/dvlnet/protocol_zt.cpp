@@ -151,7 +151,7 @@ bool protocol_zt::recv_peer(const endpoint &peer)
 	while (true) {
 		auto len = lwip_recv(peer_list[peer].fd, buf, sizeof(buf), 0);
 		if (len >= 0) {
-			peer_list[peer].recv_queue.Write(buffer_t(buf, buf + len));
+			peer_list[peer].recv_queue.Write(buf, len);
 		} else {
 			return errno == EAGAIN || errno == EWOULDBLOCK;
 		}
@@ -235,7 +235,8 @@ bool protocol_zt::recv(endpoint &peer, buffer_t &data)
 	for (auto &p : peer_list) {
 		if (p.second.recv_queue.PacketReady()) {
 			peer = p.first;
-			data = p.second.recv_queue.ReadPacket();
+			buffer_view packet = p.second.recv_queue.ReadPacket();
+			data.assign(packet.data, packet.data + packet.size);
 			return true;
 		}
 	}
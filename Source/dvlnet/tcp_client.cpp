@@ -18,6 +18,10 @@ namespace net {
 
 int tcp_client::create(std::string addrstr, std::string passwd)
 {
+	// The first player to join an empty dedicated server sets up the game
+	if (*sgOptions.Network.szRelayServer != '\0')
+		return join(sgOptions.Network.szRelayServer, passwd);
+
 	try {
 		auto port = sgOptions.Network.nPort;
 		local_server = std::make_unique<tcp_server>(ioc, addrstr, port, passwd);
@@ -88,9 +92,7 @@ void tcp_client::HandleReceive(const asio::error_code &error, size_t bytesRead)
 	if (bytesRead == 0) {
 		throw std::runtime_error(_("error: read 0 bytes from server"));
 	}
-	recv_buffer.resize(bytesRead);
-	recv_queue.Write(std::move(recv_buffer));
-	recv_buffer.resize(frame_queue::max_frame_size);
+	recv_queue.CommitWrite(bytesRead);
 	while (recv_queue.PacketReady()) {
 		auto pkt = pktfty->make_packet(recv_queue.ReadPacket());
 		RecvLocal(*pkt);
@@ -101,22 +103,32 @@ void tcp_client::HandleReceive(const asio::error_code &error, size_t bytesRead)
 void tcp_client::StartReceive()
 {
 	sock.async_receive(
-	    asio::buffer(recv_buffer),
+	    asio::buffer(recv_queue.WriteBuffer(), recv_queue.WriteBufferSize()),
 	    std::bind(&tcp_client::HandleReceive, this, std::placeholders::_1, std::placeholders::_2));
 }
 
+void tcp_client::StartSend()
+{
+	if (!send_queue.ReadyToSend())
+		return;
+	asio::async_write(
+	    sock,
+	    asio::buffer(send_queue.BeginSend()),
+	    std::bind(&tcp_client::HandleSend, this, std::placeholders::_1, std::placeholders::_2));
+}
+
 void tcp_client::HandleSend(const asio::error_code &error, size_t bytesSent)
 {
-	// empty for now
+	send_queue.EndSend();
+	if (error)
+		return;
+	StartSend();
 }
 
 void tcp_client::send(packet &pkt)
 {
-	auto frame = std::make_unique<buffer_t>(frame_queue::MakeFrame(pkt.Data()));
-	auto buf = asio::buffer(*frame);
-	asio::async_write(sock, buf, [this, frame = std::move(frame)](const asio::error_code &error, size_t bytesSent) {
-		HandleSend(error, bytesSent);
-	});
+	send_queue.Push(pkt.Data());
+	StartSend();
 }
 
 bool tcp_client::SNetLeaveGame(int type)
@@ -131,6 +143,8 @@ bool tcp_client::SNetLeaveGame(int type)
 
 std::string tcp_client::make_default_gamename()
 {
+	if (*sgOptions.Network.szRelayServer != '\0')
+		return std::string(sgOptions.Network.szRelayServer);
 	return std::string(sgOptions.Network.szBindAddress);
 }
 
@@ -31,7 +31,7 @@ public:
 
 private:
 	frame_queue recv_queue;
-	buffer_t recv_buffer = buffer_t(frame_queue::max_frame_size);
+	frame_send_queue send_queue;
 
 	asio::io_context ioc;
 	asio::ip::tcp::resolver resolver = asio::ip::tcp::resolver(ioc);
@@ -40,6 +40,7 @@ private:
 
 	void HandleReceive(const asio::error_code &error, size_t bytesRead);
 	void StartReceive();
+	void StartSend();
 	void HandleSend(const asio::error_code &error, size_t bytesSent);
 };
 
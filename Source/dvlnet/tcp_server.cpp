@@ -1,6 +1,8 @@
 #include "dvlnet/tcp_server.h"
 
+#include <algorithm>
 #include <chrono>
+#include <exception>
 #include <functional>
 #include <memory>
 #include <utility>
@@ -37,6 +39,27 @@ std::string tcp_server::LocalhostSelf()
 	return addr.to_string();
 }
 
+unsigned short tcp_server::Port()
+{
+	return acceptor->local_endpoint().port();
+}
+
+int tcp_server::PlayerCount()
+{
+	int count = 0;
+	for (plr_t i = 0; i < MAX_PLRS; ++i)
+		if (connections[i])
+			count++;
+	return count;
+}
+
+tcp_server_stats tcp_server::TakeStats()
+{
+	tcp_server_stats ret = stats;
+	stats = {};
+	return ret;
+}
+
 tcp_server::scc tcp_server::MakeConnection()
 {
 	return std::make_shared<client_connection>(ioc);
@@ -61,7 +84,7 @@ bool tcp_server::Empty()
 void tcp_server::StartReceive(const scc &con)
 {
 	con->socket.async_receive(
-	    asio::buffer(con->recv_buffer),
+	    asio::buffer(con->recv_queue.WriteBuffer(), con->recv_queue.WriteBufferSize()),
 	    std::bind(&tcp_server::HandleReceive, this, con, std::placeholders::_1, std::placeholders::_2));
 }
 
@@ -72,19 +95,21 @@ void tcp_server::HandleReceive(const scc &con, const asio::error_code &ec,
 		DropConnection(con);
 		return;
 	}
-	con->recv_buffer.resize(bytesRead);
-	con->recv_queue.Write(std::move(con->recv_buffer));
-	con->recv_buffer.resize(frame_queue::max_frame_size);
-	while (con->recv_queue.PacketReady()) {
+	con->recv_queue.CommitWrite(bytesRead);
+	stats.bytesReceived += bytesRead;
+	while (true) {
 		try {
+			if (!con->recv_queue.PacketReady())
+				break;
 			auto pkt = pktfty.make_packet(con->recv_queue.ReadPacket());
+			stats.packetsReceived++;
 			if (con->plr == PLR_BROADCAST) {
 				HandleReceiveNewPlayer(con, *pkt);
 			} else {
 				con->timeout = timeout_active;
 				HandleReceivePacket(*pkt);
 			}
-		} catch (dvlnet_exception &e) {
+		} catch (std::exception &e) {
 			Log("Network error: {}", e.what());
 			DropConnection(con);
 			return;
@@ -102,11 +127,17 @@ void tcp_server::SendConnect(const scc &con)
 
 void tcp_server::HandleReceiveNewPlayer(const scc &con, packet &pkt)
 {
+	if (pkt.Version() != ProtocolVersion)
+		throw server_exception();
 	auto newplr = NextFree();
 	if (newplr == PLR_BROADCAST)
 		throw server_exception();
-	if (Empty())
+	if (Empty()) {
+		// Only a player creating a game brings the game settings, a dedicated server can't make them up
+		if (pkt.Info().empty())
+			throw server_exception();
 		game_init_info = pkt.Info();
+	}
 	auto reply = pktfty.make_packet<PT_JOIN_ACCEPT>(PLR_MASTER, PLR_BROADCAST,
 	    pkt.Cookie(), newplr,
 	    game_init_info);
@@ -138,18 +169,38 @@ void tcp_server::SendPacket(packet &pkt)
 
 void tcp_server::StartSend(const scc &con, packet &pkt)
 {
-	auto frame = std::make_unique<buffer_t>(frame_queue::MakeFrame(pkt.Data()));
-	auto buf = asio::buffer(*frame);
-	asio::async_write(con->socket, buf,
-	    [this, con, frame = std::move(frame)](const asio::error_code &ec, size_t bytesSent) {
-		    HandleSend(con, ec, bytesSent);
-	    });
+	if (!con->sendPending) {
+		con->sendPending = true;
+		con->pendingSince = std::chrono::steady_clock::now();
+	}
+	con->send_queue.Push(pkt.Data());
+	stats.packetsSent++;
+	SendQueued(con);
+}
+
+void tcp_server::SendQueued(const scc &con)
+{
+	if (!con->send_queue.ReadyToSend())
+		return;
+	con->sendPending = false;
+	con->sendingSince = con->pendingSince;
+	asio::async_write(con->socket, asio::buffer(con->send_queue.BeginSend()),
+	    std::bind(&tcp_server::HandleSend, this, con, std::placeholders::_1, std::placeholders::_2));
 }
 
 void tcp_server::HandleSend(const scc &con, const asio::error_code &ec,
     size_t bytesSent)
 {
-	// empty for now
+	con->send_queue.EndSend();
+	if (ec)
+		return;
+
+	auto relayTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - con->sendingSince);
+	stats.bytesSent += bytesSent;
+	stats.writes++;
+	stats.relayTimeTotal += relayTime;
+	stats.relayTimeMax = std::max(stats.relayTimeMax, relayTime);
+	SendQueued(con);
 }
 
 void tcp_server::StartAccept()
@@ -164,11 +215,12 @@ void tcp_server::HandleAccept(const scc &con, const asio::error_code &ec)
 {
 	if (ec)
 		return;
-	if (NextFree() == PLR_BROADCAST) {
+	asio::error_code optionError;
+	asio::ip::tcp::no_delay option(true);
+	con->socket.set_option(option, optionError);
+	if (optionError || NextFree() == PLR_BROADCAST) {
 		DropConnection(con);
 	} else {
-		asio::ip::tcp::no_delay option(true);
-		con->socket.set_option(option);
 		con->timeout = timeout_connect;
 		StartReceive(con);
 		StartTimeout(con);
@@ -209,8 +261,10 @@ void tcp_server::DropConnection(const scc &con)
 		// TODO: investigate if it is really ok for the server to
 		//       drop a client directly.
 	}
-	con->timer.cancel();
-	con->socket.close();
+	// The peer may have reset the connection already, that's as good as closing it
+	asio::error_code ec;
+	con->timer.cancel(ec);
+	con->socket.close(ec);
 }
 
 void tcp_server::Close()
@@ -3,6 +3,8 @@
 #include <string>
 #include <memory>
 #include <array>
+#include <chrono>
+#include <cstdint>
 #include <asio/ts/buffer.hpp>
 #include <asio/ts/internet.hpp>
 #include <asio/ts/io_context.hpp>
@@ -23,11 +25,32 @@ public:
 	}
 };
 
+/**
+ * @brief Traffic of a tcp_server
+ */
+struct tcp_server_stats {
+	uint32_t packetsReceived = 0;
+	uint64_t bytesReceived = 0;
+	uint32_t packetsSent = 0;
+	uint64_t bytesSent = 0;
+	/** Completed socket writes, each one carries the frames queued for a player since the previous write */
+	uint32_t writes = 0;
+	/** Time from queuing the oldest frame of a write until the write completed, summed over all writes */
+	std::chrono::microseconds relayTimeTotal {};
+	std::chrono::microseconds relayTimeMax {};
+};
+
 class tcp_server {
 public:
 	tcp_server(asio::io_context &ioc, const std::string &bindaddr,
 	    unsigned short port, std::string pw);
 	std::string LocalhostSelf();
+	unsigned short Port();
+	int PlayerCount();
+	/**
+	 * @brief The traffic since the last call
+	 */
+	tcp_server_stats TakeStats();
 	void Close();
 	virtual ~tcp_server();
 
@@ -37,7 +60,10 @@ private:
 
 	struct client_connection {
 		frame_queue recv_queue;
-		buffer_t recv_buffer = buffer_t(frame_queue::max_frame_size);
+		frame_send_queue send_queue;
+		bool sendPending = false;
+		std::chrono::steady_clock::time_point pendingSince;
+		std::chrono::steady_clock::time_point sendingSince;
 		plr_t plr = PLR_BROADCAST;
 		asio::ip::tcp::socket socket;
 		asio::steady_timer timer;
@@ -56,6 +82,7 @@ private:
 	std::unique_ptr<asio::ip::tcp::acceptor> acceptor;
 	std::array<scc, MAX_PLRS> connections;
 	buffer_t game_init_info;
+	tcp_server_stats stats;
 
 	scc MakeConnection();
 	plr_t NextFree();
@@ -69,6 +96,7 @@ private:
 	void SendConnect(const scc &con);
 	void SendPacket(packet &pkt);
 	void StartSend(const scc &con, packet &pkt);
+	void SendQueued(const scc &con);
 	void HandleSend(const scc &con, const asio::error_code &ec, size_t bytesSent);
 	void StartTimeout(const scc &con);
 	void HandleTimeout(const scc &con, const asio::error_code &ec);
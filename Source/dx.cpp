@@ -12,6 +12,7 @@
 #include "storm/storm.h"
 #include "utils/display.h"
 #include "utils/log.hpp"
+#include "utils/profiler.h"
 #include "utils/sdl_mutex.h"
 #include "utils/sdl_wrap.h"
 
@@ -246,7 +247,7 @@ void InitPalette()
 
 void BltFast(SDL_Rect *srcRect, SDL_Rect *dstRect)
 {
-	if (RenderDirectlyToOutputSurface)
+	if (RenderDirectlyToOutputSurface || HeadlessMode)
 		return;
 	Blit(pal_surface, srcRect, dstRect);
 }
@@ -306,6 +307,9 @@ void Blit(SDL_Surface *src, SDL_Rect *srcRect, SDL_Rect *dstRect)
 
 void RenderPresent()
 {
+	if (HeadlessMode)
+		return;
+
 	SDL_Surface *surface = GetOutputSurface();
 
 	if (!gbActive) {
@@ -315,35 +319,47 @@ void RenderPresent()
 
 #ifndef USE_SDL1
 	if (renderer != nullptr) {
-		if (SDL_UpdateTexture(texture, nullptr, surface->pixels, surface->pitch) <= -1) { //pitch is 2560
-			ErrSdl();
-		}
-
-		// Clear buffer to avoid artifacts in case the window was resized
-		if (SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255) <= -1) { // TODO only do this if window was resized
-			ErrSdl();
+		{
+			profiler::RenderStageTimer timer(profiler::RenderStage::TextureUpload);
+			if (SDL_UpdateTexture(texture, nullptr, surface->pixels, surface->pitch) <= -1) { //pitch is 2560
+				ErrSdl();
+			}
 		}
 
-		if (SDL_RenderClear(renderer) <= -1) {
-			ErrSdl();
-		}
-		if (SDL_RenderCopy(renderer, texture, nullptr, nullptr) <= -1) {
-			ErrSdl();
+		{
+			profiler::RenderStageTimer timer(profiler::RenderStage::Present);
+			// Clear buffer to avoid artifacts in case the window was resized
+			if (SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255) <= -1) { // TODO only do this if window was resized
+				ErrSdl();
+			}
+
+			if (SDL_RenderClear(renderer) <= -1) {
+				ErrSdl();
+			}
+			if (SDL_RenderCopy(renderer, texture, nullptr, nullptr) <= -1) {
+				ErrSdl();
+			}
+			SDL_RenderPresent(renderer);
 		}
-		SDL_RenderPresent(renderer);
 
 		if (!sgOptions.Graphics.bVSync) {
 			LimitFrameRate();
 		}
 	} else {
-		if (SDL_UpdateWindowSurface(ghMainWnd) <= -1) {
-			ErrSdl();
+		{
+			profiler::RenderStageTimer timer(profiler::RenderStage::Present);
+			if (SDL_UpdateWindowSurface(ghMainWnd) <= -1) {
+				ErrSdl();
+			}
 		}
 		LimitFrameRate();
 	}
 #else
-	if (SDL_Flip(surface) <= -1) {
-		ErrSdl();
+	{
+		profiler::RenderStageTimer timer(profiler::RenderStage::Present);
+		if (SDL_Flip(surface) <= -1) {
+			ErrSdl();
+		}
 	}
 	if (RenderDirectlyToOutputSurface)
 		pal_surface = GetOutputSurface();
@@ -4,6 +4,7 @@
  * Implementation of functions for compression and decompressing MPQ data.
  */
 #include <SDL.h>
+#include <algorithm>
 #include <cctype>
 #include <memory>
 #include <array>
@@ -36,7 +37,9 @@ void PkwareBufferWrite(char *buf, unsigned int *size, void *param) // NOLINT(rea
 {
 	auto *pInfo = reinterpret_cast<TDataInfo *>(param);
 
-	memcpy(pInfo->destData + pInfo->destOffset, buf, *size);
+	// Corrupt data can expand to more than the buffer holds, only count the rest
+	if (pInfo->destOffset < pInfo->destSize)
+		memcpy(pInfo->destData + pInfo->destOffset, buf, std::min<uint32_t>(*size, pInfo->destSize - pInfo->destOffset));
 	pInfo->destOffset += *size;
 }
 
@@ -114,6 +117,7 @@ uint32_t PkwareCompress(byte *srcData, uint32_t size)
 	param.srcOffset = 0;
 	param.destData = destData.get();
 	param.destOffset = 0;
+	param.destSize = destSize;
 	param.size = size;
 
 	unsigned type = 0;
@@ -128,7 +132,7 @@ uint32_t PkwareCompress(byte *srcData, uint32_t size)
 	return size;
 }
 
-void PkwareDecompress(byte *inBuff, int recvSize, int maxBytes)
+uint32_t PkwareDecompress(byte *inBuff, int recvSize, int maxBytes)
 {
 	TDataInfo info;
 
@@ -139,10 +143,14 @@ void PkwareDecompress(byte *inBuff, int recvSize, int maxBytes)
 	info.srcOffset = 0;
 	info.destData = outBuff.get();
 	info.destOffset = 0;
+	info.destSize = maxBytes;
 	info.size = recvSize;
 
-	explode(PkwareBufferRead, PkwareBufferWrite, ptr.get(), &info);
+	if (explode(PkwareBufferRead, PkwareBufferWrite, ptr.get(), &info) != CMP_NO_ERROR || info.destOffset > info.destSize)
+		return 0;
 	memcpy(inBuff, outBuff.get(), info.destOffset);
+
+	return info.destOffset;
 }
 
 } // namespace devilution
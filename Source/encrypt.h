@@ -15,7 +15,9 @@ struct TDataInfo {
 	byte *srcData;
 	uint32_t srcOffset;
 	byte *destData;
+	/** Number of bytes written, can exceed destSize if the data didn't fit */
 	uint32_t destOffset;
+	uint32_t destSize;
 	uint32_t size;
 };
 
@@ -23,6 +25,10 @@ void Decrypt(uint32_t *castBlock, uint32_t size, uint32_t key);
 void Encrypt(uint32_t *castBlock, uint32_t size, uint32_t key);
 uint32_t Hash(const char *s, int type);
 uint32_t PkwareCompress(byte *srcData, uint32_t size);
-void PkwareDecompress(byte *inBuff, int recvSize, int maxBytes);
+/**
+ * @brief Decompresses the data in place
+ * @return The decompressed size, 0 if the data is corrupt or doesn't fit in maxBytes
+ */
+uint32_t PkwareDecompress(byte *inBuff, int recvSize, int maxBytes);
 
 } // namespace devilution
@@ -0,0 +1,572 @@
+/**
+ * @file demo_file.cpp
+ *
+ * Implementation of reading and writing recorded demo files.
+ */
+#include "engine/demo_file.hpp"
+
+#include <cstring>
+#include <sstream>
+
+#include "encrypt.h"
+#include "utils/endian.hpp"
+#include "utils/file_util.h"
+#include "utils/log.hpp"
+
+namespace devilution {
+
+namespace demo {
+
+namespace {
+
+constexpr char DemoMagic[3] = { 'D', 'M', 'O' };
+constexpr size_t FileHeaderSize = 12;
+constexpr size_t BlockHeaderSize = 13;
+/** A block is closed after the first game tick that brings it to this size */
+constexpr size_t BlockSize = 16 * 1024;
+/** Upper bound for blocks read from disk, protects against corrupt headers */
+constexpr uint32_t MaxBlockSize = 32 * 1024 * 1024;
+
+void WriteLE16(byte *out, uint16_t value)
+{
+	out[0] = static_cast<byte>(value & 0xFF);
+	out[1] = static_cast<byte>(value >> 8);
+}
+
+void WriteLE32(byte *out, uint32_t value)
+{
+	for (int i = 0; i < 4; i++) {
+		out[i] = static_cast<byte>(value & 0xFF);
+		value >>= 8;
+	}
+}
+
+void AppendVarint(std::vector<byte> &out, uint32_t value)
+{
+	while (value >= 0x80) {
+		out.push_back(static_cast<byte>((value & 0x7F) | 0x80));
+		value >>= 7;
+	}
+	out.push_back(static_cast<byte>(value));
+}
+
+void AppendLE32(std::vector<byte> &out, uint32_t value)
+{
+	byte bytes[4];
+	WriteLE32(bytes, value);
+	out.insert(out.end(), std::begin(bytes), std::end(bytes));
+}
+
+void AppendBytes(std::vector<byte> &out, const std::vector<byte> &data)
+{
+	AppendLE32(out, static_cast<uint32_t>(data.size()));
+	out.insert(out.end(), data.begin(), data.end());
+}
+
+bool ReadLE32(const std::vector<byte> &in, size_t &pos, uint32_t &value)
+{
+	if (in.size() - pos < 4)
+		return false;
+	value = LoadLE32(&in[pos]);
+	pos += 4;
+	return true;
+}
+
+bool ReadBytes(const std::vector<byte> &in, size_t &pos, std::vector<byte> &data)
+{
+	uint32_t size;
+	if (!ReadLE32(in, pos, size) || in.size() - pos < size)
+		return false;
+	data.assign(in.begin() + pos, in.begin() + pos + size);
+	pos += size;
+	return true;
+}
+
+bool ReadVarint(const byte *data, size_t size, size_t &pos, uint32_t &value)
+{
+	value = 0;
+	for (int shift = 0; shift < 35; shift += 7) {
+		if (pos >= size)
+			return false;
+		auto b = static_cast<uint8_t>(data[pos++]);
+		value |= static_cast<uint32_t>(b & 0x7F) << shift;
+		if ((b & 0x80) == 0)
+			return true;
+	}
+	return false;
+}
+
+uint32_t ZigZagEncode(int32_t value)
+{
+	return (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+}
+
+int32_t ZigZagDecode(uint32_t value)
+{
+	return static_cast<int32_t>((value >> 1) ^ (~(value & 1) + 1));
+}
+
+/** @brief Mouse positions are packed into lParam, consecutive messages tend to have similar values */
+int32_t Delta(int32_t value, int32_t previous)
+{
+	return static_cast<int32_t>(static_cast<uint32_t>(value) - static_cast<uint32_t>(previous));
+}
+
+int32_t ApplyDelta(int32_t delta, int32_t previous)
+{
+	return static_cast<int32_t>(static_cast<uint32_t>(previous) + static_cast<uint32_t>(delta));
+}
+
+uint32_t FloatToBits(float value)
+{
+	static_assert(sizeof(float) == sizeof(uint32_t), "float must be 32 bit");
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	return bits;
+}
+
+float BitsToFloat(uint32_t bits)
+{
+	float value;
+	memcpy(&value, &bits, sizeof(value));
+	return value;
+}
+
+} // namespace
+
+DemoWriter::~DemoWriter()
+{
+	Close();
+}
+
+bool DemoWriter::Open(const char *path, const DemoHeader &header, bool compress)
+{
+	Close();
+
+	stream_ = CreateFileStream(path, std::fstream::out | std::fstream::trunc | std::fstream::binary);
+	if (stream_ == nullptr || stream_->fail()) {
+		LogError("Unable to create demo file {}", path);
+		stream_ = nullptr;
+		return false;
+	}
+
+	byte fileHeader[FileHeaderSize];
+	memcpy(fileHeader, DemoMagic, sizeof(DemoMagic));
+	fileHeader[3] = static_cast<byte>(DemoFileVersion);
+	WriteLE32(&fileHeader[4], header.saveNumber);
+	WriteLE16(&fileHeader[8], header.width);
+	WriteLE16(&fileHeader[10], header.height);
+	stream_->write(reinterpret_cast<const char *>(fileHeader), sizeof(fileHeader));
+
+	compress_ = compress;
+	tick_ = 0;
+	blockFirstTick_ = 0;
+	lastLParam_ = 0;
+	lastWasTick_ = false;
+	keyframeTick_ = 0;
+	block_.clear();
+	block_.reserve(BlockSize + 64);
+
+	return true;
+}
+
+void DemoWriter::Write(const DemoMsg &msg)
+{
+	if (!IsOpen())
+		return;
+
+	// Every record starts with the same 5 bytes, only messages carry a payload
+	byte recordHeader[5];
+	recordHeader[0] = static_cast<byte>(msg.type);
+	WriteLE32(&recordHeader[1], FloatToBits(msg.progressToNextGameTick));
+	block_.insert(block_.end(), std::begin(recordHeader), std::end(recordHeader));
+
+	if (msg.type == DemoMsgType::Message) {
+		AppendVarint(block_, msg.message);
+		AppendVarint(block_, ZigZagEncode(msg.wParam));
+		AppendVarint(block_, ZigZagEncode(Delta(msg.lParam, lastLParam_)));
+		lastLParam_ = msg.lParam;
+	}
+
+	lastWasTick_ = msg.type == DemoMsgType::GameTick;
+	if (msg.type == DemoMsgType::GameTick) {
+		tick_++;
+		if (block_.size() >= BlockSize)
+			FlushBlock();
+	}
+}
+
+bool DemoWriter::KeyframeDue(uint32_t interval) const
+{
+	return IsOpen() && lastWasTick_ && tick_ % interval == 0 && tick_ != keyframeTick_;
+}
+
+void DemoWriter::WriteKeyframe(const DemoKeyframe &keyframe)
+{
+	if (!IsOpen())
+		return;
+
+	// The records following the keyframe have to start a new block so playback can resume there
+	FlushBlock();
+
+	std::vector<byte> data;
+	AppendLE32(data, keyframe.rngState);
+	AppendBytes(data, keyframe.gameData);
+	AppendLE32(data, static_cast<uint32_t>(keyframe.levels.size()));
+	for (const DemoKeyframeFile &level : keyframe.levels) {
+		data.push_back(static_cast<byte>(level.name.size()));
+		data.insert(data.end(), reinterpret_cast<const byte *>(level.name.data()), reinterpret_cast<const byte *>(level.name.data() + level.name.size()));
+		AppendBytes(data, level.data);
+	}
+
+	WriteBlock(DemoBlockKind::Keyframe, data.data(), static_cast<uint32_t>(data.size()));
+	keyframeTick_ = tick_;
+}
+
+void DemoWriter::FlushBlock()
+{
+	if (block_.empty())
+		return;
+
+	WriteBlock(DemoBlockKind::Records, block_.data(), static_cast<uint32_t>(block_.size()));
+
+	block_.clear();
+	blockFirstTick_ = tick_;
+	lastLParam_ = 0;
+}
+
+void DemoWriter::WriteBlock(DemoBlockKind kind, byte *data, uint32_t size)
+{
+	uint32_t storedSize = size;
+	if (compress_)
+		storedSize = PkwareCompress(data, size);
+
+	byte blockHeader[BlockHeaderSize];
+	blockHeader[0] = static_cast<byte>(kind);
+	WriteLE32(&blockHeader[1], kind == DemoBlockKind::Records ? blockFirstTick_ : tick_);
+	WriteLE32(&blockHeader[5], size);
+	WriteLE32(&blockHeader[9], storedSize);
+	stream_->write(reinterpret_cast<const char *>(blockHeader), sizeof(blockHeader));
+	stream_->write(reinterpret_cast<const char *>(data), storedSize);
+}
+
+void DemoWriter::Close()
+{
+	if (!IsOpen())
+		return;
+
+	FlushBlock();
+	stream_->close();
+	stream_ = nullptr;
+}
+
+bool DemoReader::Open(const char *path)
+{
+	Close();
+
+	stream_ = CreateFileStream(path, std::fstream::in | std::fstream::binary);
+	if (stream_ == nullptr || stream_->fail()) {
+		stream_ = nullptr;
+		return false;
+	}
+
+	byte fileHeader[FileHeaderSize];
+	stream_->read(reinterpret_cast<char *>(fileHeader), sizeof(fileHeader));
+	if (stream_->gcount() >= 2 && fileHeader[0] == static_cast<byte>('0') && fileHeader[1] == static_cast<byte>(',')) {
+		stream_->clear();
+		stream_->seekg(0);
+		if (!ReadTextHeader()) {
+			Close();
+			return false;
+		}
+		return true;
+	}
+
+	if (stream_->gcount() != sizeof(fileHeader) || memcmp(fileHeader, DemoMagic, sizeof(DemoMagic)) != 0) {
+		LogError("{} is not a demo file", path);
+		Close();
+		return false;
+	}
+
+	header_.version = static_cast<uint8_t>(fileHeader[3]);
+	if (header_.version != DemoFileVersion) {
+		LogError("Unsupported demo version {}", header_.version);
+		Close();
+		return false;
+	}
+	header_.saveNumber = LoadLE32(&fileHeader[4]);
+	header_.width = LoadLE16(&fileHeader[8]);
+	header_.height = LoadLE16(&fileHeader[10]);
+
+	if (!BuildBlockIndex()) {
+		Close();
+		return false;
+	}
+
+	return true;
+}
+
+void DemoReader::Close()
+{
+	stream_ = nullptr;
+	blocks_.clear();
+	nextBlock_ = 0;
+	block_.clear();
+	blockPos_ = 0;
+	hasCurrent_ = false;
+}
+
+bool DemoReader::ReadTextHeader()
+{
+	std::string line;
+	if (!std::getline(*stream_, line))
+		return false;
+
+	std::stringstream header(line);
+	std::string number;
+	std::getline(header, number, ','); // Demo version
+	if (std::stoi(number) != 0)
+		return false;
+	header_.version = 0;
+
+	std::getline(header, number, ',');
+	header_.saveNumber = std::stoi(number);
+
+	std::getline(header, number, ',');
+	header_.width = std::stoi(number);
+
+	std::getline(header, number, ',');
+	header_.height = std::stoi(number);
+
+	return true;
+}
+
+bool DemoReader::BuildBlockIndex()
+{
+	// Only the block headers are read, the records themselves are decoded on demand
+	auto offset = static_cast<uint32_t>(FileHeaderSize);
+	while (true) {
+		byte blockHeader[BlockHeaderSize];
+		stream_->read(reinterpret_cast<char *>(blockHeader), sizeof(blockHeader));
+		if (stream_->gcount() != sizeof(blockHeader))
+			break;
+
+		const auto kind = static_cast<DemoBlockKind>(blockHeader[0]);
+		const uint32_t rawSize = LoadLE32(&blockHeader[5]);
+		const uint32_t storedSize = LoadLE32(&blockHeader[9]);
+		if ((kind != DemoBlockKind::Records && kind != DemoBlockKind::Keyframe) || rawSize > MaxBlockSize || storedSize > rawSize) {
+			LogError("Corrupt demo block at offset {}", offset);
+			return false;
+		}
+
+		stream_->seekg(storedSize, std::ios::cur);
+		if (stream_->fail())
+			break;
+
+		blocks_.push_back({ kind, LoadLE32(&blockHeader[1]), offset });
+		offset += BlockHeaderSize + storedSize;
+	}
+	stream_->clear();
+
+	return true;
+}
+
+bool DemoReader::ReadBlockData(size_t index, std::vector<byte> &data)
+{
+	stream_->clear();
+	stream_->seekg(blocks_[index].offset);
+
+	byte blockHeader[BlockHeaderSize];
+	stream_->read(reinterpret_cast<char *>(blockHeader), sizeof(blockHeader));
+	if (stream_->gcount() != sizeof(blockHeader))
+		return false;
+	const uint32_t rawSize = LoadLE32(&blockHeader[5]);
+	const uint32_t storedSize = LoadLE32(&blockHeader[9]);
+
+	data.resize(rawSize);
+	stream_->read(reinterpret_cast<char *>(data.data()), storedSize);
+	if (stream_->gcount() != storedSize) {
+		LogError("Demo file is truncated");
+		return false;
+	}
+	if (storedSize < rawSize && PkwareDecompress(data.data(), storedSize, rawSize) != rawSize) {
+		LogError("Corrupt demo block at offset {}", blocks_[index].offset);
+		return false;
+	}
+
+	return true;
+}
+
+bool DemoReader::ReadBlock(size_t index)
+{
+	nextBlock_ = index + 1;
+	blockPos_ = 0;
+	lastLParam_ = 0;
+	if (blocks_[index].kind != DemoBlockKind::Records) {
+		block_.clear();
+		return true;
+	}
+
+	if (!ReadBlockData(index, block_)) {
+		// Playback ends here, the records after a corrupt block can't be played without the ones before them
+		block_.clear();
+		nextBlock_ = blocks_.size();
+		return false;
+	}
+
+	return true;
+}
+
+bool DemoReader::DecodeNext()
+{
+	while (blockPos_ >= block_.size()) {
+		if (nextBlock_ >= blocks_.size())
+			return false;
+		if (!ReadBlock(nextBlock_))
+			return false;
+	}
+
+	const byte *data = block_.data();
+	const size_t blockSize = block_.size();
+	if (blockSize - blockPos_ < 5) {
+		LogError("Corrupt demo record");
+		return false;
+	}
+	current_.type = static_cast<DemoMsgType>(data[blockPos_]);
+	current_.progressToNextGameTick = BitsToFloat(LoadLE32(&data[blockPos_ + 1]));
+	blockPos_ += 5;
+
+	current_.message = 0;
+	current_.wParam = 0;
+	current_.lParam = 0;
+	if (current_.type == DemoMsgType::Message) {
+		uint32_t wParam;
+		uint32_t lParamDelta;
+		if (!ReadVarint(data, blockSize, blockPos_, current_.message)
+		    || !ReadVarint(data, blockSize, blockPos_, wParam)
+		    || !ReadVarint(data, blockSize, blockPos_, lParamDelta)) {
+			LogError("Corrupt demo record");
+			return false;
+		}
+		current_.wParam = ZigZagDecode(wParam);
+		current_.lParam = ApplyDelta(ZigZagDecode(lParamDelta), lastLParam_);
+		lastLParam_ = current_.lParam;
+	}
+
+	return true;
+}
+
+bool DemoReader::DecodeNextText()
+{
+	std::string line;
+	if (!std::getline(*stream_, line) || line.empty())
+		return false;
+
+	std::stringstream command(line);
+	std::string number;
+
+	std::getline(command, number, ',');
+	current_.type = static_cast<DemoMsgType>(std::stoi(number));
+
+	std::getline(command, number, ',');
+	current_.progressToNextGameTick = std::stof(number);
+
+	current_.message = 0;
+	current_.wParam = 0;
+	current_.lParam = 0;
+	if (current_.type == DemoMsgType::Message) {
+		std::getline(command, number, ',');
+		current_.message = std::stoi(number);
+		std::getline(command, number, ',');
+		current_.wParam = std::stoi(number);
+		std::getline(command, number, ',');
+		current_.lParam = std::stoi(number);
+	}
+
+	return true;
+}
+
+const DemoMsg *DemoReader::Peek()
+{
+	if (!hasCurrent_) {
+		if (!IsOpen())
+			return nullptr;
+		hasCurrent_ = header_.version == 0 ? DecodeNextText() : DecodeNext();
+		if (!hasCurrent_)
+			return nullptr;
+	}
+
+	return &current_;
+}
+
+void DemoReader::Pop()
+{
+	hasCurrent_ = false;
+}
+
+bool DemoReader::SeekToBlock(size_t index)
+{
+	if (!IsOpen() || index >= blocks_.size())
+		return false;
+
+	hasCurrent_ = false;
+	return ReadBlock(index);
+}
+
+int DemoReader::FindKeyframe(uint32_t tick) const
+{
+	int found = -1;
+	for (size_t i = 0; i < blocks_.size(); i++) {
+		if (blocks_[i].firstTick > tick)
+			break;
+		if (blocks_[i].kind == DemoBlockKind::Keyframe)
+			found = static_cast<int>(i);
+	}
+	return found;
+}
+
+bool DemoReader::ReadKeyframe(size_t index, DemoKeyframe &keyframe)
+{
+	if (!IsOpen() || index >= blocks_.size() || blocks_[index].kind != DemoBlockKind::Keyframe)
+		return false;
+
+	std::vector<byte> data;
+	if (!ReadBlockData(index, data))
+		return false;
+
+	size_t pos = 0;
+	uint32_t levelCount;
+	if (!ReadLE32(data, pos, keyframe.rngState)
+	    || !ReadBytes(data, pos, keyframe.gameData)
+	    || !ReadLE32(data, pos, levelCount)) {
+		LogError("Corrupt demo keyframe");
+		return false;
+	}
+
+	keyframe.levels.clear();
+	for (uint32_t i = 0; i < levelCount; i++) {
+		DemoKeyframeFile level;
+		if (pos >= data.size()) {
+			LogError("Corrupt demo keyframe");
+			return false;
+		}
+		const auto nameLength = static_cast<uint8_t>(data[pos++]);
+		if (data.size() - pos < nameLength) {
+			LogError("Corrupt demo keyframe");
+			return false;
+		}
+		level.name.assign(reinterpret_cast<const char *>(&data[pos]), nameLength);
+		pos += nameLength;
+		if (!ReadBytes(data, pos, level.data)) {
+			LogError("Corrupt demo keyframe");
+			return false;
+		}
+		keyframe.levels.push_back(std::move(level));
+	}
+
+	return true;
+}
+
+} // namespace demo
+
+} // namespace devilution
@@ -0,0 +1,196 @@
+/**
+ * @file demo_file.hpp
+ *
+ * Reading and writing of recorded demo files.
+ *
+ * Version 1 demos are binary. After the file header the recording is split into blocks that
+ * each start on a game tick boundary and can be decoded on their own, so playback only keeps
+ * a single block in memory and a block index allows jumping close to any tick. Blocks are
+ * compressed with PKWare implode when that makes them smaller.
+ *
+ * Keyframe blocks hold a snapshot of the game state taken right before the tick they are
+ * tagged with, before the messages of that tick are dispatched. Playback can restore the
+ * snapshot and continue with the following block.
+ *
+ * Version 0 demos are the original comma separated text format and can still be played back.
+ */
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "utils/stdcompat/cstddef.hpp"
+
+namespace devilution {
+
+namespace demo {
+
+enum class DemoMsgType : uint8_t {
+	GameTick = 0,
+	Rendering = 1,
+	Message = 2,
+};
+
+struct DemoMsg {
+	DemoMsgType type;
+	uint32_t message;
+	int32_t wParam;
+	int32_t lParam;
+	float progressToNextGameTick;
+};
+
+struct DemoHeader {
+	uint8_t version;
+	uint32_t saveNumber;
+	uint16_t width;
+	uint16_t height;
+};
+
+/** Version written by DemoWriter */
+constexpr uint8_t DemoFileVersion = 1;
+
+enum class DemoBlockKind : uint8_t {
+	Records = 0,
+	Keyframe = 1,
+};
+
+/**
+ * @brief Position of a block inside a binary demo file
+ */
+struct DemoBlockInfo {
+	DemoBlockKind kind;
+	/** Number of game ticks played before the first record of the block */
+	uint32_t firstTick;
+	/** Offset of the block header from the start of the file */
+	uint32_t offset;
+};
+
+struct DemoKeyframeFile {
+	std::string name;
+	std::vector<byte> data;
+};
+
+/**
+ * @brief Game state needed to resume playback in the middle of a demo
+ */
+struct DemoKeyframe {
+	/** State of the random number generator */
+	uint32_t rngState;
+	/** Output of SaveGameSnapshot */
+	std::vector<byte> gameData;
+	/** Levels that were left during the recording and are no longer part of gameData */
+	std::vector<DemoKeyframeFile> levels;
+};
+
+class DemoWriter {
+public:
+	~DemoWriter();
+
+	bool Open(const char *path, const DemoHeader &header, bool compress = true);
+	void Write(const DemoMsg &msg);
+	/** @brief Stores a snapshot of the game state before the next game tick */
+	void WriteKeyframe(const DemoKeyframe &keyframe);
+	/**
+	 * @brief Whether a keyframe is to be written now, right after every interval-th game tick
+	 *
+	 * Only true until anything else is recorded, so the messages leading up to the next tick follow the keyframe.
+	 */
+	bool KeyframeDue(uint32_t interval) const;
+	/** @brief Writes any buffered records and closes the file */
+	void Close();
+
+	bool IsOpen() const
+	{
+		return stream_ != nullptr;
+	}
+
+	/** @brief Number of game ticks written so far */
+	uint32_t Tick() const
+	{
+		return tick_;
+	}
+
+private:
+	void FlushBlock();
+	void WriteBlock(DemoBlockKind kind, byte *data, uint32_t size);
+
+	std::unique_ptr<std::fstream> stream_;
+	std::vector<byte> block_;
+	bool compress_ = true;
+	uint32_t tick_ = 0;
+	uint32_t blockFirstTick_ = 0;
+	int32_t lastLParam_ = 0;
+	bool lastWasTick_ = false;
+	uint32_t keyframeTick_ = 0;
+};
+
+class DemoReader {
+public:
+	/**
+	 * @brief Opens a demo file of any supported version and reads its header
+	 * @return false if the file is missing, truncated or of an unknown version
+	 */
+	bool Open(const char *path);
+	void Close();
+
+	bool IsOpen() const
+	{
+		return stream_ != nullptr;
+	}
+
+	const DemoHeader &Header() const
+	{
+		return header_;
+	}
+
+	/** @brief Block index of binary demos, empty for text demos */
+	const std::vector<DemoBlockInfo> &Blocks() const
+	{
+		return blocks_;
+	}
+
+	/**
+	 * @brief Returns the next record without consuming it
+	 * @return nullptr once the end of the recording has been reached
+	 */
+	const DemoMsg *Peek();
+	void Pop();
+
+	/**
+	 * @brief Continue reading from the start of the given block
+	 * @return false if the block doesn't exist or can't be read
+	 */
+	bool SeekToBlock(size_t index);
+
+	/**
+	 * @brief Finds the last keyframe that was taken at or before the given tick
+	 * @return Index of the keyframe block or -1 if there is none
+	 */
+	int FindKeyframe(uint32_t tick) const;
+	bool ReadKeyframe(size_t index, DemoKeyframe &keyframe);
+
+private:
+	bool ReadBlockData(size_t index, std::vector<byte> &data);
+	bool ReadTextHeader();
+	bool BuildBlockIndex();
+	bool ReadBlock(size_t index);
+	bool DecodeNext();
+	bool DecodeNextText();
+
+	std::unique_ptr<std::fstream> stream_;
+	DemoHeader header_ {};
+	std::vector<DemoBlockInfo> blocks_;
+	size_t nextBlock_ = 0;
+	std::vector<byte> block_;
+	size_t blockPos_ = 0;
+	int32_t lastLParam_ = 0;
+	DemoMsg current_ {};
+	bool hasCurrent_ = false;
+};
+
+} // namespace demo
+
+} // namespace devilution
@@ -4,124 +4,113 @@
  * Contains most of the the demomode specific logic
  */
 
-#include <deque>
-#include <fstream>
-#include <sstream>
-#include <iostream>
+#include <string>
 
 #include "demomode.h"
+#include "engine/demo_file.hpp"
+#include "engine/random.hpp"
 #include "utils/display.h"
+#include "utils/log.hpp"
 #include "utils/paths.h"
+#include "utils/timedemo.h"
+#include "loadsave.h"
 #include "menu.h"
 #include "options.h"
 #include "nthread.h"
+#include "palette.h"
 #include "pfile.h"
 
 namespace devilution {
 
 namespace {
 
-enum class DemoMsgType {
-	GameTick = 0,
-	Rendering = 1,
-	Message = 2,
-};
-
-struct demoMsg {
-	DemoMsgType type;
-	uint32_t message;
-	int32_t wParam;
-	int32_t lParam;
-	float progressToNextGameTick;
-};
-
 int DemoNumber = -1;
 bool Timedemo = false;
 int RecordNumber = -1;
 
-std::ofstream DemoRecording;
-std::deque<demoMsg> Demo_Message_Queue;
+demo::DemoWriter DemoRecording;
+demo::DemoReader DemoPlayback;
 uint32_t DemoModeLastTick = 0;
 
+/** One keyframe per minute at the default tick rate */
+constexpr uint32_t KeyframeInterval = 20 * 60;
+
 int LogicTick = 0;
 int StartTime = 0;
+/** Tick from which the playback speed is measured, only differs from 0 after seeking */
+int StartTick = 0;
+
+int SeekTick = 0;
+bool SeekPending = false;
 
 int DemoGraphicsWidth = 640;
 int DemoGraphicsHeight = 480;
 
-void PumpDemoMessage(DemoMsgType demoMsgType, uint32_t message, int32_t wParam, int32_t lParam, float progressToNextGameTick)
+std::string GetDemoPath(int demoNumber)
 {
-	demoMsg msg;
-	msg.type = demoMsgType;
-	msg.message = message;
-	msg.wParam = wParam;
-	msg.lParam = lParam;
-	msg.progressToNextGameTick = progressToNextGameTick;
-
-	Demo_Message_Queue.push_back(msg);
+	char demoFilename[16];
+	snprintf(demoFilename, 15, "demo_%d.dmo", demoNumber);
+	return paths::PrefPath() + demoFilename;
 }
 
 bool LoadDemoMessages(int i)
 {
-	std::ifstream demofile;
-	char demoFilename[16];
-	snprintf(demoFilename, 15, "demo_%d.dmo", i);
-	demofile.open(paths::PrefPath() + demoFilename);
-	if (!demofile.is_open()) {
+	if (!DemoPlayback.Open(GetDemoPath(i).c_str()))
 		return false;
-	}
 
-	std::string line;
-	std::getline(demofile, line);
-	std::stringstream header(line);
+	const demo::DemoHeader &header = DemoPlayback.Header();
+	gSaveNumber = header.saveNumber;
+	DemoGraphicsWidth = header.width;
+	DemoGraphicsHeight = header.height;
 
-	std::string number;
-	std::getline(header, number, ','); // Demo version
-	if (std::stoi(number) != 0) {
-		return false;
-	}
-
-	std::getline(header, number, ',');
-	gSaveNumber = std::stoi(number);
-
-	std::getline(header, number, ',');
-	DemoGraphicsWidth = std::stoi(number);
+	DemoModeLastTick = SDL_GetTicks();
 
-	std::getline(header, number, ',');
-	DemoGraphicsHeight = std::stoi(number);
+	return true;
+}
 
-	while (std::getline(demofile, line)) {
-		std::stringstream command(line);
+void WriteKeyframe()
+{
+	demo::DemoKeyframe keyframe;
+	keyframe.rngState = GetLCGEngineState();
+	keyframe.gameData = SaveGameSnapshot();
+	for (SaveFileData &level : pfile_read_temp_levels())
+		keyframe.levels.push_back({ std::move(level.name), std::move(level.data) });
 
-		std::getline(command, number, ',');
-		int typeNum = std::stoi(number);
-		auto type = static_cast<DemoMsgType>(typeNum);
+	DemoRecording.WriteKeyframe(keyframe);
+}
 
-		std::getline(command, number, ',');
-		float progressToNextGameTick = std::stof(number);
+/**
+ * @brief Restores the game to the last keyframe before SeekTick, the remaining ticks are then played without rendering
+ */
+void SeekToKeyframe()
+{
+	SeekPending = false;
 
-		switch (type) {
-		case DemoMsgType::Message: {
-			std::getline(command, number, ',');
-			uint32_t message = std::stoi(number);
-			std::getline(command, number, ',');
-			int32_t wParam = std::stoi(number);
-			std::getline(command, number, ',');
-			int32_t lParam = std::stoi(number);
-			PumpDemoMessage(type, message, wParam, lParam, progressToNextGameTick);
-			break;
-		}
-		default:
-			PumpDemoMessage(type, 0, 0, 0, progressToNextGameTick);
-			break;
-		}
+	const int index = DemoPlayback.FindKeyframe(SeekTick);
+	if (index == -1) {
+		Log("No demo keyframe before tick {}, fast forwarding from the start", SeekTick);
+		return;
 	}
 
-	demofile.close();
+	demo::DemoKeyframe keyframe;
+	if (!DemoPlayback.ReadKeyframe(index, keyframe))
+		app_fatal("Unable to read demo keyframe");
 
-	DemoModeLastTick = SDL_GetTicks();
+	// Restored like gamemenu_load_game reloads a save, so nothing from before the seek carries over
+	LoadGameSnapshot(keyframe.gameData.data(), keyframe.gameData.size());
+	std::vector<SaveFileData> levels;
+	for (demo::DemoKeyframeFile &level : keyframe.levels)
+		levels.push_back({ std::move(level.name), std::move(level.data) });
+	pfile_write_temp_levels(levels);
+	SetRndSeed(keyframe.rngState);
 
-	return true;
+	if (!DemoPlayback.SeekToBlock(index + 1))
+		app_fatal("Demo queue empty");
+	LogicTick = DemoPlayback.Blocks()[index].firstTick;
+	LoadPWaterPalette();
+	force_redraw = 255;
+
+	Log("Restored demo keyframe at tick {}", LogicTick);
 }
 
 } // namespace
@@ -138,6 +127,12 @@ void InitPlayBack(int demoNumber, bool timedemo)
 		diablo_quit(1);
 	}
 }
+void InitSeek(int tick)
+{
+	SeekTick = tick;
+	SeekPending = tick > 0;
+}
+
 void InitRecording(int recordNumber)
 {
 	RecordNumber = recordNumber;
@@ -163,16 +158,27 @@ bool IsRecording()
 	return RecordNumber != -1;
 };
 
+void ProcessKeyframe()
+{
+	if (IsRecording() && DemoRecording.KeyframeDue(KeyframeInterval))
+		WriteKeyframe();
+	if (IsRunning() && SeekPending)
+		SeekToKeyframe();
+}
+
 bool GetRunGameLoop(bool &drawGame, bool &processInput)
 {
-	if (Demo_Message_Queue.empty())
+	const bool fastForward = LogicTick < SeekTick;
+
+	const DemoMsg *next = DemoPlayback.Peek();
+	if (next == nullptr)
 		app_fatal("Demo queue empty");
-	demoMsg dmsg = Demo_Message_Queue.front();
+	const DemoMsg dmsg = *next;
 	if (dmsg.type == DemoMsgType::Message)
 		app_fatal("Unexpected Message");
 	// disable additonal rendering to speedup replay
-	drawGame = dmsg.type == DemoMsgType::GameTick;
-	if (!Timedemo) {
+	drawGame = dmsg.type == DemoMsgType::GameTick && !fastForward;
+	if (!Timedemo && !fastForward) {
 		int currentTickCount = SDL_GetTicks();
 		int ticksElapsed = currentTickCount - DemoModeLastTick;
 		bool tickDue = ticksElapsed >= gnTickDelay;
@@ -192,9 +198,17 @@ bool GetRunGameLoop(bool &drawGame, bool &processInput)
 		}
 	}
 	gfProgressToNextGameTick = dmsg.progressToNextGameTick;
-	Demo_Message_Queue.pop_front();
+	DemoPlayback.Pop();
 	if (dmsg.type == DemoMsgType::GameTick)
 		LogicTick++;
+	if (fastForward && LogicTick == SeekTick) {
+		Log("Reached tick {} after {} ms", SeekTick, SDL_GetTicks() - StartTime);
+		DemoModeLastTick = SDL_GetTicks();
+		StartTime = DemoModeLastTick;
+		StartTick = LogicTick;
+		force_redraw = 255;
+		timedemo::Start();
+	}
 	return dmsg.type == DemoMsgType::GameTick;
 }
 
@@ -209,7 +223,7 @@ bool FetchMessage(tagMSG *lpMsg)
 			return true;
 		}
 		if (e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_ESCAPE) {
-			Demo_Message_Queue.clear();
+			DemoPlayback.Close();
 			ClearMessageQueue();
 			DemoNumber = -1;
 			Timedemo = false;
@@ -227,16 +241,14 @@ bool FetchMessage(tagMSG *lpMsg)
 		}
 	}
 
-	if (!Demo_Message_Queue.empty()) {
-		demoMsg dmsg = Demo_Message_Queue.front();
-		if (dmsg.type == DemoMsgType::Message) {
-			lpMsg->message = dmsg.message;
-			lpMsg->lParam = dmsg.lParam;
-			lpMsg->wParam = dmsg.wParam;
-			gfProgressToNextGameTick = dmsg.progressToNextGameTick;
-			Demo_Message_Queue.pop_front();
-			return true;
-		}
+	const DemoMsg *dmsg = DemoPlayback.Peek();
+	if (dmsg != nullptr && dmsg->type == DemoMsgType::Message) {
+		lpMsg->message = dmsg->message;
+		lpMsg->lParam = dmsg->lParam;
+		lpMsg->wParam = dmsg->wParam;
+		gfProgressToNextGameTick = dmsg->progressToNextGameTick;
+		DemoPlayback.Pop();
+		return true;
 	}
 
 	lpMsg->message = 0;
@@ -248,42 +260,56 @@ bool FetchMessage(tagMSG *lpMsg)
 
 void RecordGameLoopResult(bool runGameLoop)
 {
-	DemoRecording << static_cast<uint32_t>(runGameLoop ? DemoMsgType::GameTick : DemoMsgType::Rendering) << "," << gfProgressToNextGameTick << "\n";
+	DemoMsg msg {};
+	msg.type = runGameLoop ? DemoMsgType::GameTick : DemoMsgType::Rendering;
+	msg.progressToNextGameTick = gfProgressToNextGameTick;
+	DemoRecording.Write(msg);
 }
 
 void RecordMessage(tagMSG *lpMsg)
 {
-	if (!gbRunGame || !DemoRecording.is_open())
+	if (!gbRunGame || !DemoRecording.IsOpen())
 		return;
-	DemoRecording << static_cast<uint32_t>(DemoMsgType::Message) << "," << gfProgressToNextGameTick << "," << lpMsg->message << "," << lpMsg->wParam << "," << lpMsg->lParam << "\n";
+	DemoMsg msg {};
+	msg.type = DemoMsgType::Message;
+	msg.message = lpMsg->message;
+	msg.wParam = lpMsg->wParam;
+	msg.lParam = lpMsg->lParam;
+	msg.progressToNextGameTick = gfProgressToNextGameTick;
+	DemoRecording.Write(msg);
 }
 
 void NotifyGameLoopStart()
 {
 	if (IsRecording()) {
-		char demoFilename[16];
-		snprintf(demoFilename, 15, "demo_%d.dmo", RecordNumber);
-		DemoRecording.open(paths::PrefPath() + demoFilename, std::fstream::trunc);
-		DemoRecording << "0," << gSaveNumber << "," << gnScreenWidth << "," << gnScreenHeight << "\n";
+		DemoHeader header;
+		header.version = DemoFileVersion;
+		header.saveNumber = gSaveNumber;
+		header.width = gnScreenWidth;
+		header.height = gnScreenHeight;
+		DemoRecording.Open(GetDemoPath(RecordNumber).c_str(), header);
 	}
 
 	if (IsRunning()) {
 		StartTime = SDL_GetTicks();
 		LogicTick = 0;
+		StartTick = 0;
+		timedemo::Start();
 	}
 }
 
 void NotifyGameLoopEnd()
 {
 	if (IsRecording()) {
-		DemoRecording.close();
+		DemoRecording.Close();
 
 		RecordNumber = -1;
 	}
 
 	if (IsRunning()) {
 		float secounds = (SDL_GetTicks() - StartTime) / 1000.0;
-		SDL_Log("%d frames, %.2f seconds: %.1f fps", LogicTick, secounds, LogicTick / secounds);
+		SDL_Log("%d frames, %.2f seconds: %.1f fps", LogicTick - StartTick, secounds, (LogicTick - StartTick) / secounds);
+		timedemo::Finish(fmt::format("demo_{}.dmo", DemoNumber), LogicTick - StartTick, secounds);
 		gbRunGameResult = false;
 		gbRunGame = false;
 	}
@@ -12,12 +12,23 @@ namespace devilution {
 namespace demo {
 
 void InitPlayBack(int demoNumber, bool timedemo);
+/**
+ * @brief Start playback at the given game tick by restoring the closest keyframe stored in the demo
+ */
+void InitSeek(int tick);
 void InitRecording(int recordNumber);
 void OverrideOptions();
 
 bool IsRunning();
 bool IsRecording();
 
+/**
+ * @brief Writes a keyframe when one is due while recording, or restores one when seeking during playback
+ *
+ * Called at the start of every game loop iteration, before its messages are dispatched, so the commands they queue
+ * are replayed after the keyframe instead of being lost with it.
+ */
+void ProcessKeyframe();
 bool GetRunGameLoop(bool &drawGame, bool &processInput);
 bool FetchMessage(tagMSG *lpMsg);
 void RecordGameLoopResult(bool runGameLoop);
@@ -9,6 +9,7 @@
 #include <climits>
 #include <cstdint>
 
+#include "engine/render/dun_render_simd.hpp"
 #include "lighting.h"
 #include "options.h"
 #include "utils/attributes.h"
@@ -103,6 +104,9 @@ constexpr std::int_fast16_t TriangleHeight = LowerHeight + TriangleUpperHeight;
 /** For triangles, for each pixel drawn vertically, this many pixels are drawn horizontally. */
 constexpr std::int_fast16_t XStep = 2;
 
+/** Vectorized functions for full tile rows, set up by RenderTile */
+const TileRowKernels *RowKernels = nullptr;
+
 std::int_fast16_t GetTileHeight(TileType tile)
 {
 	if (tile == TileType::LeftTriangle || tile == TileType::RightTriangle)
@@ -513,6 +517,10 @@ DVL_ALWAYS_INLINE DVL_ATTRIBUTE_HOT void RenderLineOpaque(std::uint8_t *dst, con
 #endif
 	} else { // Partially lit
 #ifndef DEBUG_RENDER_COLOR
+		if (n == Width && RowKernels->lookup != nullptr) {
+			RowKernels->lookup(dst, src, tbl);
+			return;
+		}
 		for (size_t i = 0; i < n; i++) {
 			dst[i] = tbl[src[i]];
 		}
@@ -527,6 +535,11 @@ DVL_ALWAYS_INLINE DVL_ATTRIBUTE_HOT void RenderLineBlended(std::uint8_t *dst, co
 {
 #ifndef DEBUG_RENDER_COLOR
 	if (Light == LightType::FullyDark) {
+		if (n == Width && RowKernels->lookup != nullptr) {
+			RowKernels->lookup(dst, dst, paletteTransparencyLookup[0]);
+			RowKernels->fillMasked(dst, 0, mask);
+			return;
+		}
 		for (size_t i = 0; i < n; i++, mask <<= 1) {
 			if ((mask & 0x80000000) != 0)
 				dst[i] = 0;
@@ -559,8 +572,21 @@ DVL_ALWAYS_INLINE DVL_ATTRIBUTE_HOT void RenderLineBlended(std::uint8_t *dst, co
 }
 
 template <LightType Light>
-DVL_ALWAYS_INLINE DVL_ATTRIBUTE_HOT void RenderLineStippled(std::uint8_t *dst, const std::uint8_t *src, const std::uint8_t *tbl, std::uint32_t mask)
+DVL_ALWAYS_INLINE DVL_ATTRIBUTE_HOT void RenderLineStippled(std::uint8_t *dst, const std::uint8_t *src, std::uint_fast8_t n, const std::uint8_t *tbl, std::uint32_t mask)
 {
+#ifndef DEBUG_RENDER_COLOR
+	if (n == Width) {
+		if (Light == LightType::FullyDark) {
+			RowKernels->fillMasked(dst, 0, mask);
+		} else if (Light == LightType::FullyLit) {
+			RowKernels->copyMasked(dst, src, mask);
+		} else {
+			RowKernels->lookupMasked(dst, src, tbl, mask);
+		}
+		return;
+	}
+#endif
+
 	if (Light == LightType::FullyDark) {
 		ForEachSetBit(mask, [=](int i) { dst[i] = 0; });
 	} else if (Light == LightType::FullyLit) {
@@ -592,7 +618,7 @@ DVL_ALWAYS_INLINE DVL_ATTRIBUTE_HOT void RenderLine(std::uint8_t *dst, const std
 		} else if (Transparency == TransparencyType::Blended) {
 			RenderLineBlended<Light>(dst, src, n, tbl, mask);
 		} else {
-			RenderLineStippled<Light>(dst, src, tbl, mask);
+			RenderLineStippled<Light>(dst, src, n, tbl, mask);
 		}
 	}
 }
@@ -1396,6 +1422,8 @@ void RenderTile(const Surface &out, int x, int y)
 	if (clip.width <= 0 || clip.height <= 0)
 		return;
 
+	RowKernels = &GetTileRowKernels();
+
 	const std::uint8_t *tbl = &LightTables[256 * LightTableIndex];
 	const auto *pFrameTable = reinterpret_cast<const std::uint32_t *>(pDungeonCels.get());
 	const auto *src = reinterpret_cast<const std::uint8_t *>(&pDungeonCels[SDL_SwapLE32(pFrameTable[level_cel_block & 0xFFF])]);
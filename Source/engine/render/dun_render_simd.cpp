@@ -0,0 +1,367 @@
+/**
+ * @file dun_render_simd.cpp
+ *
+ * Implementation of the vectorized tile row and light kernels.
+ *
+ * The masked kernels turn the 32-bit pixel mask into a byte mask and blend the whole row at once.
+ * The light table lookup needs a byte gather. On x86 the compiler's scalar loop beats both AVX2 gathers
+ * and 16 shuffles over the 256 byte table, so the lookup is only vectorized on AArch64 (4-register table lookups).
+ */
+#include "engine/render/dun_render_simd.hpp"
+
+#include <algorithm>
+
+#include <SDL.h>
+
+#include "utils/attributes.h"
+#include "utils/log.hpp"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define DVL_SIMD_X86
+#include <immintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define DVL_SIMD_NEON
+#include <arm_neon.h>
+#endif
+
+namespace devilution {
+
+namespace {
+
+constexpr int RowWidth = 32;
+
+void CopyMaskedScalar(std::uint8_t *dst, const std::uint8_t *src, std::uint32_t mask)
+{
+	for (int i = 0; i < RowWidth; i++, mask <<= 1) {
+		if ((mask & 0x80000000) != 0)
+			dst[i] = src[i];
+	}
+}
+
+void FillMaskedScalar(std::uint8_t *dst, std::uint8_t color, std::uint32_t mask)
+{
+	for (int i = 0; i < RowWidth; i++, mask <<= 1) {
+		if ((mask & 0x80000000) != 0)
+			dst[i] = color;
+	}
+}
+
+void LookupScalar(std::uint8_t *dst, const std::uint8_t *src, const std::uint8_t *tbl)
+{
+	for (int i = 0; i < RowWidth; i++)
+		dst[i] = tbl[src[i]];
+}
+
+void LookupMaskedScalar(std::uint8_t *dst, const std::uint8_t *src, const std::uint8_t *tbl, std::uint32_t mask)
+{
+	for (int i = 0; i < RowWidth; i++, mask <<= 1) {
+		if ((mask & 0x80000000) != 0)
+			dst[i] = tbl[src[i]];
+	}
+}
+
+constexpr TileRowKernels ScalarKernels { CopyMaskedScalar, FillMaskedScalar, nullptr, LookupMaskedScalar };
+
+void MinBlendScalar(std::uint8_t *dst, const std::uint8_t *src, int count)
+{
+	for (int i = 0; i < count; i++)
+		dst[i] = std::min(dst[i], src[i]);
+}
+
+/** Repeats a byte in all 8 bytes of a 64-bit integer */
+constexpr std::uint64_t Broadcast8(std::uint8_t value)
+{
+	return value * UINT64_C(0x0101010101010101);
+}
+
+#ifdef DVL_SIMD_X86
+
+/** @brief Turns 16 mask bits (the top 16 bits of the argument) into 16 bytes of 0x00 or 0xFF */
+DVL_ATTRIBUTE_TARGET("sse2")
+__m128i ExpandMaskSse2(std::uint32_t mask)
+{
+	const __m128i bits = _mm_set_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+	const __m128i bytes = _mm_set_epi64x(static_cast<std::int64_t>(Broadcast8(mask >> 16)), static_cast<std::int64_t>(Broadcast8(mask >> 24)));
+	return _mm_cmpeq_epi8(_mm_and_si128(bytes, bits), bits);
+}
+
+DVL_ATTRIBUTE_TARGET("sse2")
+__m128i SelectSse2(__m128i mask, __m128i a, __m128i b)
+{
+	return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+DVL_ATTRIBUTE_TARGET("sse2")
+void CopyMaskedSse2(std::uint8_t *dst, const std::uint8_t *src, std::uint32_t mask)
+{
+	for (int i = 0; i < RowWidth; i += 16, mask <<= 16) {
+		const __m128i m = ExpandMaskSse2(mask);
+		const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+		const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i *>(dst + i));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), SelectSse2(m, s, d));
+	}
+}
+
+DVL_ATTRIBUTE_TARGET("sse2")
+void FillMaskedSse2(std::uint8_t *dst, std::uint8_t color, std::uint32_t mask)
+{
+	const __m128i c = _mm_set1_epi8(static_cast<char>(color));
+	for (int i = 0; i < RowWidth; i += 16, mask <<= 16) {
+		const __m128i m = ExpandMaskSse2(mask);
+		const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i *>(dst + i));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), SelectSse2(m, c, d));
+	}
+}
+
+/** The lookup stays scalar, only the blend is vectorized */
+DVL_ATTRIBUTE_TARGET("sse2")
+void LookupMaskedSse2(std::uint8_t *dst, const std::uint8_t *src, const std::uint8_t *tbl, std::uint32_t mask)
+{
+	alignas(16) std::uint8_t lit[RowWidth];
+	LookupScalar(lit, src, tbl);
+	CopyMaskedSse2(dst, lit, mask);
+}
+
+constexpr TileRowKernels Sse2Kernels { CopyMaskedSse2, FillMaskedSse2, nullptr, LookupMaskedSse2 };
+
+/** Light map rows are shorter than 32 bytes, so AVX2 uses this one as well */
+DVL_ATTRIBUTE_TARGET("sse2")
+void MinBlendSse2(std::uint8_t *dst, const std::uint8_t *src, int count)
+{
+	if (count < 16) {
+		MinBlendScalar(dst, src, count);
+		return;
+	}
+	// The last block overlaps the one before it, which is harmless as taking the minimum twice changes nothing
+	for (int i = 0;; i += 16) {
+		i = std::min(i, count - 16);
+		const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(dst + i));
+		const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_min_epu8(a, b));
+		if (i == count - 16)
+			return;
+	}
+}
+
+/** @brief Turns the 32 mask bits into 32 bytes of 0x00 or 0xFF */
+DVL_ATTRIBUTE_TARGET("avx2")
+__m256i ExpandMaskAvx2(std::uint32_t mask)
+{
+	const __m256i bits = _mm256_set1_epi64x(static_cast<std::int64_t>(UINT64_C(0x0102040810204080)));
+	const __m256i bytes = _mm256_set_epi64x(
+	    static_cast<std::int64_t>(Broadcast8(mask)),
+	    static_cast<std::int64_t>(Broadcast8(mask >> 8)),
+	    static_cast<std::int64_t>(Broadcast8(mask >> 16)),
+	    static_cast<std::int64_t>(Broadcast8(mask >> 24)));
+	return _mm256_cmpeq_epi8(_mm256_and_si256(bytes, bits), bits);
+}
+
+DVL_ATTRIBUTE_TARGET("avx2")
+void CopyMaskedAvx2(std::uint8_t *dst, const std::uint8_t *src, std::uint32_t mask)
+{
+	const __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src));
+	const __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(dst));
+	_mm256_storeu_si256(reinterpret_cast<__m256i *>(dst), _mm256_blendv_epi8(d, s, ExpandMaskAvx2(mask)));
+}
+
+DVL_ATTRIBUTE_TARGET("avx2")
+void FillMaskedAvx2(std::uint8_t *dst, std::uint8_t color, std::uint32_t mask)
+{
+	const __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(dst));
+	_mm256_storeu_si256(reinterpret_cast<__m256i *>(dst), _mm256_blendv_epi8(d, _mm256_set1_epi8(static_cast<char>(color)), ExpandMaskAvx2(mask)));
+}
+
+DVL_ATTRIBUTE_TARGET("avx2")
+void LookupMaskedAvx2(std::uint8_t *dst, const std::uint8_t *src, const std::uint8_t *tbl, std::uint32_t mask)
+{
+	alignas(32) std::uint8_t lit[RowWidth];
+	LookupScalar(lit, src, tbl);
+	CopyMaskedAvx2(dst, lit, mask);
+}
+
+constexpr TileRowKernels Avx2Kernels { CopyMaskedAvx2, FillMaskedAvx2, nullptr, LookupMaskedAvx2 };
+
+#endif // DVL_SIMD_X86
+
+#ifdef DVL_SIMD_NEON
+
+/** @brief Turns 16 mask bits (the top 16 bits of the argument) into 16 bytes of 0x00 or 0xFF */
+uint8x16_t ExpandMaskNeon(std::uint32_t mask)
+{
+	const uint8x16_t bits = vreinterpretq_u8_u64(vdupq_n_u64(UINT64_C(0x0102040810204080)));
+	const uint8x16_t bytes = vcombine_u8(vdup_n_u8(static_cast<std::uint8_t>(mask >> 24)), vdup_n_u8(static_cast<std::uint8_t>(mask >> 16)));
+	return vtstq_u8(bytes, bits);
+}
+
+/** @brief Looks up 16 bytes in the 256 byte table held in 4 groups of 4 registers */
+uint8x16_t LookupNeon(const uint8x16x4_t (&table)[4], uint8x16_t indices)
+{
+	// Indices outside of the 64 byte group leave the result unchanged
+	uint8x16_t result = vqtbl4q_u8(table[0], indices);
+	result = vqtbx4q_u8(result, table[1], vsubq_u8(indices, vdupq_n_u8(64)));
+	result = vqtbx4q_u8(result, table[2], vsubq_u8(indices, vdupq_n_u8(128)));
+	return vqtbx4q_u8(result, table[3], vsubq_u8(indices, vdupq_n_u8(192)));
+}
+
+void LoadTableNeon(const std::uint8_t *tbl, uint8x16x4_t (&table)[4])
+{
+	for (int group = 0; group < 4; group++) {
+		for (int i = 0; i < 4; i++)
+			table[group].val[i] = vld1q_u8(tbl + group * 64 + i * 16);
+	}
+}
+
+void CopyMaskedNeon(std::uint8_t *dst, const std::uint8_t *src, std::uint32_t mask)
+{
+	for (int i = 0; i < RowWidth; i += 16, mask <<= 16)
+		vst1q_u8(dst + i, vbslq_u8(ExpandMaskNeon(mask), vld1q_u8(src + i), vld1q_u8(dst + i)));
+}
+
+void FillMaskedNeon(std::uint8_t *dst, std::uint8_t color, std::uint32_t mask)
+{
+	const uint8x16_t c = vdupq_n_u8(color);
+	for (int i = 0; i < RowWidth; i += 16, mask <<= 16)
+		vst1q_u8(dst + i, vbslq_u8(ExpandMaskNeon(mask), c, vld1q_u8(dst + i)));
+}
+
+void LookupNeon(std::uint8_t *dst, const std::uint8_t *src, const std::uint8_t *tbl)
+{
+	uint8x16x4_t table[4];
+	LoadTableNeon(tbl, table);
+	for (int i = 0; i < RowWidth; i += 16)
+		vst1q_u8(dst + i, LookupNeon(table, vld1q_u8(src + i)));
+}
+
+void LookupMaskedNeon(std::uint8_t *dst, const std::uint8_t *src, const std::uint8_t *tbl, std::uint32_t mask)
+{
+	uint8x16x4_t table[4];
+	LoadTableNeon(tbl, table);
+	for (int i = 0; i < RowWidth; i += 16, mask <<= 16)
+		vst1q_u8(dst + i, vbslq_u8(ExpandMaskNeon(mask), LookupNeon(table, vld1q_u8(src + i)), vld1q_u8(dst + i)));
+}
+
+constexpr TileRowKernels NeonKernels { CopyMaskedNeon, FillMaskedNeon, LookupNeon, LookupMaskedNeon };
+
+void MinBlendNeon(std::uint8_t *dst, const std::uint8_t *src, int count)
+{
+	if (count < 16) {
+		MinBlendScalar(dst, src, count);
+		return;
+	}
+	// The last block overlaps the one before it, which is harmless as taking the minimum twice changes nothing
+	for (int i = 0;; i += 16) {
+		i = std::min(i, count - 16);
+		vst1q_u8(dst + i, vminq_u8(vld1q_u8(dst + i), vld1q_u8(src + i)));
+		if (i == count - 16)
+			return;
+	}
+}
+
+#endif // DVL_SIMD_NEON
+
+SimdLevel DetectSimdLevel()
+{
+	SimdLevel best = SimdLevel::Scalar;
+	for (SimdLevel level : { SimdLevel::SSE2, SimdLevel::NEON, SimdLevel::AVX2 }) {
+		if (IsSimdLevelSupported(level))
+			best = level;
+	}
+	LogVerbose("Rendering tiles and lights with {}", SimdLevelName(best));
+	return best;
+}
+
+SimdLevel GetSimdLevel()
+{
+	static const SimdLevel Level = DetectSimdLevel();
+	return Level;
+}
+
+} // namespace
+
+const char *SimdLevelName(SimdLevel level)
+{
+	switch (level) {
+	case SimdLevel::Scalar:
+		return "Scalar";
+	case SimdLevel::SSE2:
+		return "SSE2";
+	case SimdLevel::AVX2:
+		return "AVX2";
+	case SimdLevel::NEON:
+		return "NEON";
+	}
+	return "Unknown";
+}
+
+bool IsSimdLevelSupported(SimdLevel level)
+{
+	switch (level) {
+	case SimdLevel::Scalar:
+		return true;
+#ifdef DVL_SIMD_X86
+	case SimdLevel::SSE2:
+		return SDL_HasSSE2() == SDL_TRUE;
+	case SimdLevel::AVX2:
+#ifdef USE_SDL1
+		return false;
+#else
+		return SDL_HasAVX2() == SDL_TRUE;
+#endif
+#endif
+#ifdef DVL_SIMD_NEON
+	case SimdLevel::NEON:
+		return true;
+#endif
+	default:
+		return false;
+	}
+}
+
+const TileRowKernels &GetTileRowKernels(SimdLevel level)
+{
+	switch (level) {
+#ifdef DVL_SIMD_X86
+	case SimdLevel::SSE2:
+		return Sse2Kernels;
+	case SimdLevel::AVX2:
+		return Avx2Kernels;
+#endif
+#ifdef DVL_SIMD_NEON
+	case SimdLevel::NEON:
+		return NeonKernels;
+#endif
+	default:
+		return ScalarKernels;
+	}
+}
+
+const TileRowKernels &GetTileRowKernels()
+{
+	static const TileRowKernels &Kernels = GetTileRowKernels(GetSimdLevel());
+	return Kernels;
+}
+
+MinBlendKernel GetMinBlendKernel(SimdLevel level)
+{
+	switch (level) {
+#ifdef DVL_SIMD_X86
+	case SimdLevel::SSE2:
+	case SimdLevel::AVX2:
+		return MinBlendSse2;
+#endif
+#ifdef DVL_SIMD_NEON
+	case SimdLevel::NEON:
+		return MinBlendNeon;
+#endif
+	default:
+		return MinBlendScalar;
+	}
+}
+
+MinBlendKernel GetMinBlendKernel()
+{
+	static const MinBlendKernel Kernel = GetMinBlendKernel(GetSimdLevel());
+	return Kernel;
+}
+
+} // namespace devilution
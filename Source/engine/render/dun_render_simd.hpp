@@ -0,0 +1,54 @@
+/**
+ * @file dun_render_simd.hpp
+ *
+ * Vectorized kernels for rendering full 32-pixel rows of level tiles and for applying lights.
+ */
+#pragma once
+
+#include <cstdint>
+
+namespace devilution {
+
+enum class SimdLevel : uint8_t {
+	Scalar,
+	SSE2,
+	AVX2,
+	NEON,
+};
+
+/**
+ * @brief Functions that render one 32-pixel tile row
+ *
+ * The mask has one bit per pixel with the most significant bit for the leftmost pixel,
+ * pixels whose bit isn't set keep their current color.
+ */
+struct TileRowKernels {
+	/** @brief dst[i] = src[i] where the mask is set */
+	void (*copyMasked)(std::uint8_t *dst, const std::uint8_t *src, std::uint32_t mask);
+	/** @brief dst[i] = color where the mask is set */
+	void (*fillMasked)(std::uint8_t *dst, std::uint8_t color, std::uint32_t mask);
+	/** @brief dst[i] = tbl[src[i]], nullptr if the lookup isn't vectorized so callers can use their own loop */
+	void (*lookup)(std::uint8_t *dst, const std::uint8_t *src, const std::uint8_t *tbl);
+	/** @brief dst[i] = tbl[src[i]] where the mask is set */
+	void (*lookupMasked)(std::uint8_t *dst, const std::uint8_t *src, const std::uint8_t *tbl, std::uint32_t mask);
+};
+
+/** @brief dst[i] = min(dst[i], src[i]) for rows of any length, used to apply a light to the light map */
+using MinBlendKernel = void (*)(std::uint8_t *dst, const std::uint8_t *src, int count);
+
+const char *SimdLevelName(SimdLevel level);
+
+/** @brief Whether the kernels for the given level are compiled in and supported by the CPU */
+bool IsSimdLevelSupported(SimdLevel level);
+
+const TileRowKernels &GetTileRowKernels(SimdLevel level);
+
+/** @brief Kernels for the best level the CPU supports, detected on the first call */
+const TileRowKernels &GetTileRowKernels();
+
+MinBlendKernel GetMinBlendKernel(SimdLevel level);
+
+/** @brief Kernel for the best level the CPU supports, detected on the first call */
+MinBlendKernel GetMinBlendKernel();
+
+} // namespace devilution
@@ -316,9 +316,7 @@ void gamemenu_load_game(bool /*bActivate*/)
 	DrawAndBlit();
 	LoadGame(false);
 	ClrDiabloMsg();
-	CornerStone.activated = false;
 	PaletteFadeOut(8);
-	MyPlayerIsDead = false;
 	force_redraw = 255;
 	DrawAndBlit();
 	LoadPWaterPalette();
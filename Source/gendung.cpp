@@ -56,9 +56,9 @@ int8_t dFlags[MAXDUNX][MAXDUNY];
 int8_t dPlayer[MAXDUNX][MAXDUNY];
 int16_t dMonster[MAXDUNX][MAXDUNY];
 int8_t dDead[MAXDUNX][MAXDUNY];
-char dObject[MAXDUNX][MAXDUNY];
-int8_t dItem[MAXDUNX][MAXDUNY];
-int8_t dMissile[MAXDUNX][MAXDUNY];
+EntityIndex dObject[MAXDUNX][MAXDUNY];
+EntityIndex dItem[MAXDUNX][MAXDUNY];
+EntityIndex dMissile[MAXDUNX][MAXDUNY];
 char dSpecial[MAXDUNX][MAXDUNY];
 int themeCount;
 THEME_LOC themeLoc[MAXTHEMES];
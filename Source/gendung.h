@@ -25,6 +25,17 @@ namespace devilution {
 #define MAXTHEMES 50
 #define MAXTILES 2048
 
+/**
+ * @brief Type of the map grids holding item, object or missile numbers
+ *
+ * With EXTENDED_LIMITS there can be more items, objects and missiles than fit in a byte.
+ */
+#ifdef EXTENDED_LIMITS
+using EntityIndex = int16_t;
+#else
+using EntityIndex = int8_t;
+#endif
+
 enum _setlevels : int8_t {
 	SL_NONE,
 	SL_SKELKING,
@@ -216,11 +227,11 @@ extern int16_t dMonster[MAXDUNX][MAXDUNY];
  */
 extern int8_t dDead[MAXDUNX][MAXDUNY];
 /** Contains the object numbers (objects array indices) of the map. */
-extern char dObject[MAXDUNX][MAXDUNY];
+extern EntityIndex dObject[MAXDUNX][MAXDUNY];
 /** Contains the item numbers (items array indices) of the map. */
-extern int8_t dItem[MAXDUNX][MAXDUNY];
+extern EntityIndex dItem[MAXDUNX][MAXDUNY];
 /** Contains the missile numbers (missiles array indices) of the map. */
-extern int8_t dMissile[MAXDUNX][MAXDUNY];
+extern EntityIndex dMissile[MAXDUNX][MAXDUNY];
 /**
  * Contains the arch frame numbers of the map from the special tileset
  * (e.g. "levels/l1data/l1s.cel"). Note, the special tileset of Tristram (i.e.
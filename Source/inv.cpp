@@ -1729,7 +1729,7 @@ bool CanPut(Point position)
 			return false;
 	}
 
-	int8_t oi = dObject[position.x + 1][position.y + 1];
+	int oi = dObject[position.x + 1][position.y + 1];
 	if (oi > 0 && Objects[oi - 1]._oSelFlag != 0) {
 		return false;
 	}
@@ -1739,7 +1739,7 @@ bool CanPut(Point position)
 
 	oi = dObject[position.x + 1][position.y];
 	if (oi > 0) {
-		int8_t oi2 = dObject[position.x][position.y + 1];
+		int oi2 = dObject[position.x][position.y + 1];
 		if (oi2 > 0 && Objects[oi - 1]._oSelFlag != 0 && Objects[oi2 - 1]._oSelFlag != 0)
 			return false;
 	}
@@ -585,7 +585,7 @@ void SetPlrHandSeed(ItemStruct *h, int iseed)
 	h->_iSeed = iseed;
 }
 
-bool GetItemSpace(Point position, int8_t inum)
+bool GetItemSpace(Point position, int inum)
 {
 	int xx = 0;
 	int yy = 0;
@@ -635,7 +635,7 @@ bool GetItemSpace(Point position, int8_t inum)
 	return true;
 }
 
-void GetSuperItemSpace(Point position, int8_t inum)
+void GetSuperItemSpace(Point position, int inum)
 {
 	Point positionToCheck = position;
 	if (GetItemSpace(positionToCheck, inum))
@@ -17,7 +17,11 @@
 
 namespace devilution {
 
+#ifdef EXTENDED_LIMITS
+#define MAXITEMS 1000
+#else
 #define MAXITEMS 127
+#endif
 #define ITEMTYPES 43
 
 #define GOLD_SMALL_LIMIT 1000
@@ -0,0 +1,472 @@
+/**
+ * @file level_pregen.cpp
+ *
+ * Implementation of the speculative generation of the dungeon levels next to the current one.
+ */
+#include "level_pregen.h"
+
+#include <cstring>
+#include <memory>
+#include <mutex>
+
+#include "appfat.h"
+#include "diablo.h"
+#include "drlg_l1.h"
+#include "drlg_l2.h"
+#include "drlg_l3.h"
+#include "drlg_l4.h"
+#include "engine/random.hpp"
+#include "items.h"
+#include "lighting.h"
+#include "multi.h"
+#include "player.h"
+#include "quests.h"
+#include "utils/sdl_cond.h"
+#include "utils/sdl_thread.h"
+
+namespace devilution {
+
+namespace {
+
+static_assert(MAXQUESTS <= 32, "Every quest needs a bit in LayoutKey::missingQuests");
+
+/** Everything besides the level itself that decides how the generators lay out a level */
+struct LayoutKey {
+	int level;
+	lvl_entry entry;
+	dungeon_type type;
+	/** Seeds of the level and the two above it, in single player the catacombs start out from the levels above */
+	uint32_t seeds[3];
+	/** One bit for each quest that is not available in this game */
+	uint32_t missingQuests;
+	bool isMultiplayer;
+	bool originalCathedral;
+	bool disableLighting;
+
+	bool operator==(const LayoutKey &other) const
+	{
+		return level == other.level
+		    && entry == other.entry
+		    && type == other.type
+		    && seeds[0] == other.seeds[0]
+		    && seeds[1] == other.seeds[1]
+		    && seeds[2] == other.seeds[2]
+		    && missingQuests == other.missingQuests
+		    && isMultiplayer == other.isMultiplayer
+		    && originalCathedral == other.originalCathedral
+		    && disableLighting == other.disableLighting;
+	}
+};
+
+/** Everything the generators leave behind for the rest of the level setup */
+struct DungeonLayout {
+	LayoutKey key;
+	uint8_t dungeon[DMAXX][DMAXY];
+	uint8_t pdungeon[DMAXX][DMAXY];
+	uint8_t dflags[DMAXX][DMAXY];
+	int dPiece[MAXDUNX][MAXDUNY];
+	int8_t dTransVal[MAXDUNX][MAXDUNY];
+	char dLight[MAXDUNX][MAXDUNY];
+	int8_t dFlags[MAXDUNX][MAXDUNY];
+	char dSpecial[MAXDUNX][MAXDUNY];
+	char TransVal;
+	bool TransList[256];
+	int ViewX;
+	int ViewY;
+	int dminx;
+	int dminy;
+	int dmaxx;
+	int dmaxy;
+	int setpc_x;
+	int setpc_y;
+	int setpc_w;
+	int setpc_h;
+	bool setloadflag;
+	int themeCount;
+	THEME_LOC themeLoc[MAXTHEMES];
+	int UberRow;
+	int UberCol;
+	bool IsUberRoomOpened;
+	bool IsUberLeverActivated;
+	int UberDiabloMonsterIndex;
+	Point cornerStonePosition;
+	/** Quests placed by the generator, one bit per quest */
+	uint32_t placedQuests;
+	Point questPositions[MAXQUESTS];
+	/** The palette is picked right after the layout */
+	uint32_t rngState;
+};
+
+/** The grids of the current level that the generators clear */
+struct EntityGrids {
+	int8_t dPlayer[MAXDUNX][MAXDUNY];
+	int16_t dMonster[MAXDUNX][MAXDUNY];
+	int8_t dDead[MAXDUNX][MAXDUNY];
+	EntityIndex dObject[MAXDUNX][MAXDUNY];
+	EntityIndex dItem[MAXDUNX][MAXDUNY];
+	EntityIndex dMissile[MAXDUNX][MAXDUNY];
+};
+
+/**
+ * @brief A level that is laid out a slice at a time between the game ticks
+ *
+ * The generator runs on a thread of its own, taking turns with the game thread so only one of them uses the level
+ * globals at any time. Between the slices the level as far as it got is kept aside and the current one swapped back in.
+ */
+struct Pregeneration {
+	/** Index in PregeneratedLayouts */
+	int slot;
+	LayoutKey key;
+	std::unique_ptr<DungeonLayout> layout = std::make_unique<DungeonLayout>();
+	std::unique_ptr<EntityGrids> entities = std::make_unique<EntityGrids>();
+	uint32_t sliceStart;
+	std::optional<uint32_t> timeLimit;
+	/** Set while the generator thread runs, the game thread waits until it is cleared */
+	bool generating = false;
+	bool done = false;
+	SdlMutex mutex;
+	SdlCond turnTaken;
+	SdlThread thread;
+};
+
+/**
+ * Stack of the generator thread. The level generators recurse over the whole map (FindTransparencyValues
+ * and the DRLG fill routines), so this matches the 1 MiB main thread stack they always ran on under
+ * Windows instead of relying on the platform default for new threads, which is much smaller on some ports.
+ */
+constexpr size_t GeneratorStackSize = 1024 * 1024;
+
+/** Offsets and entries of the levels reached by the stairs, up and down */
+constexpr int AdjacentOffsets[2] = { -1, 1 };
+constexpr lvl_entry AdjacentEntries[2] = { ENTRY_PREV, ENTRY_MAIN };
+
+/** The layouts of the levels above and below the current one, null until generated */
+std::unique_ptr<DungeonLayout> PregeneratedLayouts[2];
+/** The current level, kept aside while pregenerating */
+std::unique_ptr<DungeonLayout> SavedLayout;
+std::unique_ptr<EntityGrids> SavedEntities;
+std::unique_ptr<Pregeneration> CurrentPregeneration;
+
+template <typename T, size_t N>
+void CopyGrid(T (&destination)[N], const T (&source)[N])
+{
+	memcpy(destination, source, sizeof(destination));
+}
+
+LayoutKey GetLayoutKey(int level, lvl_entry entry)
+{
+	LayoutKey key {};
+	key.level = level;
+	key.entry = entry;
+	key.type = leveltype;
+	for (int i = 0; i < 3; i++)
+		key.seeds[i] = level >= i ? glSeedTbl[level - i] : 0;
+	for (int i = 0; i < MAXQUESTS; i++) {
+		if (Quests[i]._qactive == QUEST_NOTAVAIL)
+			key.missingQuests |= 1U << i;
+	}
+	key.isMultiplayer = gbIsMultiplayer;
+	key.originalCathedral = Players[MyPlayerId].pOriginalCathedral;
+	key.disableLighting = DisableLighting;
+	return key;
+}
+
+/**
+ * @brief Check if the level can be laid out without leaving the current one, using the tiles that are loaded
+ */
+bool CanPregenerate(int level)
+{
+	if (level <= 0 || level >= NUMLEVELS || level == 16)
+		return false;
+	if (gnLevelTypeTbl[level] != leveltype || (level >= 17) != (currlevel >= 17) || (level >= 21) != (currlevel >= 21))
+		return false;
+	// Set pieces are loaded from files and move the quest entrances
+	for (auto &quest : Quests) {
+		if (quest._qlevel == level && quest._qactive != QUEST_NOTAVAIL)
+			return false;
+	}
+	return true;
+}
+
+void SaveLayout(DungeonLayout &layout)
+{
+	CopyGrid(layout.dungeon, dungeon);
+	CopyGrid(layout.pdungeon, pdungeon);
+	CopyGrid(layout.dflags, dflags);
+	CopyGrid(layout.dPiece, dPiece);
+	CopyGrid(layout.dTransVal, dTransVal);
+	CopyGrid(layout.dLight, dLight);
+	CopyGrid(layout.dFlags, dFlags);
+	CopyGrid(layout.dSpecial, dSpecial);
+	layout.TransVal = TransVal;
+	CopyGrid(layout.TransList, TransList);
+	layout.ViewX = ViewX;
+	layout.ViewY = ViewY;
+	layout.dminx = dminx;
+	layout.dminy = dminy;
+	layout.dmaxx = dmaxx;
+	layout.dmaxy = dmaxy;
+	layout.setpc_x = setpc_x;
+	layout.setpc_y = setpc_y;
+	layout.setpc_w = setpc_w;
+	layout.setpc_h = setpc_h;
+	layout.setloadflag = setloadflag;
+	layout.themeCount = themeCount;
+	CopyGrid(layout.themeLoc, themeLoc);
+	layout.UberRow = UberRow;
+	layout.UberCol = UberCol;
+	layout.IsUberRoomOpened = IsUberRoomOpened;
+	layout.IsUberLeverActivated = IsUberLeverActivated;
+	layout.UberDiabloMonsterIndex = UberDiabloMonsterIndex;
+	layout.cornerStonePosition = CornerStone.position;
+	layout.placedQuests = 0;
+	for (int i = 0; i < MAXQUESTS; i++)
+		layout.questPositions[i] = Quests[i].position;
+	layout.rngState = GetLCGEngineState();
+}
+
+void RestoreLayout(const DungeonLayout &layout)
+{
+	CopyGrid(dungeon, layout.dungeon);
+	CopyGrid(pdungeon, layout.pdungeon);
+	CopyGrid(dflags, layout.dflags);
+	CopyGrid(dPiece, layout.dPiece);
+	CopyGrid(dTransVal, layout.dTransVal);
+	CopyGrid(dLight, layout.dLight);
+	CopyGrid(dFlags, layout.dFlags);
+	CopyGrid(dSpecial, layout.dSpecial);
+	TransVal = layout.TransVal;
+	CopyGrid(TransList, layout.TransList);
+	ViewX = layout.ViewX;
+	ViewY = layout.ViewY;
+	dminx = layout.dminx;
+	dminy = layout.dminy;
+	dmaxx = layout.dmaxx;
+	dmaxy = layout.dmaxy;
+	setpc_x = layout.setpc_x;
+	setpc_y = layout.setpc_y;
+	setpc_w = layout.setpc_w;
+	setpc_h = layout.setpc_h;
+	setloadflag = layout.setloadflag;
+	themeCount = layout.themeCount;
+	CopyGrid(themeLoc, layout.themeLoc);
+	UberRow = layout.UberRow;
+	UberCol = layout.UberCol;
+	IsUberRoomOpened = layout.IsUberRoomOpened;
+	IsUberLeverActivated = layout.IsUberLeverActivated;
+	UberDiabloMonsterIndex = layout.UberDiabloMonsterIndex;
+	CornerStone.position = layout.cornerStonePosition;
+	SetRndSeed(layout.rngState);
+}
+
+void SaveEntityGrids(EntityGrids &grids)
+{
+	CopyGrid(grids.dPlayer, dPlayer);
+	CopyGrid(grids.dMonster, dMonster);
+	CopyGrid(grids.dDead, dDead);
+	CopyGrid(grids.dObject, dObject);
+	CopyGrid(grids.dItem, dItem);
+	CopyGrid(grids.dMissile, dMissile);
+}
+
+void RestoreEntityGrids(const EntityGrids &grids)
+{
+	CopyGrid(dPlayer, grids.dPlayer);
+	CopyGrid(dMonster, grids.dMonster);
+	CopyGrid(dDead, grids.dDead);
+	CopyGrid(dObject, grids.dObject);
+	CopyGrid(dItem, grids.dItem);
+	CopyGrid(dMissile, grids.dMissile);
+}
+
+void GenerateLayout(lvl_entry entry)
+{
+	switch (leveltype) {
+	case DTYPE_CATHEDRAL:
+		CreateL5Dungeon(glSeedTbl[currlevel], entry);
+		break;
+	case DTYPE_CATACOMBS:
+		CreateL2Dungeon(glSeedTbl[currlevel], entry);
+		break;
+	case DTYPE_CAVES:
+		CreateL3Dungeon(glSeedTbl[currlevel], entry);
+		break;
+	case DTYPE_HELL:
+		CreateL4Dungeon(glSeedTbl[currlevel], entry);
+		break;
+	default:
+		app_fatal("GenerateLayout");
+	}
+}
+
+void RunGenerator()
+{
+	Pregeneration &pregeneration = *CurrentPregeneration;
+	GenerateLayout(pregeneration.key.entry);
+
+	std::lock_guard<SdlMutex> lock(pregeneration.mutex);
+	pregeneration.done = true;
+	pregeneration.generating = false;
+	pregeneration.turnTaken.signal();
+}
+
+/**
+ * @brief Lay out another level of the same type for a while, leaving the current level as it is
+ */
+void ContinuePregeneration(std::optional<uint32_t> timeLimit)
+{
+	Pregeneration &pregeneration = *CurrentPregeneration;
+	if (SavedLayout == nullptr) {
+		SavedLayout = std::make_unique<DungeonLayout>();
+		SavedEntities = std::make_unique<EntityGrids>();
+	}
+
+	// Backup current level state
+	SaveLayout(*SavedLayout);
+	SaveEntityGrids(*SavedEntities);
+	BYTE tmpCurrlevel = currlevel;
+	dungeon_type tmpLeveltype = leveltype;
+
+	currlevel = static_cast<BYTE>(pregeneration.key.level);
+	leveltype = pregeneration.key.type;
+	const bool started = pregeneration.thread.joinable();
+	if (started) {
+		RestoreLayout(*pregeneration.layout);
+		RestoreEntityGrids(*pregeneration.entities);
+		for (int i = 0; i < MAXQUESTS; i++)
+			Quests[i].position = pregeneration.layout->questPositions[i];
+	}
+
+	{
+		std::lock_guard<SdlMutex> lock(pregeneration.mutex);
+		pregeneration.sliceStart = SDL_GetTicks();
+		pregeneration.timeLimit = timeLimit;
+		pregeneration.generating = true;
+		if (started)
+			pregeneration.turnTaken.signal();
+		else
+			pregeneration.thread = SdlThread(RunGenerator, GeneratorStackSize);
+		while (pregeneration.generating)
+			pregeneration.turnTaken.wait(pregeneration.mutex);
+	}
+
+	DungeonLayout &layout = *pregeneration.layout;
+	SaveLayout(layout);
+	SaveEntityGrids(*pregeneration.entities);
+	for (int i = 0; i < MAXQUESTS; i++) {
+		if (layout.questPositions[i] != SavedLayout->questPositions[i])
+			layout.placedQuests |= 1U << i;
+		Quests[i].position = SavedLayout->questPositions[i];
+	}
+
+	// Restore current level state
+	currlevel = tmpCurrlevel;
+	leveltype = tmpLeveltype;
+	RestoreLayout(*SavedLayout);
+	RestoreEntityGrids(*SavedEntities);
+
+	if (!pregeneration.done)
+		return;
+
+	pregeneration.thread.join();
+	layout.key = pregeneration.key;
+	PregeneratedLayouts[pregeneration.slot] = std::move(pregeneration.layout);
+	CurrentPregeneration = nullptr;
+}
+
+} // namespace
+
+void CreateDungeonLayout(lvl_entry entry)
+{
+	FinishPregeneration();
+
+	const LayoutKey key = GetLayoutKey(currlevel, entry);
+	for (auto &layout : PregeneratedLayouts) {
+		if (layout == nullptr || !(layout->key == key))
+			continue;
+
+		DRLG_Init_Globals();
+		RestoreLayout(*layout);
+		for (int i = 0; i < MAXQUESTS; i++) {
+			if ((layout->placedQuests & (1U << i)) != 0)
+				Quests[i].position = layout->questPositions[i];
+		}
+		return;
+	}
+
+	GenerateLayout(entry);
+}
+
+bool PregenerateAdjacentLevel(std::optional<uint32_t> timeLimit)
+{
+	if (CurrentPregeneration != nullptr) {
+		ContinuePregeneration(timeLimit);
+		return true;
+	}
+
+	if (setlevel || leveltype == DTYPE_TOWN || pMegaTiles == nullptr)
+		return false;
+
+	for (int i = 0; i < 2; i++) {
+		const int level = currlevel + AdjacentOffsets[i];
+		if (!CanPregenerate(level))
+			continue;
+		const LayoutKey key = GetLayoutKey(level, AdjacentEntries[i]);
+		auto &layout = PregeneratedLayouts[i];
+		if (layout != nullptr && layout->key == key)
+			continue;
+
+		layout = nullptr;
+		CurrentPregeneration = std::make_unique<Pregeneration>();
+		CurrentPregeneration->slot = i;
+		CurrentPregeneration->key = key;
+		ContinuePregeneration(timeLimit);
+		return true;
+	}
+
+	return false;
+}
+
+void PregenerationCheckpoint()
+{
+	// The game thread only lays out levels itself once the pregeneration is finished
+	if (CurrentPregeneration == nullptr || !CurrentPregeneration->generating)
+		return;
+
+	Pregeneration &pregeneration = *CurrentPregeneration;
+	if (!pregeneration.timeLimit || SDL_GetTicks() - pregeneration.sliceStart < *pregeneration.timeLimit)
+		return;
+
+	std::lock_guard<SdlMutex> lock(pregeneration.mutex);
+	pregeneration.generating = false;
+	pregeneration.turnTaken.signal();
+	while (!pregeneration.generating)
+		pregeneration.turnTaken.wait(pregeneration.mutex);
+}
+
+void FinishPregeneration()
+{
+	if (CurrentPregeneration != nullptr)
+		ContinuePregeneration(std::nullopt);
+}
+
+bool IsLevelPregenerated(int level, lvl_entry entry)
+{
+	const LayoutKey key = GetLayoutKey(level, entry);
+	for (auto &layout : PregeneratedLayouts) {
+		if (layout != nullptr && layout->key == key)
+			return true;
+	}
+	return false;
+}
+
+void FreePregeneratedLevels()
+{
+	FinishPregeneration();
+	for (auto &layout : PregeneratedLayouts)
+		layout = nullptr;
+	SavedLayout = nullptr;
+	SavedEntities = nullptr;
+}
+
+} // namespace devilution
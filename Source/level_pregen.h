@@ -0,0 +1,50 @@
+/**
+ * @file level_pregen.h
+ *
+ * Interface of the speculative generation of the dungeon levels next to the current one.
+ */
+#pragma once
+
+#include "gendung.h"
+#include "utils/stdcompat/optional.hpp"
+
+namespace devilution {
+
+/**
+ * @brief Lay out the current level, same as CreateL5Dungeon and the others, swapping in the pregenerated layout if there is one
+ */
+void CreateDungeonLayout(lvl_entry entry);
+
+/**
+ * @brief Generate the layout of one of the levels reached by the stairs of the current level ahead of time
+ *
+ * Only levels using the same tiles as the current one are pregenerated, skipping the ones with quest set pieces. The
+ * generator runs on a thread of its own while the game thread waits, with the state of the current level kept aside
+ * and restored afterwards, so this can run at any time between two game ticks without affecting the game.
+ *
+ * @param timeLimit Milliseconds after which the generator is paused, the next call picks up where it left off
+ * @return false if there was nothing left to generate
+ */
+bool PregenerateAdjacentLevel(std::optional<uint32_t> timeLimit = std::nullopt);
+
+/**
+ * @brief Let the game continue if a pregeneration has used up its time, called by the generators between attempts
+ */
+void PregenerationCheckpoint();
+
+/**
+ * @brief Complete the level that is being pregenerated, nothing else may lay out a level while one is paused
+ */
+void FinishPregeneration();
+
+/**
+ * @brief Check if CreateDungeonLayout would swap in a pregenerated layout for the given level and entry
+ */
+bool IsLevelPregenerated(int level, lvl_entry entry);
+
+/**
+ * @brief Drop the pregenerated layouts, they belong to the current game
+ */
+void FreePregeneratedLevels();
+
+} // namespace devilution
@@ -6,10 +6,14 @@
 #include "lighting.h"
 
 #include <algorithm>
+#include <memory>
+#include <vector>
 
 #include "automap.h"
 #include "diablo.h"
 #include "engine/load_file.hpp"
+#include "engine/rectangle.hpp"
+#include "engine/render/dun_render_simd.hpp"
 #include "player.h"
 
 namespace devilution {
@@ -451,6 +455,29 @@ namespace {
 uint8_t lightradius[16][128];
 bool dovision;
 uint8_t lightblock[64][16][16];
+/** Number of tiles DoLighting can change on each side of the light for a given radius, see MakeLightRadiusTables. */
+uint8_t lightreach[16];
+/** Part of the map that each light was last drawn to, empty if the light isn't in dLight. */
+Rectangle LitAreas[MAXLIGHTS];
+/** Set when dLight can't be trusted to contain exactly the active lights, ProcessLightList then rebuilds the whole map. */
+bool RelightWholeMap = true;
+
+/** Furthest a light reaches from its center in tiles, bounded by the loops of the original quadrant walk */
+constexpr int LightStampReach = 14;
+constexpr int LightStampSize = 2 * LightStampReach + 1;
+
+/**
+ * @brief Light levels DoLighting applies around the center of a light for one radius and sub-tile offset
+ *
+ * Indexed by [dx + LightStampReach][dy + LightStampReach] so that each column matches the memory layout of dLight.
+ * Tiles the light doesn't touch, including the center which depends on the level, hold UINT8_MAX.
+ */
+struct LightStamp {
+	uint8_t values[LightStampSize][LightStampSize];
+};
+
+/** Built on first use for each radius and offset, cleared when the falloff tables change */
+std::unique_ptr<LightStamp> LightStamps[16][64];
 
 /** RadiusAdj maps from VisionCrawlTable index to lighting vision radius adjustment. */
 const BYTE RadiusAdj[23] = { 0, 0, 0, 0, 1, 1, 1, 2, 2, 2, 3, 4, 3, 2, 2, 2, 1, 1, 1, 0, 0, 0, 0 };
@@ -480,6 +507,78 @@ void RotateRadius(int *x, int *y, int *dx, int *dy, int *lx, int *ly, int *bx, i
 	}
 }
 
+/**
+ * @brief Records the light levels of the four rotated quadrants that DoLighting used to walk tile by tile
+ */
+std::unique_ptr<LightStamp> MakeLightStamp(int nRadius, int mult)
+{
+	auto stamp = std::make_unique<LightStamp>();
+	memset(stamp->values, UINT8_MAX, sizeof(stamp->values));
+	const auto setLight = [&stamp](Displacement offset, uint8_t v) {
+		stamp->values[offset.deltaX + LightStampReach][offset.deltaY + LightStampReach] = v;
+	};
+
+	int xoff = mult % 8;
+	int yoff = mult / 8;
+	int distX = xoff;
+	int distY = yoff;
+	int lightX = 0;
+	int lightY = 0;
+	int blockX = 0;
+	int blockY = 0;
+
+	for (int y = 0; y <= LightStampReach; y++) {
+		for (int x = 1; x <= LightStampReach; x++) {
+			int radiusBlock = lightblock[mult][y][x];
+			if (radiusBlock < 128)
+				setLight({ x, y }, lightradius[nRadius][radiusBlock]);
+		}
+	}
+	RotateRadius(&xoff, &yoff, &distX, &distY, &lightX, &lightY, &blockX, &blockY);
+	mult = xoff + 8 * yoff;
+	for (int y = 0; y <= LightStampReach; y++) {
+		for (int x = 1; x <= LightStampReach; x++) {
+			int radiusBlock = lightblock[mult][y + blockY][x + blockX];
+			if (radiusBlock < 128)
+				setLight({ y, -x }, lightradius[nRadius][radiusBlock]);
+		}
+	}
+	RotateRadius(&xoff, &yoff, &distX, &distY, &lightX, &lightY, &blockX, &blockY);
+	mult = xoff + 8 * yoff;
+	for (int y = 0; y <= LightStampReach; y++) {
+		for (int x = 1; x <= LightStampReach; x++) {
+			int radiusBlock = lightblock[mult][y + blockY][x + blockX];
+			if (radiusBlock < 128)
+				setLight({ -x, -y }, lightradius[nRadius][radiusBlock]);
+		}
+	}
+	RotateRadius(&xoff, &yoff, &distX, &distY, &lightX, &lightY, &blockX, &blockY);
+	mult = xoff + 8 * yoff;
+	for (int y = 0; y <= LightStampReach; y++) {
+		for (int x = 1; x <= LightStampReach; x++) {
+			int radiusBlock = lightblock[mult][y + blockY][x + blockX];
+			if (radiusBlock < 128)
+				setLight({ -y, x }, lightradius[nRadius][radiusBlock]);
+		}
+	}
+
+	return stamp;
+}
+
+const LightStamp &GetLightStamp(int nRadius, int mult)
+{
+	std::unique_ptr<LightStamp> &stamp = LightStamps[nRadius][mult];
+	if (stamp == nullptr)
+		stamp = MakeLightStamp(nRadius, mult);
+	return *stamp;
+}
+
+/** @brief Darkens each byte of dst to the matching byte of src where src is brighter */
+void MinBlend(char *dst, const uint8_t *src, int count)
+{
+	GetMinBlendKernel()(reinterpret_cast<uint8_t *>(dst), src, count);
+}
+
 void SetLight(Point position, char v)
 {
 	if (LoadingMapObjects)
@@ -496,38 +595,180 @@ char GetLight(Point position)
 	return dLight[position.x][position.y];
 }
 
-void DoUnLight(int nXPos, int nYPos, int nRadius)
+/**
+ * @brief Returns the tiles DoLighting can change for the given light
+ *
+ * A negative offset moves the center of the light one tile up or left, so the area covers both possible centers.
+ */
+Rectangle GetLightArea(const LightStruct &light)
 {
-	nRadius++;
+	const int reach = lightreach[light._lradius];
+	const Point tile = light.position.tile;
+	const int minX = std::max(tile.x - reach - 1, 0);
+	const int minY = std::max(tile.y - reach - 1, 0);
+	const int maxX = std::min(tile.x + reach + 1, MAXDUNX);
+	const int maxY = std::min(tile.y + reach + 1, MAXDUNY);
+	return { { minX, minY }, { std::max(maxX - minX, 0), std::max(maxY - minY, 0) } };
+}
 
-	int minX = nXPos - nRadius;
-	int maxX = nXPos + nRadius;
-	int minY = nYPos - nRadius;
-	int maxY = nYPos + nRadius;
+bool IsEmpty(const Rectangle &area)
+{
+	return area.size.width == 0 || area.size.height == 0;
+}
 
-	minX = std::max(minX, 0);
-	maxX = std::max(maxX, MAXDUNX);
-	minY = std::max(minY, 0);
-	maxY = std::max(maxY, MAXDUNY);
+bool Overlaps(const Rectangle &a, const Rectangle &b)
+{
+	return a.position.x < b.position.x + b.size.width && b.position.x < a.position.x + a.size.width
+	    && a.position.y < b.position.y + b.size.height && b.position.y < a.position.y + a.size.height;
+}
+
+/** @brief Restores the light level of the static lights in the given area */
+void DoUnLight(const Rectangle &area)
+{
+	for (int x = area.position.x; x < area.position.x + area.size.width; x++) {
+		memcpy(&dLight[x][area.position.y], &dPreLight[x][area.position.y], area.size.height);
+	}
+}
+
+/** A tile seen by a vision source */
+struct VisionTile {
+	uint8_t x;
+	uint8_t y;
+	/** Hit by more than one ray, the crawl then always revealed it on the automap */
+	bool seenTwice;
+};
+
+/**
+ * @brief The tiles one vision source sees, reused as long as the source and the walls around it stay the same
+ */
+struct VisionField {
+	Point position;
+	int radius;
+	/** VisionMapVersion the field was crawled for, 0 if unused */
+	uint32_t version;
+	/** Each tile once, in the order the crawl first reached it */
+	std::vector<VisionTile> tiles;
+	/** Transparency regions made visible through a tile that doesn't block the view */
+	std::vector<int8_t> transparencies;
+};
 
-	for (int y = minY; y < maxY; y++) {
-		for (int x = minX; x < maxX; x++) {
-			if (x >= 0 && x < MAXDUNX && y >= 0 && y < MAXDUNY)
-				dLight[x][y] = dPreLight[x][y];
+/** Fields of the sources in VisionList, kept at the same index */
+VisionField VisionFields[MAXVISION];
+/** For the vision sources that don't go through VisionList */
+VisionField ScratchVisionField;
+/** Bumped whenever the tiles blocking the view may have changed */
+uint32_t VisionMapVersion = 1;
+
+/** The crawl that last reached a tile and the index of the tile in its field */
+struct VisionCrawlMark {
+	uint32_t crawl;
+	uint16_t index;
+};
+VisionCrawlMark VisionCrawlMarks[MAXDUNX][MAXDUNY];
+uint32_t VisionCrawl;
+
+void AddVisionTile(VisionField &field, int x, int y)
+{
+	VisionCrawlMark &mark = VisionCrawlMarks[x][y];
+	if (mark.crawl == VisionCrawl) {
+		field.tiles[mark.index].seenTwice = true;
+		return;
+	}
+	mark.crawl = VisionCrawl;
+	mark.index = static_cast<uint16_t>(field.tiles.size());
+	field.tiles.push_back({ static_cast<uint8_t>(x), static_cast<uint8_t>(y), false });
+}
+
+bool IsInMap(int x, int y)
+{
+	return x >= 0 && x < MAXDUNX && y >= 0 && y < MAXDUNY;
+}
+
+/**
+ * @brief Casts the rays of VisionCrawlTable out from the position and stores every tile they reach
+ */
+void CrawlVision(VisionField &field, Point position, int nRadius)
+{
+	field.position = position;
+	field.radius = nRadius;
+	field.version = VisionMapVersion;
+	field.tiles.clear();
+	field.transparencies.clear();
+
+	VisionCrawl++;
+	if (VisionCrawl == 0) {
+		memset(VisionCrawlMarks, 0, sizeof(VisionCrawlMarks));
+		VisionCrawl = 1;
+	}
+
+	if (IsInMap(position.x, position.y))
+		AddVisionTile(field, position.x, position.y);
+
+	// The four quadrants, a diagonal step is seen past either of the two tiles next to it on the way back to the source
+	constexpr Displacement Quadrants[4] = { { 1, 1 }, { -1, -1 }, { 1, -1 }, { -1, 1 } };
+	for (const Displacement quadrant : Quadrants) {
+		for (int j = 0; j < 23; j++) {
+			bool nBlockerFlag = false;
+			int nLineLen = 2 * (nRadius - RadiusAdj[j]);
+			for (int k = 0; k < nLineLen && !nBlockerFlag; k += 2) {
+				const int dx = VisionCrawlTable[j][k];
+				const int dy = VisionCrawlTable[j][k + 1];
+				const int nCrawlX = position.x + quadrant.deltaX * dx;
+				const int nCrawlY = position.y + quadrant.deltaY * dy;
+				if (!IsInMap(nCrawlX, nCrawlY))
+					continue;
+				nBlockerFlag = nBlockTable[dPiece[nCrawlX][nCrawlY]];
+				bool seen;
+				if (dx > 0 && dy > 0) {
+					const int x1 = nCrawlX - quadrant.deltaX;
+					const int y2 = nCrawlY - quadrant.deltaY;
+					seen = (IsInMap(x1, nCrawlY) && !nBlockTable[dPiece[x1][nCrawlY]])
+					    || (IsInMap(nCrawlX, y2) && !nBlockTable[dPiece[nCrawlX][y2]]);
+				} else {
+					seen = !nBlockerFlag;
+				}
+				if (!seen)
+					continue;
+				AddVisionTile(field, nCrawlX, nCrawlY);
+				if (!nBlockerFlag) {
+					int8_t nTrans = dTransVal[nCrawlX][nCrawlY];
+					if (nTrans != 0 && std::find(field.transparencies.begin(), field.transparencies.end(), nTrans) == field.transparencies.end())
+						field.transparencies.push_back(nTrans);
+				}
+			}
 		}
 	}
 }
 
+/**
+ * @brief Marks the tiles of a field as visible, same as crawling the rays again
+ *
+ * SetAutomapView only ever reveals more of the automap, so calling it once per tile is enough.
+ */
+void ApplyVisionField(const VisionField &field, bool doautomap, bool visible)
+{
+	int8_t addedFlags = BFLAG_VISIBLE;
+	if (doautomap)
+		addedFlags |= BFLAG_EXPLORED;
+	if (visible)
+		addedFlags |= BFLAG_LIT;
+
+	for (const VisionTile &tile : field.tiles) {
+		int8_t &flags = dFlags[tile.x][tile.y];
+		if (doautomap && (tile.seenTwice || flags != 0))
+			SetAutomapView({ tile.x, tile.y });
+		flags |= addedFlags;
+	}
+	for (int8_t nTrans : field.transparencies)
+		TransList[nTrans] = true;
+}
+
 } // namespace
 
 void DoLighting(Point position, int nRadius, int lnum)
 {
 	int xoff = 0;
 	int yoff = 0;
-	int lightX = 0;
-	int lightY = 0;
-	int blockX = 0;
-	int blockY = 0;
 
 	if (lnum >= 0) {
 		xoff = Lights[lnum].position.offset.x;
@@ -542,9 +783,8 @@ void DoLighting(Point position, int nRadius, int lnum)
 		}
 	}
 
-	int distX = xoff;
-	int distY = yoff;
-
+	// The quadrants are cut short near the edge of the map, and the cut on one side of the light also applies to
+	// the quadrant rotated next to it, so keep using the same limits to get the same result
 	int minX = 15;
 	if (position.x - 15 < 0) {
 		minX = position.x + 1;
@@ -570,60 +810,30 @@ void DoLighting(Point position, int nRadius, int lnum)
 		}
 	}
 
-	int mult = xoff + 8 * yoff;
-	for (int y = 0; y < minY; y++) {
-		for (int x = 1; x < maxX; x++) {
-			int radiusBlock = lightblock[mult][y][x];
-			if (radiusBlock < 128) {
-				Point temp = position + Displacement { x, y };
-				int8_t v = lightradius[nRadius][radiusBlock];
-				if (temp.x >= 0 && temp.x < MAXDUNX && temp.y >= 0 && temp.y < MAXDUNY)
-					if (v < GetLight(temp))
-						SetLight(temp, v);
-			}
-		}
-	}
-	RotateRadius(&xoff, &yoff, &distX, &distY, &lightX, &lightY, &blockX, &blockY);
-	mult = xoff + 8 * yoff;
-	for (int y = 0; y < maxY; y++) {
-		for (int x = 1; x < maxX; x++) {
-			int radiusBlock = lightblock[mult][y + blockY][x + blockX];
-			if (radiusBlock < 128) {
-				Point temp = position + Displacement { y, -x };
-				int8_t v = lightradius[nRadius][radiusBlock];
-				if (temp.x >= 0 && temp.x < MAXDUNX && temp.y >= 0 && temp.y < MAXDUNY)
-					if (v < GetLight(temp))
-						SetLight(temp, v);
-			}
-		}
-	}
-	RotateRadius(&xoff, &yoff, &distX, &distY, &lightX, &lightY, &blockX, &blockY);
-	mult = xoff + 8 * yoff;
-	for (int y = 0; y < maxY; y++) {
-		for (int x = 1; x < minX; x++) {
-			int radiusBlock = lightblock[mult][y + blockY][x + blockX];
-			if (radiusBlock < 128) {
-				Point temp = position - Displacement { x, y };
-				int8_t v = lightradius[nRadius][radiusBlock];
-				if (temp.x >= 0 && temp.x < MAXDUNX && temp.y >= 0 && temp.y < MAXDUNY)
-					if (v < GetLight(temp))
-						SetLight(temp, v);
-			}
-		}
-	}
-	RotateRadius(&xoff, &yoff, &distX, &distY, &lightX, &lightY, &blockX, &blockY);
-	mult = xoff + 8 * yoff;
-	for (int y = 0; y < minY; y++) {
-		for (int x = 1; x < minX; x++) {
-			int radiusBlock = lightblock[mult][y + blockY][x + blockX];
-			if (radiusBlock < 128) {
-				Point temp = position + Displacement { -y, x };
-				int8_t v = lightradius[nRadius][radiusBlock];
-				if (temp.x >= 0 && temp.x < MAXDUNX && temp.y >= 0 && temp.y < MAXDUNY)
-					if (v < GetLight(temp))
-						SetLight(temp, v);
-			}
+	auto &lightMap = LoadingMapObjects ? dPreLight : dLight;
+	const LightStamp &stamp = GetLightStamp(nRadius, xoff + 8 * yoff);
+	for (int dx = -LightStampReach; dx <= LightStampReach; dx++) {
+		const int x = position.x + dx;
+		if (x < 0 || x >= MAXDUNX)
+			continue;
+
+		// Each column is made up of at most two quadrants that touch, see MakeLightStamp for their layout
+		int begin;
+		int end;
+		if (dx > 0) {
+			begin = dx < maxY ? 1 - maxX : 0;
+			end = dx < maxX ? minY : 0;
+		} else if (dx == 0) {
+			begin = 1 - maxX;
+			end = minY > 0 ? std::max(minX, 1) : 1;
+		} else {
+			begin = -dx < minX ? 1 - maxY : 1;
+			end = -dx < minY ? minX : 1;
 		}
+		const int y = std::max(position.y + begin, 0);
+		const int count = std::min(position.y + end, MAXDUNY) - y;
+		if (count > 0)
+			MinBlend(&lightMap[x][y], &stamp.values[dx + LightStampReach][y - position.y + LightStampReach], count);
 	}
 }
 
@@ -645,92 +855,8 @@ void DoUnVision(Point position, int nRadius)
 
 void DoVision(Point position, int nRadius, bool doautomap, bool visible)
 {
-
-	if (position.x >= 0 && position.x <= MAXDUNX && position.y >= 0 && position.y <= MAXDUNY) {
-		if (doautomap) {
-			if (dFlags[position.x][position.y] != 0) {
-				SetAutomapView(position);
-			}
-			dFlags[position.x][position.y] |= BFLAG_EXPLORED;
-		}
-		if (visible) {
-			dFlags[position.x][position.y] |= BFLAG_LIT;
-		}
-		dFlags[position.x][position.y] |= BFLAG_VISIBLE;
-	}
-
-	for (int v = 0; v < 4; v++) {
-		for (int j = 0; j < 23; j++) {
-			bool nBlockerFlag = false;
-			int nLineLen = 2 * (nRadius - RadiusAdj[j]);
-			for (int k = 0; k < nLineLen && !nBlockerFlag; k += 2) {
-				int x1adj = 0;
-				int x2adj = 0;
-				int y1adj = 0;
-				int y2adj = 0;
-				int nCrawlX = 0;
-				int nCrawlY = 0;
-				switch (v) {
-				case 0:
-					nCrawlX = position.x + VisionCrawlTable[j][k];
-					nCrawlY = position.y + VisionCrawlTable[j][k + 1];
-					if (VisionCrawlTable[j][k] > 0 && VisionCrawlTable[j][k + 1] > 0) {
-						x1adj = -1;
-						y2adj = -1;
-					}
-					break;
-				case 1:
-					nCrawlX = position.x - VisionCrawlTable[j][k];
-					nCrawlY = position.y - VisionCrawlTable[j][k + 1];
-					if (VisionCrawlTable[j][k] > 0 && VisionCrawlTable[j][k + 1] > 0) {
-						y1adj = 1;
-						x2adj = 1;
-					}
-					break;
-				case 2:
-					nCrawlX = position.x + VisionCrawlTable[j][k];
-					nCrawlY = position.y - VisionCrawlTable[j][k + 1];
-					if (VisionCrawlTable[j][k] > 0 && VisionCrawlTable[j][k + 1] > 0) {
-						x1adj = -1;
-						y2adj = 1;
-					}
-					break;
-				case 3:
-					nCrawlX = position.x - VisionCrawlTable[j][k];
-					nCrawlY = position.y + VisionCrawlTable[j][k + 1];
-					if (VisionCrawlTable[j][k] > 0 && VisionCrawlTable[j][k + 1] > 0) {
-						y1adj = -1;
-						x2adj = 1;
-					}
-					break;
-				}
-				if (nCrawlX >= 0 && nCrawlX < MAXDUNX && nCrawlY >= 0 && nCrawlY < MAXDUNY) {
-					nBlockerFlag = nBlockTable[dPiece[nCrawlX][nCrawlY]];
-					if ((x1adj + nCrawlX >= 0 && x1adj + nCrawlX < MAXDUNX && y1adj + nCrawlY >= 0 && y1adj + nCrawlY < MAXDUNY
-					        && !nBlockTable[dPiece[x1adj + nCrawlX][y1adj + nCrawlY]])
-					    || (x2adj + nCrawlX >= 0 && x2adj + nCrawlX < MAXDUNX && y2adj + nCrawlY >= 0 && y2adj + nCrawlY < MAXDUNY
-					        && !nBlockTable[dPiece[x2adj + nCrawlX][y2adj + nCrawlY]])) {
-						if (doautomap) {
-							if (dFlags[nCrawlX][nCrawlY] != 0) {
-								SetAutomapView({ nCrawlX, nCrawlY });
-							}
-							dFlags[nCrawlX][nCrawlY] |= BFLAG_EXPLORED;
-						}
-						if (visible) {
-							dFlags[nCrawlX][nCrawlY] |= BFLAG_LIT;
-						}
-						dFlags[nCrawlX][nCrawlY] |= BFLAG_VISIBLE;
-						if (!nBlockerFlag) {
-							int8_t nTrans = dTransVal[nCrawlX][nCrawlY];
-							if (nTrans != 0) {
-								TransList[nTrans] = true;
-							}
-						}
-					}
-				}
-			}
-		}
-	}
+	CrawlVision(ScratchVisionField, position, nRadius);
+	ApplyVisionField(ScratchVisionField, doautomap, visible);
 }
 
 void MakeLightTable()
@@ -880,6 +1006,11 @@ void MakeLightTable()
 		*tbl++ = 0;
 	}
 
+	MakeLightRadiusTables();
+}
+
+void MakeLightRadiusTables()
+{
 	for (int j = 0; j < 16; j++) {
 		for (int i = 0; i < 128; i++) {
 			if (i > (j + 1) * 8) {
@@ -916,6 +1047,22 @@ void MakeLightTable()
 			}
 		}
 	}
+
+	// A tile m steps away from the light is at least 8 * m - 7 away in lightblock units,
+	// only tiles with a light level below 15 can change since dLight never goes above 15
+	for (int j = 0; j < 16; j++) {
+		int reach = 0;
+		for (int i = 0; i < 128; i++) {
+			if (lightradius[j][i] < 15)
+				reach = std::min((i + 7) / 8, 14);
+		}
+		lightreach[j] = reach;
+	}
+
+	for (auto &stamps : LightStamps) {
+		for (auto &stamp : stamps)
+			stamp = nullptr;
+	}
 }
 
 #ifdef _DEBUG
@@ -929,6 +1076,7 @@ void ToggleLighting()
 	}
 
 	memcpy(dLight, dPreLight, sizeof(dLight));
+	InvalidateLightMap();
 	for (const auto &player : Players) {
 		if (player.plractive && player.plrlevel == currlevel) {
 			DoLighting(player.position.tile, player._pLightRad, -1);
@@ -951,6 +1099,15 @@ void InitLighting()
 	for (int i = 0; i < MAXLIGHTS; i++) {
 		ActiveLights[i] = i;
 	}
+	InvalidateLightMap();
+}
+
+void InvalidateLightMap()
+{
+	RelightWholeMap = true;
+	for (Rectangle &area : LitAreas) {
+		area = {};
+	}
 }
 
 int AddLight(Point position, int r)
@@ -1046,25 +1203,46 @@ void ProcessLightList()
 	}
 
 	if (UpdateLighting) {
+		// Restore the static lighting where a light was removed, moved or added, taking the area it was
+		// last drawn to from LitAreas as a light can change several times between two updates
+		Rectangle dirty[MAXLIGHTS * 2];
+		int dirtyCount = 0;
+		if (RelightWholeMap) {
+			dirty[dirtyCount++] = { { 0, 0 }, { MAXDUNX, MAXDUNY } };
+			RelightWholeMap = false;
+		}
 		for (int i = 0; i < ActiveLightCount; i++) {
 			int j = ActiveLights[i];
-			if (Lights[j]._ldel) {
-				DoUnLight(Lights[j].position.tile.x, Lights[j].position.tile.y, Lights[j]._lradius);
-			}
-			if (Lights[j]._lunflag) {
-				DoUnLight(Lights[j].position.old.x, Lights[j].position.old.y, Lights[j].oldRadius);
+			if (Lights[j]._ldel || Lights[j]._lunflag || IsEmpty(LitAreas[j])) {
+				if (!IsEmpty(LitAreas[j]))
+					dirty[dirtyCount++] = LitAreas[j];
+				dirty[dirtyCount++] = GetLightArea(Lights[j]);
 				Lights[j]._lunflag = false;
 			}
 		}
+		for (int i = 0; i < dirtyCount; i++) {
+			DoUnLight(dirty[i]);
+		}
+
+		// Lighting only ever makes tiles brighter, so redrawing a light that overlaps a dirty area
+		// leaves the rest of its area as it was
 		for (int i = 0; i < ActiveLightCount; i++) {
 			int j = ActiveLights[i];
-			if (!Lights[j]._ldel) {
-				DoLighting(Lights[j].position.tile, Lights[j]._lradius, j);
+			if (Lights[j]._ldel)
+				continue;
+			const Rectangle area = GetLightArea(Lights[j]);
+			for (int k = 0; k < dirtyCount; k++) {
+				if (Overlaps(area, dirty[k])) {
+					DoLighting(Lights[j].position.tile, Lights[j]._lradius, j);
+					break;
+				}
 			}
+			LitAreas[j] = area;
 		}
 		int i = 0;
 		while (i < ActiveLightCount) {
 			if (Lights[ActiveLights[i]]._ldel) {
+				LitAreas[ActiveLights[i]] = {};
 				ActiveLightCount--;
 				BYTE temp = ActiveLights[ActiveLightCount];
 				ActiveLights[ActiveLightCount] = ActiveLights[i];
@@ -1088,6 +1266,7 @@ void InitVision()
 	VisionCount = 0;
 	dovision = false;
 	VisionId = 1;
+	InvalidateVision();
 
 	for (int i = 0; i < TransVal; i++) {
 		TransList[i] = false;
@@ -1144,6 +1323,15 @@ void ChangeVisionXY(int id, Point position)
 	}
 }
 
+void InvalidateVision()
+{
+	VisionMapVersion++;
+	if (VisionMapVersion == 0)
+		VisionMapVersion = 1;
+	for (VisionField &field : VisionFields)
+		field.version = 0;
+}
+
 void ProcessVisionList()
 {
 	if (!dovision)
@@ -1167,11 +1355,10 @@ void ProcessVisionList()
 		if (vision._ldel)
 			continue;
 
-		DoVision(
-		    vision.position.tile,
-		    vision._lradius,
-		    vision._lflags,
-		    vision._lflags);
+		VisionField &field = VisionFields[i];
+		if (field.version != VisionMapVersion || field.position != vision.position.tile || field.radius != vision._lradius)
+			CrawlVision(field, vision.position.tile, vision._lradius);
+		ApplyVisionField(field, vision._lflags, vision._lflags);
 	}
 	bool delflag;
 	do {
@@ -1184,6 +1371,7 @@ void ProcessVisionList()
 			VisionCount--;
 			if (VisionCount > 0 && i != VisionCount) {
 				vision = VisionList[VisionCount];
+				std::swap(VisionFields[i], VisionFields[VisionCount]);
 			}
 			delflag = true;
 		}
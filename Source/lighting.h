@@ -51,11 +51,15 @@ void DoLighting(Point position, int nRadius, int Lnum);
 void DoUnVision(Point position, int nRadius);
 void DoVision(Point position, int nRadius, bool doautomap, bool visible);
 void MakeLightTable();
+/** @brief Builds the light falloff tables used by DoLighting, part of MakeLightTable */
+void MakeLightRadiusTables();
 #ifdef _DEBUG
 void ToggleLighting();
 #endif
 void InitLightMax();
 void InitLighting();
+/** @brief Makes the next ProcessLightList rebuild dLight for the whole map, for when the lights were replaced without going through AddLight/ChangeLight */
+void InvalidateLightMap();
 int AddLight(Point position, int r);
 void AddUnLight(int i);
 void ChangeLightRadius(int i, int r);
@@ -65,6 +69,8 @@ void ChangeLight(int i, Point position, int r);
 void ProcessLightList();
 void SavePreLighting();
 void InitVision();
+/** @brief Forget the tiles each vision source saw, needs to be called whenever the tiles blocking the view change */
+void InvalidateVision();
 int AddVision(Point position, int r, bool mine);
 void ChangeVisionRadius(int id, int r);
 void ChangeVisionXY(int id, Point position);
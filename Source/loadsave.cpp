@@ -94,6 +94,13 @@ public:
 		m_buffer_ = pfile_read(szFileName, &m_size_);
 	}
 
+	LoadHelper(const byte *data, size_t size)
+	    : m_buffer_(new byte[size])
+	    , m_size_(size)
+	{
+		memcpy(m_buffer_.get(), data, size);
+	}
+
 	bool IsValid(size_t size = 1)
 	{
 		return m_buffer_ != nullptr
@@ -145,22 +152,23 @@ public:
 
 class SaveHelper {
 	const char *m_szFileName_;
-	std::unique_ptr<byte[]> m_buffer_;
-	size_t m_cur_ = 0;
-	size_t m_capacity_;
+	/** Receives the unencoded data instead of the save archive when set */
+	std::vector<byte> *m_target_ = nullptr;
+	/** Grows past the reserved size when needed, so a write is never dropped */
+	std::vector<byte> m_buffer_;
 
 public:
 	SaveHelper(const char *szFileName, size_t bufferLen)
 	    : m_szFileName_(szFileName)
-	    , m_buffer_(new byte[codec_get_encoded_len(bufferLen)])
-	    , m_capacity_(bufferLen)
 	{
+		m_buffer_.reserve(codec_get_encoded_len(bufferLen));
 	}
 
-	bool IsValid(size_t len = 1)
+	SaveHelper(std::vector<byte> &target, size_t bufferLen)
+	    : m_szFileName_(nullptr)
+	    , m_target_(&target)
 	{
-		return m_buffer_ != nullptr
-		    && m_capacity_ >= (m_cur_ + len);
+		m_buffer_.reserve(bufferLen);
 	}
 
 	template <typename T>
@@ -171,17 +179,13 @@ public:
 
 	void Skip(size_t len)
 	{
-		std::memset(&m_buffer_[m_cur_], 0, len);
-		m_cur_ += len;
+		m_buffer_.resize(m_buffer_.size() + len);
 	}
 
 	void WriteBytes(const void *bytes, size_t len)
 	{
-		if (!IsValid(len))
-			return;
-
-		memcpy(&m_buffer_[m_cur_], bytes, len);
-		m_cur_ += len;
+		const auto *first = static_cast<const byte *>(bytes);
+		m_buffer_.insert(m_buffer_.end(), first, first + len);
 	}
 
 	template <class T>
@@ -200,10 +204,17 @@ public:
 
 	~SaveHelper()
 	{
-		const auto encodedLen = codec_get_encoded_len(m_cur_);
+		if (m_target_ != nullptr) {
+			*m_target_ = std::move(m_buffer_);
+			return;
+		}
+
+		const size_t len = m_buffer_.size();
+		const auto encodedLen = codec_get_encoded_len(len);
+		m_buffer_.resize(encodedLen);
 		const char *const password = pfile_get_password();
-		codec_encode(m_buffer_.get(), m_cur_, encodedLen, password);
-		mpqapi_write_file(m_szFileName_, m_buffer_.get(), encodedLen);
+		codec_encode(m_buffer_.data(), len, encodedLen, password);
+		mpqapi_write_file(m_szFileName_, m_buffer_.data(), encodedLen);
 	}
 };
 
@@ -618,7 +629,7 @@ void LoadMonster(LoadHelper *file, MonsterStruct &monster)
 	monster.mtalkmsg = static_cast<_speech_id>(file->NextLE<int32_t>());
 	if (monster.mtalkmsg == TEXT_KING1) // Fix original bad mapping of NONE for monsters
 		monster.mtalkmsg = TEXT_NONE;
-	monster.leader = file->NextLE<uint8_t>();
+	monster.leader = file->NextLE<decltype(monster.leader)>();
 	monster.leaderRelation = static_cast<LeaderRelation>(file->NextLE<uint8_t>());
 	monster.packsize = file->NextLE<uint8_t>();
 	monster.mlid = file->NextLE<int8_t>();
@@ -1274,7 +1285,7 @@ void SaveMonster(SaveHelper *file, MonsterStruct &monster)
 	file->Skip(2); // Alignment
 
 	file->WriteLE<int32_t>(monster.mtalkmsg == TEXT_NONE ? 0 : monster.mtalkmsg); // Replicate original bad mapping of none for monsters
-	file->WriteLE<uint8_t>(monster.leader);
+	file->WriteLE<decltype(monster.leader)>(monster.leader);
 	file->WriteLE<uint8_t>(static_cast<std::uint8_t>(monster.leaderRelation));
 	file->WriteLE<uint8_t>(monster.packsize);
 	file->WriteLE<int8_t>(monster.mlid);
@@ -1442,6 +1453,22 @@ void SavePortal(SaveHelper *file, int i)
 
 const int DiabloItemSaveSize = 368;
 const int HellfireItemSaveSize = 372;
+const int MonsterSaveSize = 215 + sizeof(MonsterStruct::leader);
+const int MissileSaveSize = 176;
+const int ObjectSaveSize = 120;
+
+/**
+ * @brief Magic number of a save game, games saved with EXTENDED_LIMITS have their own so no other build tries to load them
+ */
+uint32_t SaveGameMagic(const char *magic)
+{
+#ifdef EXTENDED_LIMITS
+	const char extendedMagic[4] = { magic[0], magic[1], magic[2], 'X' };
+	return LoadLE32(extendedMagic);
+#else
+	return LoadLE32(magic);
+#endif
+}
 
 } // namespace
 
@@ -1571,17 +1598,17 @@ _item_indexes RemapItemIdxToSpawn(_item_indexes i)
 bool IsHeaderValid(uint32_t magicNumber)
 {
 	gbIsHellfireSaveGame = false;
-	if (magicNumber == LoadLE32("SHAR")) {
+	if (magicNumber == SaveGameMagic("SHAR")) {
 		return true;
 	}
-	if (magicNumber == LoadLE32("SHLF")) {
+	if (magicNumber == SaveGameMagic("SHLF")) {
 		gbIsHellfireSaveGame = true;
 		return true;
 	}
-	if (!gbIsSpawn && magicNumber == LoadLE32("RETL")) {
+	if (!gbIsSpawn && magicNumber == SaveGameMagic("RETL")) {
 		return true;
 	}
-	if (!gbIsSpawn && magicNumber == LoadLE32("HELF")) {
+	if (!gbIsSpawn && magicNumber == SaveGameMagic("HELF")) {
 		gbIsHellfireSaveGame = true;
 		return true;
 	}
@@ -1651,16 +1678,10 @@ void RemoveEmptyInventory(PlayerStruct &player)
 	}
 }
 
-/**
- * @brief Load game state
- * @param firstflag Can be set to false if we are simply reloading the current game
- */
-void LoadGame(bool firstflag)
-{
-	FreeGameMem();
-	pfile_remove_temp_files();
+namespace {
 
-	LoadHelper file("game");
+void LoadGameData(LoadHelper &file, bool firstflag)
+{
 	if (!file.IsValid())
 		app_fatal("%s", _("Unable to open save file archive"));
 
@@ -1737,15 +1758,15 @@ void LoadGame(bool firstflag)
 		for (int i = 0; i < ActiveMonsterCount; i++)
 			LoadMonster(&file, Monsters[ActiveMonsters[i]]);
 		for (int &missileId : ActiveMissiles)
-			missileId = file.NextLE<int8_t>();
+			missileId = file.NextLE<EntityIndex>();
 		for (int &missileId : AvailableMissiles)
-			missileId = file.NextLE<int8_t>();
+			missileId = file.NextLE<EntityIndex>();
 		for (int i = 0; i < ActiveMissileCount; i++)
 			LoadMissile(&file, ActiveMissiles[i]);
 		for (int &objectId : ActiveObjects)
-			objectId = file.NextLE<int8_t>();
+			objectId = file.NextLE<EntityIndex>();
 		for (int &objectId : AvailableObjects)
-			objectId = file.NextLE<int8_t>();
+			objectId = file.NextLE<EntityIndex>();
 		for (int i = 0; i < ActiveObjectCount; i++)
 			LoadObject(&file, ActiveObjects[i]);
 		for (int i = 0; i < ActiveObjectCount; i++)
@@ -1757,6 +1778,7 @@ void LoadGame(bool firstflag)
 			lightId = file.NextLE<uint8_t>();
 		for (int i = 0; i < ActiveLightCount; i++)
 			LoadLighting(&file, &Lights[ActiveLights[i]]);
+		InvalidateLightMap();
 
 		VisionId = file.NextBE<int32_t>();
 		VisionCount = file.NextBE<int32_t>();
@@ -1766,9 +1788,9 @@ void LoadGame(bool firstflag)
 	}
 
 	for (int &itemId : ActiveItems)
-		itemId = file.NextLE<int8_t>();
+		itemId = file.NextLE<EntityIndex>();
 	for (int &itemId : AvailableItems)
-		itemId = file.NextLE<int8_t>();
+		itemId = file.NextLE<EntityIndex>();
 	for (int i = 0; i < ActiveItemCount; i++)
 		LoadItem(&file, ActiveItems[i]);
 	for (bool &uniqueItemFlag : UniqueItemFlags)
@@ -1788,7 +1810,7 @@ void LoadGame(bool firstflag)
 	}
 	for (int j = 0; j < MAXDUNY; j++) {
 		for (int i = 0; i < MAXDUNX; i++) // NOLINT(modernize-loop-convert)
-			dItem[i][j] = file.NextLE<int8_t>();
+			dItem[i][j] = file.NextLE<EntityIndex>();
 	}
 
 	if (leveltype != DTYPE_TOWN) {
@@ -1802,7 +1824,7 @@ void LoadGame(bool firstflag)
 		}
 		for (int j = 0; j < MAXDUNY; j++) {
 			for (int i = 0; i < MAXDUNX; i++) // NOLINT(modernize-loop-convert)
-				dObject[i][j] = file.NextLE<int8_t>();
+				dObject[i][j] = file.NextLE<EntityIndex>();
 		}
 		for (int j = 0; j < MAXDUNY; j++) {
 			for (int i = 0; i < MAXDUNX; i++) // NOLINT(modernize-loop-convert)
@@ -1818,7 +1840,7 @@ void LoadGame(bool firstflag)
 		}
 		for (int j = 0; j < MAXDUNY; j++) {
 			for (int i = 0; i < MAXDUNX; i++) // NOLINT(modernize-loop-convert)
-				dMissile[i][j] = file.NextLE<int8_t>();
+				dMissile[i][j] = file.NextLE<EntityIndex>();
 		}
 	}
 
@@ -1852,6 +1874,45 @@ void LoadGame(bool firstflag)
 	gbIsHellfireSaveGame = gbIsHellfire;
 }
 
+/**
+ * @brief Replaces the running game with the one stored in the file
+ */
+void ReloadGame(LoadHelper &file)
+{
+	LoadGameData(file, false);
+
+	// State that isn't part of a save must not carry over from the replaced game
+	CornerStone.activated = false;
+	MyPlayerIsDead = false;
+}
+
+} // namespace
+
+/**
+ * @brief Load game state
+ * @param firstflag Can be set to false if we are simply reloading the current game
+ */
+void LoadGame(bool firstflag)
+{
+	FreeGameMem();
+	pfile_remove_temp_files();
+
+	LoadHelper file("game");
+	if (firstflag)
+		LoadGameData(file, firstflag);
+	else
+		ReloadGame(file);
+}
+
+void LoadGameSnapshot(const byte *data, size_t size)
+{
+	FreeGameMem();
+	pfile_remove_temp_files();
+
+	LoadHelper file(data, size);
+	ReloadGame(file);
+}
+
 void SaveHeroItems(PlayerStruct &player)
 {
 	size_t itemCount = NUM_INVLOC + NUM_INV_GRID_ELEM + MAXBELTITEMS;
@@ -1864,22 +1925,29 @@ void SaveHeroItems(PlayerStruct &player)
 	SaveItems(&file, player.SpdList, MAXBELTITEMS);
 }
 
+/** Size of the entity lists and records of a level with every slot the build allows in use */
+const size_t EntitiesSaveSize = MAXMONSTERS * (sizeof(int32_t) + MonsterSaveSize)
+    + MAXMISSILES * (2 * sizeof(EntityIndex) + MissileSaveSize)
+    + MAXOBJECTS * (2 * sizeof(EntityIndex) + ObjectSaveSize)
+    + MAXITEMS * (2 * sizeof(EntityIndex) + HellfireItemSaveSize);
+
 // 256 kilobytes + 3 bytes (demo leftover) for file magic (262147)
 // final game uses 4-byte magic instead of 3
-#define FILEBUFF ((256 * 1024) + 3)
+// The entities come on top so a full level fits, SaveHelper grows the buffer if a save still needs more
+#define FILEBUFF ((256 * 1024) + 3 + EntitiesSaveSize)
 
-void SaveGameData()
-{
-	SaveHelper file("game", FILEBUFF);
+namespace {
 
+void SaveGameData(SaveHelper &file)
+{
 	if (gbIsSpawn && !gbIsHellfire)
-		file.WriteLE<uint32_t>(LoadLE32("SHAR"));
+		file.WriteLE<uint32_t>(SaveGameMagic("SHAR"));
 	else if (gbIsSpawn && gbIsHellfire)
-		file.WriteLE<uint32_t>(LoadLE32("SHLF"));
+		file.WriteLE<uint32_t>(SaveGameMagic("SHLF"));
 	else if (!gbIsSpawn && gbIsHellfire)
-		file.WriteLE<uint32_t>(LoadLE32("HELF"));
+		file.WriteLE<uint32_t>(SaveGameMagic("HELF"));
 	else if (!gbIsSpawn && !gbIsHellfire)
-		file.WriteLE<uint32_t>(LoadLE32("RETL"));
+		file.WriteLE<uint32_t>(SaveGameMagic("RETL"));
 	else
 		app_fatal("%s", _("Invalid game state"));
 
@@ -1927,15 +1995,15 @@ void SaveGameData()
 		for (int i = 0; i < ActiveMonsterCount; i++)
 			SaveMonster(&file, Monsters[ActiveMonsters[i]]);
 		for (int missileId : ActiveMissiles)
-			file.WriteLE<int8_t>(missileId);
+			file.WriteLE<EntityIndex>(missileId);
 		for (int missileId : AvailableMissiles)
-			file.WriteLE<int8_t>(missileId);
+			file.WriteLE<EntityIndex>(missileId);
 		for (int i = 0; i < ActiveMissileCount; i++)
 			SaveMissile(&file, ActiveMissiles[i]);
 		for (int objectId : ActiveObjects)
-			file.WriteLE<int8_t>(objectId);
+			file.WriteLE<EntityIndex>(objectId);
 		for (int objectId : AvailableObjects)
-			file.WriteLE<int8_t>(objectId);
+			file.WriteLE<EntityIndex>(objectId);
 		for (int i = 0; i < ActiveObjectCount; i++)
 			SaveObject(&file, ActiveObjects[i]);
 
@@ -1954,9 +2022,9 @@ void SaveGameData()
 	}
 
 	for (int itemId : ActiveItems)
-		file.WriteLE<int8_t>(itemId);
+		file.WriteLE<EntityIndex>(itemId);
 	for (int itemId : AvailableItems)
-		file.WriteLE<int8_t>(itemId);
+		file.WriteLE<EntityIndex>(itemId);
 	for (int i = 0; i < ActiveItemCount; i++)
 		SaveItem(&file, &Items[ActiveItems[i]]);
 	for (bool uniqueItemFlag : UniqueItemFlags)
@@ -1976,7 +2044,7 @@ void SaveGameData()
 	}
 	for (int j = 0; j < MAXDUNY; j++) {
 		for (int i = 0; i < MAXDUNX; i++) // NOLINT(modernize-loop-convert)
-			file.WriteLE<int8_t>(dItem[i][j]);
+			file.WriteLE<EntityIndex>(dItem[i][j]);
 	}
 
 	if (leveltype != DTYPE_TOWN) {
@@ -1990,7 +2058,7 @@ void SaveGameData()
 		}
 		for (int j = 0; j < MAXDUNY; j++) {
 			for (int i = 0; i < MAXDUNX; i++) // NOLINT(modernize-loop-convert)
-				file.WriteLE<int8_t>(dObject[i][j]);
+				file.WriteLE<EntityIndex>(dObject[i][j]);
 		}
 		for (int j = 0; j < MAXDUNY; j++) {
 			for (int i = 0; i < MAXDUNX; i++) // NOLINT(modernize-loop-convert)
@@ -2006,7 +2074,7 @@ void SaveGameData()
 		}
 		for (int j = 0; j < MAXDUNY; j++) {
 			for (int i = 0; i < MAXDUNX; i++) // NOLINT(modernize-loop-convert)
-				file.WriteLE<int8_t>(dMissile[i][j]);
+				file.WriteLE<EntityIndex>(dMissile[i][j]);
 		}
 	}
 
@@ -2020,6 +2088,24 @@ void SaveGameData()
 	file.WriteBE<int32_t>(AutoMapScale);
 }
 
+} // namespace
+
+void SaveGameData()
+{
+	SaveHelper file("game", FILEBUFF);
+	SaveGameData(file);
+}
+
+std::vector<byte> SaveGameSnapshot()
+{
+	std::vector<byte> snapshot;
+	{
+		SaveHelper file(snapshot, FILEBUFF);
+		SaveGameData(file);
+	}
+	return snapshot;
+}
+
 void SaveGame()
 {
 	gbValidSaveFile = true;
@@ -2056,17 +2142,17 @@ void SaveLevel()
 		for (int i = 0; i < ActiveMonsterCount; i++)
 			SaveMonster(&file, Monsters[ActiveMonsters[i]]);
 		for (int objectId : ActiveObjects)
-			file.WriteLE<int8_t>(objectId);
+			file.WriteLE<EntityIndex>(objectId);
 		for (int objectId : AvailableObjects)
-			file.WriteLE<int8_t>(objectId);
+			file.WriteLE<EntityIndex>(objectId);
 		for (int i = 0; i < ActiveObjectCount; i++)
 			SaveObject(&file, ActiveObjects[i]);
 	}
 
 	for (int itemId : ActiveItems)
-		file.WriteLE<int8_t>(itemId);
+		file.WriteLE<EntityIndex>(itemId);
 	for (int itemId : AvailableItems)
-		file.WriteLE<int8_t>(itemId);
+		file.WriteLE<EntityIndex>(itemId);
 
 	for (int i = 0; i < ActiveItemCount; i++)
 		SaveItem(&file, &Items[ActiveItems[i]]);
@@ -2077,7 +2163,7 @@ void SaveLevel()
 	}
 	for (int j = 0; j < MAXDUNY; j++) {
 		for (int i = 0; i < MAXDUNX; i++) // NOLINT(modernize-loop-convert)
-			file.WriteLE<int8_t>(dItem[i][j]);
+			file.WriteLE<EntityIndex>(dItem[i][j]);
 	}
 
 	if (leveltype != DTYPE_TOWN) {
@@ -2087,7 +2173,7 @@ void SaveLevel()
 		}
 		for (int j = 0; j < MAXDUNY; j++) {
 			for (int i = 0; i < MAXDUNX; i++) // NOLINT(modernize-loop-convert)
-				file.WriteLE<int8_t>(dObject[i][j]);
+				file.WriteLE<EntityIndex>(dObject[i][j]);
 		}
 		for (int j = 0; j < MAXDUNY; j++) {
 			for (int i = 0; i < MAXDUNX; i++) // NOLINT(modernize-loop-convert)
@@ -2103,7 +2189,7 @@ void SaveLevel()
 		}
 		for (int j = 0; j < MAXDUNY; j++) {
 			for (int i = 0; i < MAXDUNX; i++) // NOLINT(modernize-loop-convert)
-				file.WriteLE<int8_t>(dMissile[i][j]);
+				file.WriteLE<EntityIndex>(dMissile[i][j]);
 		}
 	}
 
@@ -2139,9 +2225,9 @@ void LoadLevel()
 		for (int i = 0; i < ActiveMonsterCount; i++)
 			LoadMonster(&file, Monsters[ActiveMonsters[i]]);
 		for (int &objectId : ActiveObjects)
-			objectId = file.NextLE<int8_t>();
+			objectId = file.NextLE<EntityIndex>();
 		for (int &objectId : AvailableObjects)
-			objectId = file.NextLE<int8_t>();
+			objectId = file.NextLE<EntityIndex>();
 		for (int i = 0; i < ActiveObjectCount; i++)
 			LoadObject(&file, ActiveObjects[i]);
 		if (!gbSkipSync) {
@@ -2151,9 +2237,9 @@ void LoadLevel()
 	}
 
 	for (int &itemId : ActiveItems)
-		itemId = file.NextLE<int8_t>();
+		itemId = file.NextLE<EntityIndex>();
 	for (int &itemId : AvailableItems)
-		itemId = file.NextLE<int8_t>();
+		itemId = file.NextLE<EntityIndex>();
 	for (int i = 0; i < ActiveItemCount; i++)
 		LoadItem(&file, ActiveItems[i]);
 
@@ -2163,7 +2249,7 @@ void LoadLevel()
 	}
 	for (int j = 0; j < MAXDUNY; j++) {
 		for (int i = 0; i < MAXDUNX; i++) // NOLINT(modernize-loop-convert)
-			dItem[i][j] = file.NextLE<int8_t>();
+			dItem[i][j] = file.NextLE<EntityIndex>();
 	}
 
 	if (leveltype != DTYPE_TOWN) {
@@ -2173,7 +2259,7 @@ void LoadLevel()
 		}
 		for (int j = 0; j < MAXDUNY; j++) {
 			for (int i = 0; i < MAXDUNX; i++) // NOLINT(modernize-loop-convert)
-				dObject[i][j] = file.NextLE<int8_t>();
+				dObject[i][j] = file.NextLE<EntityIndex>();
 		}
 		for (int j = 0; j < MAXDUNY; j++) {
 			for (int i = 0; i < MAXDUNX; i++) // NOLINT(modernize-loop-convert)
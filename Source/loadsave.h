@@ -5,6 +5,8 @@
  */
 #pragma once
 
+#include <vector>
+
 #include "player.h"
 
 namespace devilution {
@@ -26,9 +28,17 @@ void LoadHeroItems(PlayerStruct &player);
  */
 void RemoveEmptyInventory(PlayerStruct &player);
 void LoadGame(bool firstflag);
+/**
+ * @brief Restores the game state from a buffer created by SaveGameSnapshot, the same way LoadGame reloads a game
+ */
+void LoadGameSnapshot(const byte *data, size_t size);
 void SaveHotkeys();
 void SaveHeroItems(PlayerStruct &player);
 void SaveGameData();
+/**
+ * @brief Serializes the same state as SaveGameData into memory instead of the save archive
+ */
+std::vector<byte> SaveGameSnapshot();
 void SaveGame();
 void SaveLevel();
 void LoadLevel();
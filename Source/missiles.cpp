@@ -132,7 +132,7 @@ void UpdateMissileVelocity(MissileStruct &missile, Point source, Point destinati
  * @brief Add the missile to the lookup tables
  * @param i Missiles index
  */
-void PutMissile(int8_t i)
+void PutMissile(int i)
 {
 	auto &missile = Missiles[i];
 	Point position = missile.position.tile;
@@ -3250,7 +3250,7 @@ void MI_Lightball(int i)
 	CheckMissileCol(missile, missile._midam, missile._midam, false, missile.position.tile, false);
 	if (missile._miHitFlag)
 		missile._mirange = j;
-	int8_t obj = dObject[tx][ty];
+	int obj = dObject[tx][ty];
 	if (obj != 0 && tx == missile.position.tile.x && ty == missile.position.tile.y) {
 		int oi = (obj > 0) ? (obj - 1) : -(obj + 1);
 		if (Objects[oi]._otype == OBJ_SHRINEL || Objects[oi]._otype == OBJ_SHRINER)
@@ -16,7 +16,11 @@
 
 namespace devilution {
 
+#ifdef EXTENDED_LIMITS
+#define MAXMISSILES 1000
+#else
 #define MAXMISSILES 125
+#endif
 
 constexpr Point GolemHoldingCell = Point { 1, 0 };
 
@@ -26,6 +26,7 @@
 #include "missiles.h"
 #include "movie.h"
 #include "options.h"
+#include "path_cache.h"
 #include "spelldat.h"
 #include "storm/storm.h"
 #include "themes.h"
@@ -68,6 +69,16 @@ namespace {
 int totalmonsters;
 int monstimgtot;
 int uniquetrans;
+/** The last path search of each monster, for when it tries the same search again */
+CachedPath MonsterPaths[MAXMONSTERS];
+/**
+ * @brief The golems in the order of ActiveMonsters, the only monsters a monster attacks unless it is a golem or berserk
+ *
+ * Collected by ProcessMonsters before the monsters act, as no monster becomes a golem on a monster's turn. -1 when not
+ * collected, UpdateEnemy then looks through all monsters.
+ */
+int GolemTargets[MAXMONSTERS];
+int GolemTargetCount = -1;
 
 // BUGFIX: MWVel velocity values are not rounded consistently. The correct
 // formula for monster walk velocity is calculated as follows (for 16, 32 and 64
@@ -825,76 +836,6 @@ bool IsRanged(MonsterStruct &monster)
 	return IsAnyOf(monster._mAi, AI_SKELBOW, AI_GOATBOW, AI_SUCC, AI_LAZHELP);
 }
 
-void UpdateEnemy(MonsterStruct &monster)
-{
-	Point target;
-	int menemy = -1;
-	int bestDist = -1;
-	bool bestsameroom = false;
-	const auto &position = monster.position.tile;
-	if ((monster._mFlags & MFLAG_BERSERK) != 0 || (monster._mFlags & MFLAG_GOLEM) == 0) {
-		for (int pnum = 0; pnum < MAX_PLRS; pnum++) {
-			auto &player = Players[pnum];
-			if (!player.plractive || currlevel != player.plrlevel || player._pLvlChanging
-			    || (((player._pHitPoints >> 6) == 0) && gbIsMultiplayer))
-				continue;
-			bool sameroom = (dTransVal[position.x][position.y] == dTransVal[player.position.tile.x][player.position.tile.y]);
-			int dist = position.WalkingDistance(player.position.tile);
-			if ((sameroom && !bestsameroom)
-			    || ((sameroom || !bestsameroom) && dist < bestDist)
-			    || (menemy == -1)) {
-				monster._mFlags &= ~MFLAG_TARGETS_MONSTER;
-				menemy = pnum;
-				target = player.position.future;
-				bestDist = dist;
-				bestsameroom = sameroom;
-			}
-		}
-	}
-	for (int j = 0; j < ActiveMonsterCount; j++) {
-		int mi = ActiveMonsters[j];
-		auto &otherMonster = Monsters[mi];
-		if (&otherMonster == &monster)
-			continue;
-		if ((otherMonster._mhitpoints >> 6) <= 0)
-			continue;
-		if (otherMonster.position.tile == GolemHoldingCell)
-			continue;
-		if (M_Talker(otherMonster) && otherMonster.mtalkmsg != TEXT_NONE)
-			continue;
-		if ((monster._mFlags & MFLAG_GOLEM) != 0 && (otherMonster._mFlags & MFLAG_GOLEM) != 0) // prevent golems from fighting each other
-			continue;
-
-		int dist = otherMonster.position.tile.WalkingDistance(position);
-		if (((monster._mFlags & MFLAG_GOLEM) == 0
-		        && (monster._mFlags & MFLAG_BERSERK) == 0
-		        && dist >= 2
-		        && !IsRanged(monster))
-		    || ((monster._mFlags & MFLAG_GOLEM) == 0
-		        && (monster._mFlags & MFLAG_BERSERK) == 0
-		        && (otherMonster._mFlags & MFLAG_GOLEM) == 0)) {
-			continue;
-		}
-		bool sameroom = dTransVal[position.x][position.y] == dTransVal[otherMonster.position.tile.x][otherMonster.position.tile.y];
-		if ((sameroom && !bestsameroom)
-		    || ((sameroom || !bestsameroom) && dist < bestDist)
-		    || (menemy == -1)) {
-			monster._mFlags |= MFLAG_TARGETS_MONSTER;
-			menemy = mi;
-			target = otherMonster.position.future;
-			bestDist = dist;
-			bestsameroom = sameroom;
-		}
-	}
-	if (menemy != -1) {
-		monster._mFlags &= ~MFLAG_NO_ENEMY;
-		monster._menemy = menemy;
-		monster.enemyPosition = target;
-	} else {
-		monster._mFlags |= MFLAG_NO_ENEMY;
-	}
-}
-
 /**
  * @brief Make the AI wait a bit before thinking again
  * @param len
@@ -2004,7 +1945,7 @@ bool RandomWalk2(int i, Direction md)
  */
 bool IsTileSafe(const MonsterStruct &monster, Point position)
 {
-	int8_t mi = dMissile[position.x][position.y];
+	int mi = dMissile[position.x][position.y];
 	if (mi == 0) {
 		return true;
 	}
@@ -2070,6 +2011,22 @@ bool IsTileAccessible(const MonsterStruct &monster, Point position)
 	return IsTileSafe(monster, position);
 }
 
+/**
+ * @brief Monsters in the same class only get different answers from IsTileAccessible for tiles that somebody stands on
+ */
+uint8_t GetPathPredicateClass(const MonsterStruct &monster)
+{
+	const bool diablo = monster.MType->mtype == MT_DIABLO;
+	uint8_t predicateClass = 0;
+	if ((monster._mFlags & MFLAG_CAN_OPEN_DOOR) != 0)
+		predicateClass |= 1;
+	if ((monster.mMagicRes & IMMUNE_FIRE) == 0 || diablo)
+		predicateClass |= 2;
+	if ((monster.mMagicRes & IMMUNE_LIGHTNING) == 0 || diablo)
+		predicateClass |= 4;
+	return predicateClass;
+}
+
 bool AiPlanWalk(int i)
 {
 	int8_t path[MAX_PATH_LENGTH];
@@ -2080,7 +2037,12 @@ bool AiPlanWalk(int i)
 	assert(i >= 0 && i < MAXMONSTERS);
 	auto &monster = Monsters[i];
 
-	if (FindPath([&monster](Point position) { return IsTileAccessible(monster, position); }, monster.position.tile, monster.enemyPosition, path) == 0) {
+	// Skip the search when walls alone keep the monster away from its enemy
+	if (!MightFindPath(monster.position.tile, monster.enemyPosition))
+		return false;
+
+	const auto posOk = [&monster](Point position) { return IsTileAccessible(monster, position); };
+	if (MonsterPaths[i].FindPath(posOk, GetPathPredicateClass(monster), monster.position.tile, monster.enemyPosition, path) == 0) {
 		return false;
 	}
 
@@ -3973,6 +3935,83 @@ bool M_Talker(MonsterStruct &monster)
 	return IsAnyOf(monster._mAi, AI_LAZARUS, AI_WARLORD, AI_GARBUD, AI_ZHAR, AI_SNOTSPIL, AI_LACHDAN, AI_LAZHELP);
 }
 
+void UpdateEnemy(MonsterStruct &monster)
+{
+	Point target;
+	int menemy = -1;
+	int bestDist = -1;
+	bool bestsameroom = false;
+	const auto &position = monster.position.tile;
+	if ((monster._mFlags & MFLAG_BERSERK) != 0 || (monster._mFlags & MFLAG_GOLEM) == 0) {
+		for (int pnum = 0; pnum < MAX_PLRS; pnum++) {
+			auto &player = Players[pnum];
+			if (!player.plractive || currlevel != player.plrlevel || player._pLvlChanging
+			    || (((player._pHitPoints >> 6) == 0) && gbIsMultiplayer))
+				continue;
+			bool sameroom = (dTransVal[position.x][position.y] == dTransVal[player.position.tile.x][player.position.tile.y]);
+			int dist = position.WalkingDistance(player.position.tile);
+			if ((sameroom && !bestsameroom)
+			    || ((sameroom || !bestsameroom) && dist < bestDist)
+			    || (menemy == -1)) {
+				monster._mFlags &= ~MFLAG_TARGETS_MONSTER;
+				menemy = pnum;
+				target = player.position.future;
+				bestDist = dist;
+				bestsameroom = sameroom;
+			}
+		}
+	}
+	const auto considerMonster = [&](int mi) {
+		auto &otherMonster = Monsters[mi];
+		if (&otherMonster == &monster)
+			return;
+		if ((otherMonster._mhitpoints >> 6) <= 0)
+			return;
+		if (otherMonster.position.tile == GolemHoldingCell)
+			return;
+		if (M_Talker(otherMonster) && otherMonster.mtalkmsg != TEXT_NONE)
+			return;
+		if ((monster._mFlags & MFLAG_GOLEM) != 0 && (otherMonster._mFlags & MFLAG_GOLEM) != 0) // prevent golems from fighting each other
+			return;
+
+		int dist = otherMonster.position.tile.WalkingDistance(position);
+		if (((monster._mFlags & MFLAG_GOLEM) == 0
+		        && (monster._mFlags & MFLAG_BERSERK) == 0
+		        && dist >= 2
+		        && !IsRanged(monster))
+		    || ((monster._mFlags & MFLAG_GOLEM) == 0
+		        && (monster._mFlags & MFLAG_BERSERK) == 0
+		        && (otherMonster._mFlags & MFLAG_GOLEM) == 0)) {
+			return;
+		}
+		bool sameroom = dTransVal[position.x][position.y] == dTransVal[otherMonster.position.tile.x][otherMonster.position.tile.y];
+		if ((sameroom && !bestsameroom)
+		    || ((sameroom || !bestsameroom) && dist < bestDist)
+		    || (menemy == -1)) {
+			monster._mFlags |= MFLAG_TARGETS_MONSTER;
+			menemy = mi;
+			target = otherMonster.position.future;
+			bestDist = dist;
+			bestsameroom = sameroom;
+		}
+	};
+	if (GolemTargetCount >= 0 && (monster._mFlags & (MFLAG_GOLEM | MFLAG_BERSERK)) == 0) {
+		// Skips the monsters that considerMonster ignores anyway, without changing the order of the golems
+		for (int j = 0; j < GolemTargetCount; j++)
+			considerMonster(GolemTargets[j]);
+	} else {
+		for (int j = 0; j < ActiveMonsterCount; j++)
+			considerMonster(ActiveMonsters[j]);
+	}
+	if (menemy != -1) {
+		monster._mFlags &= ~MFLAG_NO_ENEMY;
+		monster._menemy = menemy;
+		monster.enemyPosition = target;
+	} else {
+		monster._mFlags |= MFLAG_NO_ENEMY;
+	}
+}
+
 void M_StartStand(MonsterStruct &monster, Direction md)
 {
 	ClearMVars(monster);
@@ -4307,11 +4346,28 @@ void DeleteMonsterList()
 	}
 }
 
+void CollectGolemTargets()
+{
+	GolemTargetCount = 0;
+	for (int i = 0; i < ActiveMonsterCount; i++) {
+		int mi = ActiveMonsters[i];
+		if ((Monsters[mi]._mFlags & MFLAG_GOLEM) != 0)
+			GolemTargets[GolemTargetCount++] = mi;
+	}
+}
+
+void ForgetGolemTargets()
+{
+	GolemTargetCount = -1;
+}
+
 void ProcessMonsters()
 {
 	DeleteMonsterList();
 
 	assert(ActiveMonsterCount >= 0 && ActiveMonsterCount <= MAXMONSTERS);
+	CollectGolemTargets();
+
 	for (int i = 0; i < ActiveMonsterCount; i++) {
 		int mi = ActiveMonsters[i];
 		auto &monster = Monsters[mi];
@@ -4428,6 +4484,7 @@ void ProcessMonsters()
 			monster.AnimInfo.ProcessAnimation((monster._mFlags & MFLAG_LOCK_ANIMATION) != 0, (monster._mFlags & MFLAG_ALLOW_SPECIAL) != 0);
 		}
 	}
+	ForgetGolemTargets();
 
 	DeleteMonsterList();
 }
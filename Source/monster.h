@@ -25,7 +25,11 @@
 
 namespace devilution {
 
+#ifdef EXTENDED_LIMITS
+#define MAXMONSTERS 1000
+#else
 #define MAXMONSTERS 200
+#endif
 #define MAX_LVLMTYPES 24
 
 enum monster_flag : uint16_t {
@@ -208,7 +212,11 @@ struct MonsterStruct { // note: missing field _mAFNum
 	uint8_t mArmorClass;
 	uint16_t mMagicRes;
 	_speech_id mtalkmsg;
+#ifdef EXTENDED_LIMITS
+	uint16_t leader;
+#else
 	uint8_t leader;
+#endif
 	LeaderRelation leaderRelation;
 	uint8_t packsize;
 	int8_t mlid; // BUGFIX -1 is used when not emitting light this should be signed (fixed)
@@ -250,6 +258,10 @@ void SetMapMonsters(const uint16_t *dunData, Point startPosition);
 int AddMonster(Point position, Direction dir, int mtype, bool inMap);
 void AddDoppelganger(MonsterStruct &monster);
 bool M_Talker(MonsterStruct &monster);
+/**
+ * @brief Pick the player or monster the monster goes after, preferring the ones in the same room
+ */
+void UpdateEnemy(MonsterStruct &monster);
 void M_StartStand(MonsterStruct &monster, Direction md);
 void M_ClearSquares(int i);
 void M_GetKnockback(int i);
@@ -262,6 +274,17 @@ void PrepDoEnding();
 void M_WalkDir(int i, Direction md);
 void GolumAi(int i);
 void DeleteMonsterList();
+/**
+ * @brief Note down the golems, so UpdateEnemy only looks at them for monsters that are neither golems nor berserk
+ *
+ * Stays valid as long as no monster turns into a golem and no monster is deleted, ProcessMonsters keeps it during the
+ * turns of the monsters.
+ */
+void CollectGolemTargets();
+/**
+ * @brief Have UpdateEnemy look through all monsters again
+ */
+void ForgetGolemTargets();
 void ProcessMonsters();
 void FreeMonsters();
 bool DirOK(int i, Direction mdir);
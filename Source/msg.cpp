@@ -31,6 +31,7 @@
 #include "town.h"
 #include "trigs.h"
 #include "utils/language.h"
+#include "utils/log.hpp"
 
 namespace devilution {
 
@@ -58,11 +59,14 @@ int sgnCurrMegaPlayer;
 DLevel sgLevels[NUMLEVELS];
 BYTE sbLastCmd;
 byte sgRecvBuf[sizeof(DLevel) + 1];
+static_assert(sizeof(sgRecvBuf) <= UINT16_MAX, "Deltas are sent in pieces with a 16 bit offset");
 BYTE sgbRecvCmd;
 LocalLevel sgLocals[NUMLEVELS];
 DJunk sgJunk;
 bool sgbDeltaChanged;
 BYTE sgbDeltaChunks;
+/** @brief Set when a piece of the level data could not be unpacked, the whole transfer is refused then */
+bool sgbDeltaCorrupt;
 std::list<TMegaPkt> MegaPktList;
 
 void GetNextPacket()
@@ -299,8 +303,11 @@ DWORD CompressData(byte *buffer, byte *end)
 
 void DeltaImportData(BYTE cmd, DWORD recvOffset)
 {
-	if (sgRecvBuf[0] != byte { 0 })
-		PkwareDecompress(&sgRecvBuf[1], recvOffset, sizeof(sgRecvBuf) - 1);
+	if (sgRecvBuf[0] != byte { 0 } && PkwareDecompress(&sgRecvBuf[1], recvOffset, sizeof(sgRecvBuf) - 1) == 0) {
+		LogError("Corrupt level data from player {}", static_cast<int>(gbDeltaSender));
+		sgbDeltaCorrupt = true;
+		return;
+	}
 
 	byte *src = &sgRecvBuf[1];
 	if (cmd == CMD_DLEVEL_JUNK) {
@@ -1835,6 +1842,7 @@ bool msg_wait_resync()
 
 	GetNextPacket();
 	sgbDeltaChunks = 0;
+	sgbDeltaCorrupt = false;
 	sgnCurrMegaPlayer = -1;
 	sgbRecvCmd = CMD_DLEVEL_END;
 	gbBufferMsgs = 1;
@@ -1852,7 +1860,7 @@ bool msg_wait_resync()
 		return false;
 	}
 
-	if (sgbDeltaChunks != MAX_CHUNKS) {
+	if (sgbDeltaChunks != MAX_CHUNKS || sgbDeltaCorrupt) {
 		DrawDlg("%s", _("Unable to get level data"));
 		FreePackets();
 		return false;
@@ -2184,7 +2192,7 @@ void NetSendCmd(bool bHiPri, _cmd_id bCmd)
 		NetSendLoPri(MyPlayerId, (byte *)&cmd, sizeof(cmd));
 }
 
-void NetSendCmdGolem(BYTE mx, BYTE my, Direction dir, BYTE menemy, int hp, BYTE cl)
+void NetSendCmdGolem(BYTE mx, BYTE my, Direction dir, int menemy, int hp, BYTE cl)
 {
 	TCmdGolem cmd;
 
@@ -2310,7 +2318,7 @@ void NetSendCmdQuest(bool bHiPri, BYTE q)
 		NetSendLoPri(MyPlayerId, (byte *)&cmd, sizeof(cmd));
 }
 
-void NetSendCmdGItem(bool bHiPri, _cmd_id bCmd, BYTE mast, BYTE pnum, BYTE ii)
+void NetSendCmdGItem(bool bHiPri, _cmd_id bCmd, BYTE mast, BYTE pnum, int ii)
 {
 	TCmdGItem cmd;
 
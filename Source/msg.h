@@ -19,6 +19,18 @@ namespace devilution {
 #define MAX_SEND_STR_LEN 80
 #define MAXMULTIQUESTS 10
 
+/**
+ * @brief Type of monster and item numbers in messages and level deltas
+ *
+ * With EXTENDED_LIMITS the numbers don't fit in a byte, games with and without it can't be joined anyway as they have a
+ * different GAME_ID.
+ */
+#ifdef EXTENDED_LIMITS
+using NetEntityIndex = uint16_t;
+#else
+using NetEntityIndex = uint8_t;
+#endif
+
 enum _cmd_id : uint8_t {
 	CMD_STAND,
 	CMD_WALKXY,
@@ -189,7 +201,7 @@ struct TCmdGolem {
 	uint8_t _mx;
 	uint8_t _my;
 	Direction _mdir;
-	int8_t _menemy;
+	NetEntityIndex _menemy;
 	int32_t _mhitpoints;
 	uint8_t _currlevel;
 };
@@ -206,7 +218,7 @@ struct TCmdGItem {
 	_cmd_id bCmd;
 	uint8_t bMaster;
 	uint8_t bPnum;
-	uint8_t bCursitem;
+	NetEntityIndex bCursitem;
 	uint8_t bLevel;
 	uint8_t x;
 	uint8_t y;
@@ -308,7 +320,7 @@ struct TSyncHeader {
 	_cmd_id bCmd;
 	uint8_t bLevel;
 	uint16_t wLen;
-	uint8_t bItemI;
+	NetEntityIndex bItemI;
 	uint8_t bItemX;
 	uint8_t bItemY;
 	uint16_t wItemIndx;
@@ -329,10 +341,10 @@ struct TSyncHeader {
 };
 
 struct TSyncMonster {
-	uint8_t _mndx;
+	NetEntityIndex _mndx;
 	uint8_t _mx;
 	uint8_t _my;
-	uint8_t _menemy;
+	NetEntityIndex _menemy;
 	uint8_t _mdelta;
 };
 
@@ -359,7 +371,7 @@ struct DMonsterStr {
 	uint8_t _mx;
 	uint8_t _my;
 	Direction _mdir;
-	uint8_t _menemy;
+	NetEntityIndex _menemy;
 	uint8_t _mactive;
 	int32_t _mhitpoints;
 };
@@ -421,7 +433,7 @@ void DeltaAddItem(int ii);
 void DeltaSaveLevel();
 void DeltaLoadLevel();
 void NetSendCmd(bool bHiPri, _cmd_id bCmd);
-void NetSendCmdGolem(BYTE mx, BYTE my, Direction dir, BYTE menemy, int hp, BYTE cl);
+void NetSendCmdGolem(BYTE mx, BYTE my, Direction dir, int menemy, int hp, BYTE cl);
 void NetSendCmdLoc(int playerId, bool bHiPri, _cmd_id bCmd, Point position);
 void NetSendCmdLocParam1(bool bHiPri, _cmd_id bCmd, Point position, uint16_t wParam1);
 void NetSendCmdLocParam2(bool bHiPri, _cmd_id bCmd, Point position, uint16_t wParam1, uint16_t wParam2);
@@ -430,7 +442,7 @@ void NetSendCmdParam1(bool bHiPri, _cmd_id bCmd, uint16_t wParam1);
 void NetSendCmdParam2(bool bHiPri, _cmd_id bCmd, uint16_t wParam1, uint16_t wParam2);
 void NetSendCmdParam3(bool bHiPri, _cmd_id bCmd, uint16_t wParam1, uint16_t wParam2, uint16_t wParam3);
 void NetSendCmdQuest(bool bHiPri, BYTE q);
-void NetSendCmdGItem(bool bHiPri, _cmd_id bCmd, BYTE mast, BYTE pnum, BYTE ii);
+void NetSendCmdGItem(bool bHiPri, _cmd_id bCmd, BYTE mast, BYTE pnum, int ii);
 void NetSendCmdPItem(bool bHiPri, _cmd_id bCmd, Point position);
 void NetSendCmdChItem(bool bHiPri, BYTE bLoc);
 void NetSendCmdDelItem(bool bHiPri, BYTE bLoc);
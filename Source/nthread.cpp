@@ -96,6 +96,11 @@ uint32_t nthread_send_and_recv_turn(uint32_t curTurn, int turnDelta)
 		if (curTurn >= 0x7FFFFFFF)
 			curTurn &= 0xFFFF;
 	}
+	// The turns go out together with the messages of the last tick
+	if (!SNetFlush()) {
+		nthread_terminate_game("SNetFlush");
+		return 0;
+	}
 	return curTurn;
 }
 
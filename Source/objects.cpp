@@ -21,6 +21,7 @@
 #include "missiles.h"
 #include "monster.h"
 #include "options.h"
+#include "path_cache.h"
 #include "setmaps.h"
 #include "stores.h"
 #include "themes.h"
@@ -589,7 +590,7 @@ void AddObjTraps()
 			if (dObject[i][j] <= 0 || GenerateRnd(100) >= rndv)
 				continue;
 
-			int8_t oi = dObject[i][j] - 1;
+			int oi = dObject[i][j] - 1;
 			if (!AllObjects[Objects[oi]._otype].oTrapFlag)
 				continue;
 
@@ -602,7 +603,7 @@ void AddObjTraps()
 					continue;
 
 				AddObject(OBJ_TRAPL, { xp, j });
-				int8_t oiTrap = dObject[xp][j] - 1;
+				int oiTrap = dObject[xp][j] - 1;
 				Objects[oiTrap]._oVar1 = i;
 				Objects[oiTrap]._oVar2 = j;
 				Objects[oi]._oTrapFlag = true;
@@ -615,7 +616,7 @@ void AddObjTraps()
 					continue;
 
 				AddObject(OBJ_TRAPR, { i, yp });
-				int8_t oiTrap = dObject[i][yp] - 1;
+				int oiTrap = dObject[i][yp] - 1;
 				Objects[oiTrap]._oVar1 = i;
 				Objects[oiTrap]._oVar2 = j;
 				Objects[oi]._oTrapFlag = true;
@@ -629,7 +630,7 @@ void AddChestTraps()
 	for (int j = 0; j < MAXDUNY; j++) {
 		for (int i = 0; i < MAXDUNX; i++) { // NOLINT(modernize-loop-convert)
 			if (dObject[i][j] > 0) {
-				int8_t oi = dObject[i][j] - 1;
+				int oi = dObject[i][j] - 1;
 				if (Objects[oi]._otype >= OBJ_CHEST1 && Objects[oi]._otype <= OBJ_CHEST3 && !Objects[oi]._oTrapFlag && GenerateRnd(100) < 10) {
 					switch (Objects[oi]._otype) {
 					case OBJ_CHEST1:
@@ -1117,6 +1118,8 @@ void AddChest(int i, int t)
 void ObjSetMicro(Point position, int pn)
 {
 	dPiece[position.x][position.y] = pn;
+	InvalidatePathCache();
+	InvalidateVision();
 	pn--;
 
 	int blocks = leveltype != DTYPE_HELL ? 10 : 16;
@@ -5570,6 +5573,8 @@ void OperateNakrulLever()
 		dPiece[UberRow][UberCol - 2] = 300;
 		dPiece[UberRow][UberCol + 1] = 299;
 		SetDungeonMicros();
+		InvalidatePathCache();
+		InvalidateVision();
 	}
 }
 
@@ -5581,6 +5586,8 @@ void SyncNakrulRoom()
 	dPiece[UberRow][UberCol + 1] = 299;
 
 	SetDungeonMicros();
+	InvalidatePathCache();
+	InvalidateVision();
 }
 
 void AddNakrulLeaver()
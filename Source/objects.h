@@ -16,7 +16,11 @@
 
 namespace devilution {
 
+#ifdef EXTENDED_LIMITS
+#define MAXOBJECTS 1000
+#else
 #define MAXOBJECTS 127
+#endif
 
 struct ObjectStruct {
 	_object_id _otype;
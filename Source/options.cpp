@@ -276,6 +276,7 @@ void LoadOptions()
 	GetIniValue("Network", "Bind Address", sgOptions.Network.szBindAddress, sizeof(sgOptions.Network.szBindAddress), "0.0.0.0");
 	sgOptions.Network.nPort = GetIniInt("Network", "Port", 6112);
 	GetIniValue("Network", "Previous Host", sgOptions.Network.szPreviousHost, sizeof(sgOptions.Network.szPreviousHost), "");
+	GetIniValue("Network", "Relay Server", sgOptions.Network.szRelayServer, sizeof(sgOptions.Network.szRelayServer), "");
 
 	for (size_t i = 0; i < QUICK_MESSAGE_OPTIONS; i++)
 		GetIniValue("NetMsg", QuickMessages[i].key, sgOptions.Chat.szHotKeyMsgs[i], MAX_SEND_STR_LEN, "");
@@ -424,6 +425,7 @@ void SaveOptions()
 	SetIniValue("Network", "Bind Address", sgOptions.Network.szBindAddress);
 	SetIniValue("Network", "Port", sgOptions.Network.nPort);
 	SetIniValue("Network", "Previous Host", sgOptions.Network.szPreviousHost);
+	SetIniValue("Network", "Relay Server", sgOptions.Network.szRelayServer);
 
 	for (size_t i = 0; i < QUICK_MESSAGE_OPTIONS; i++)
 		SetIniValue("NetMsg", QuickMessages[i].key, sgOptions.Chat.szHotKeyMsgs[i]);
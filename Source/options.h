@@ -142,6 +142,8 @@ struct NetworkOptions {
 	char szPreviousHost[129];
 	/** @brief What network port to use. */
 	uint16_t nPort;
+	/** @brief Host new TCP games on this dedicated server instead of inside the game. */
+	char szRelayServer[129];
 };
 
 struct ChatOptions {
@@ -12,92 +12,99 @@ namespace devilution {
 
 namespace {
 
-/** A linked list of the A* frontier, sorted by distance */
-PATHNODE *path_2_nodes;
+constexpr size_t MAXPATHNODES = 300;
 /**
- * @brief return a node for a position on the frontier, or NULL if not found
+ * The search gives up after creating this many nodes. The frontier and visited lists used to take their heads from
+ * path_nodes, the limit still leaves those out as it decides which paths are too long to find.
  */
-PATHNODE *GetNode1(Point targetPosition)
-{
-	PATHNODE *result = path_2_nodes->NextNode;
-	while (result != nullptr) {
-		if (result->position == targetPosition)
-			return result;
-		result = result->NextNode;
-	}
-	return nullptr;
-}
+constexpr size_t MaxSearchNodes = MAXPATHNODES - 2;
+
+/** Notes visisted by the path finding algorithm. */
+PATHNODE path_nodes[MaxSearchNodes];
+/** the number of in-use nodes in path_nodes */
+uint32_t gdwCurNodes;
 
 /**
- * @brief insert pPath into the frontier (keeping the frontier sorted by total distance)
+ * @brief Head of a linked list of the A* frontier, sorted by distance
+ *
+ * Nodes that get a shorter distance while on the frontier keep their place, so the list is only sorted by the
+ * distances the nodes had when they were added. The order decides between equally good paths, so it has to stay.
  */
-void NextNode(PATHNODE *pPath)
-{
-	if (path_2_nodes->NextNode == nullptr) {
-		path_2_nodes->NextNode = pPath;
-		return;
-	}
+PATHNODE path_2_nodes;
 
-	PATHNODE *current = path_2_nodes;
-	PATHNODE *next = path_2_nodes->NextNode;
-	int f = pPath->f;
-	while (next != nullptr && next->f < f) {
-		current = next;
-		next = next->NextNode;
-	}
-	pPath->NextNode = next;
-	current->NextNode = pPath;
-}
+/** Index of a tile's node in path_nodes, entries from earlier searches have an older generation */
+struct PathNodeIndex {
+	uint16_t generation;
+	uint16_t node;
+};
+
+PathNodeIndex NodeIndex[MAXDUNX][MAXDUNY];
+uint16_t NodeGeneration;
 
-/** A linked list of all visited nodes */
-PATHNODE *pnode_ptr;
 /**
- * @brief return a node for this position if it was visited, or NULL if not found
+ * @brief Starts a new search, forgetting the nodes of the previous one
  */
-PATHNODE *GetNode2(Point targetPosition)
+void ResetNodes()
 {
-	PATHNODE *result = pnode_ptr->NextNode;
-	while (result != nullptr) {
-		if (result->position == targetPosition)
-			return result;
-		result = result->NextNode;
+	gdwCurNodes = 0;
+	path_2_nodes.NextNode = nullptr;
+	NodeGeneration++;
+	if (NodeGeneration == 0) {
+		memset(NodeIndex, 0, sizeof(NodeIndex));
+		NodeGeneration = 1;
 	}
-	return nullptr;
 }
 
 /**
- * @brief get the next node on the A* frontier to explore (estimated to be closest to the goal), mark it as visited, and return it
+ * @brief return the node for a position on the frontier or visited, or NULL if the search didn't reach it yet
  */
-PATHNODE *GetNextPath()
+PATHNODE *GetNode(Point targetPosition)
 {
-	PATHNODE *result = path_2_nodes->NextNode;
-	if (result == nullptr) {
-		return result;
+	if (targetPosition.x < 0 || targetPosition.x >= MAXDUNX || targetPosition.y < 0 || targetPosition.y >= MAXDUNY) {
+		// Only reachable when posOk accepts tiles outside the map or the destination is outside
+		for (uint32_t i = 0; i < gdwCurNodes; i++) {
+			if (path_nodes[i].position == targetPosition)
+				return &path_nodes[i];
+		}
+		return nullptr;
 	}
 
-	path_2_nodes->NextNode = result->NextNode;
-	result->NextNode = pnode_ptr->NextNode;
-	pnode_ptr->NextNode = result;
-	return result;
+	const PathNodeIndex &index = NodeIndex[targetPosition.x][targetPosition.y];
+	if (index.generation != NodeGeneration)
+		return nullptr;
+	return &path_nodes[index.node];
 }
 
-constexpr size_t MAXPATHNODES = 300;
+/**
+ * @brief insert pPath into the frontier (keeping the frontier sorted by total distance)
+ */
+void NextNode(PATHNODE *pPath)
+{
+	PATHNODE *current = &path_2_nodes;
+	PATHNODE *next = path_2_nodes.NextNode;
+	int f = pPath->f;
+	while (next != nullptr && next->f < f) {
+		current = next;
+		next = next->NextNode;
+	}
+	pPath->NextNode = next;
+	current->NextNode = pPath;
+}
 
-/** Notes visisted by the path finding algorithm. */
-PATHNODE path_nodes[MAXPATHNODES];
-/** the number of in-use nodes in path_nodes */
-uint32_t gdwCurNodes;
 /**
- * @brief zero one of the preallocated nodes and return a pointer to it, or NULL if none are available
+ * @brief zero one of the preallocated nodes for the position and return a pointer to it, or NULL if none are available
  */
-PATHNODE *NewStep()
+PATHNODE *NewStep(Point position)
 {
-	if (gdwCurNodes >= MAXPATHNODES)
+	if (gdwCurNodes >= MaxSearchNodes)
 		return nullptr;
 
 	PATHNODE *newNode = &path_nodes[gdwCurNodes];
-	gdwCurNodes++;
 	memset(newNode, 0, sizeof(PATHNODE));
+	newNode->position = position;
+	if (position.x >= 0 && position.x < MAXDUNX && position.y >= 0 && position.y < MAXDUNY)
+		NodeIndex[position.x][position.y] = { NodeGeneration, static_cast<uint16_t>(gdwCurNodes) };
+	gdwCurNodes++;
 	return newNode;
 }
 
@@ -190,97 +197,6 @@ int GetHeuristicCost(Point startPosition, Point destinationPosition)
 	return 2 * startPosition.ManhattanDistance(destinationPosition);
 }
 
-/**
- * @brief add a step from pPath to destination, return 1 if successful, and update the frontier/visited nodes accordingly
- *
- * @param pPath pointer to the current path node
- * @param candidatePosition expected to be a neighbour of the current path node position
- * @param destinationPosition where we hope to end up
- * @return true if step successfully added, false if we ran out of nodes to use
- */
-bool ParentPath(PATHNODE *pPath, Point candidatePosition, Point destinationPosition)
-{
-	int nextG = pPath->g + CheckEqual(pPath->position, candidatePosition);
-
-	// 3 cases to consider
-	// case 1: (dx,dy) is already on the frontier
-	PATHNODE *dxdy = GetNode1(candidatePosition);
-	if (dxdy != nullptr) {
-		int i;
-		for (i = 0; i < 8; i++) {
-			if (pPath->Child[i] == nullptr)
-				break;
-		}
-		pPath->Child[i] = dxdy;
-		if (nextG < dxdy->g) {
-			if (path_solid_pieces(pPath->position, candidatePosition)) {
-				// we'll explore it later, just update
-				dxdy->Parent = pPath;
-				dxdy->g = nextG;
-				dxdy->f = nextG + dxdy->h;
-			}
-		}
-	} else {
-		// case 2: (dx,dy) was already visited
-		dxdy = GetNode2(candidatePosition);
-		if (dxdy != nullptr) {
-			int i;
-			for (i = 0; i < 8; i++) {
-				if (pPath->Child[i] == nullptr)
-					break;
-			}
-			pPath->Child[i] = dxdy;
-			if (nextG < dxdy->g && path_solid_pieces(pPath->position, candidatePosition)) {
-				// update the node
-				dxdy->Parent = pPath;
-				dxdy->g = nextG;
-				dxdy->f = nextG + dxdy->h;
-				// already explored, so re-update others starting from that node
-				SetCoords(dxdy);
-			}
-		} else {
-			// case 3: (dx,dy) is totally new
-			dxdy = NewStep();
-			if (dxdy == nullptr)
-				return false;
-			dxdy->Parent = pPath;
-			dxdy->g = nextG;
-			dxdy->h = GetHeuristicCost(candidatePosition, destinationPosition);
-			dxdy->f = nextG + dxdy->h;
-			dxdy->position = candidatePosition;
-			// add it to the frontier
-			NextNode(dxdy);
-
-			int i;
-			for (i = 0; i < 8; i++) {
-				if (pPath->Child[i] == nullptr)
-					break;
-			}
-			pPath->Child[i] = dxdy;
-		}
-	}
-	return true;
-}
-
-/**
- * @brief perform a single step of A* bread-first search by trying to step in every possible direction from pPath with goal (x,y). Check each step with PosOk
- *
- * @return false if we ran out of preallocated nodes to use, else true
- */
-bool GetPath(const std::function<bool(Point)> &posOk, PATHNODE *pPath, Point destination)
-{
-	for (auto dir : PathDirs) {
-		Point tile = pPath->position + dir;
-		bool ok = posOk(tile);
-		if ((ok && path_solid_pieces(pPath->position, tile)) || (!ok && tile == destination)) {
-			if (!ParentPath(pPath, tile, destination))
-				return false;
-		}
-	}
-
-	return true;
-}
-
 } // namespace
 
 bool IsTileNotSolid(Point position)
@@ -310,7 +226,73 @@ bool IsTileWalkable(Point position, bool ignoreDoors)
 	return !IsTileSolid(position);
 }
 
-int FindPath(const std::function<bool(Point)> &posOk, Point startPosition, Point destinationPosition, int8_t path[MAX_PATH_LENGTH])
+namespace detail {
+
+void StartPath(Point startPosition, Point destinationPosition)
+{
+	// clear all nodes, the frontier starts out with just the start position
+	ResetNodes();
+	gdwCurPathStep = 0;
+	PATHNODE *pathStart = NewStep(startPosition);
+	pathStart->g = 0;
+	pathStart->h = GetHeuristicCost(startPosition, destinationPosition);
+	pathStart->f = pathStart->h + pathStart->g;
+	path_2_nodes.NextNode = pathStart;
+}
+
+PATHNODE *GetNextPath()
+{
+	PATHNODE *result = path_2_nodes.NextNode;
+	if (result == nullptr) {
+		return result;
+	}
+
+	path_2_nodes.NextNode = result->NextNode;
+	result->NextNode = nullptr;
+	result->visited = true;
+	return result;
+}
+
+bool ParentPath(PATHNODE *pPath, Point candidatePosition, Point destinationPosition)
+{
+	int nextG = pPath->g + CheckEqual(pPath->position, candidatePosition);
+
+	PATHNODE *dxdy = GetNode(candidatePosition);
+	bool isNew = dxdy == nullptr;
+	if (isNew) {
+		dxdy = NewStep(candidatePosition);
+		if (dxdy == nullptr)
+			return false;
+	}
+
+	int i;
+	for (i = 0; i < 8; i++) {
+		if (pPath->Child[i] == nullptr)
+			break;
+	}
+	pPath->Child[i] = dxdy;
+
+	if (isNew) {
+		// (dx,dy) is totally new
+		dxdy->Parent = pPath;
+		dxdy->g = nextG;
+		dxdy->h = GetHeuristicCost(candidatePosition, destinationPosition);
+		dxdy->f = nextG + dxdy->h;
+		// add it to the frontier
+		NextNode(dxdy);
+	} else if (nextG < dxdy->g && path_solid_pieces(pPath->position, candidatePosition)) {
+		// (dx,dy) is already on the frontier or visited, update it
+		dxdy->Parent = pPath;
+		dxdy->g = nextG;
+		dxdy->f = nextG + dxdy->h;
+		// already explored, so re-update others starting from that node
+		if (dxdy->visited)
+			SetCoords(dxdy);
+	}
+	return true;
+}
+
+int ReconstructPath(const PATHNODE *destination, int8_t path[MAX_PATH_LENGTH])
 {
 	/**
 	 * for reconstructing the path after the A* search is done. The longest
@@ -318,46 +300,30 @@ int FindPath(const std::function<bool(Point)> &posOk, Point startPosition, Point
 	 */
 	static int8_t pnodeVals[MAX_PATH_LENGTH];
 
-	// clear all nodes, create root nodes for the visited/frontier linked lists
-	gdwCurNodes = 0;
-	path_2_nodes = NewStep();
-	pnode_ptr = NewStep();
-	gdwCurPathStep = 0;
-	PATHNODE *pathStart = NewStep();
-	pathStart->g = 0;
-	pathStart->h = GetHeuristicCost(startPosition, destinationPosition);
-	pathStart->f = pathStart->h + pathStart->g;
-	pathStart->position = startPosition;
-	path_2_nodes->NextNode = pathStart;
-	// A* search until we find (dx,dy) or fail
-	PATHNODE *nextNode;
-	while ((nextNode = GetNextPath()) != nullptr) {
-		// reached the end, success!
-		if (nextNode->position == destinationPosition) {
-			PATHNODE *current = nextNode;
-			int pathLength = 0;
-			while (current->Parent != nullptr) {
-				if (pathLength >= MAX_PATH_LENGTH)
-					break;
-				pnodeVals[pathLength++] = GetPathDirection(current->Parent->position, current->position);
-				current = current->Parent;
-			}
-			if (pathLength != MAX_PATH_LENGTH) {
-				int i;
-				for (i = 0; i < pathLength; i++)
-					path[i] = pnodeVals[pathLength - i - 1];
-				return i;
-			}
-			return 0;
-		}
-		// ran out of nodes, abort!
-		if (!GetPath(posOk, nextNode, destinationPosition))
-			return 0;
+	const PATHNODE *current = destination;
+	int pathLength = 0;
+	while (current->Parent != nullptr) {
+		if (pathLength >= MAX_PATH_LENGTH)
+			break;
+		pnodeVals[pathLength++] = GetPathDirection(current->Parent->position, current->position);
+		current = current->Parent;
+	}
+	if (pathLength != MAX_PATH_LENGTH) {
+		int i;
+		for (i = 0; i < pathLength; i++)
+			path[i] = pnodeVals[pathLength - i - 1];
+		return i;
 	}
-	// frontier is empty, no path!
 	return 0;
 }
 
+} // namespace detail
+
+int FindPath(const std::function<bool(Point)> &posOk, Point startPosition, Point destinationPosition, int8_t path[MAX_PATH_LENGTH])
+{
+	return FindPath<const std::function<bool(Point)> &>(posOk, startPosition, destinationPosition, path);
+}
+
 bool path_solid_pieces(Point startPosition, Point destinationPosition)
 {
 	// These checks are written as if working backwards from the destination to the source, given
@@ -24,6 +24,8 @@ struct PATHNODE {
 	struct PATHNODE *Parent;
 	struct PATHNODE *Child[8];
 	struct PATHNODE *NextNode;
+	/** Taken off the frontier and explored */
+	bool visited;
 };
 
 bool IsTileNotSolid(Point position);
@@ -37,6 +39,8 @@ bool IsTileWalkable(Point position, bool ignoreDoors = false);
 /**
  * @brief Find the shortest path from startPosition to destinationPosition, using PosOk(Point) to check that each step is a valid position.
  * Store the step directions (corresponds to an index in PathDirs) in path, which must have room for 24 steps
+ *
+ * Calls the predicate through std::function, the template version below inlines it.
  */
 int FindPath(const std::function<bool(Point)> &posOk, Point startPosition, Point destinationPosition, int8_t path[MAX_PATH_LENGTH]);
 
@@ -66,4 +70,78 @@ const Displacement PathDirs[8] = {
 	// clang-format on
 };
 
+namespace detail {
+
+/**
+ * @brief clear all nodes and put the start position on the frontier
+ */
+void StartPath(Point startPosition, Point destinationPosition);
+
+/**
+ * @brief get the next node on the A* frontier to explore (estimated to be closest to the goal), mark it as visited, and return it
+ */
+PATHNODE *GetNextPath();
+
+/**
+ * @brief add a step from pPath to destination, return 1 if successful, and update the frontier/visited nodes accordingly
+ *
+ * @param pPath pointer to the current path node
+ * @param candidatePosition expected to be a neighbour of the current path node position
+ * @param destinationPosition where we hope to end up
+ * @return true if step successfully added, false if we ran out of nodes to use
+ */
+bool ParentPath(PATHNODE *pPath, Point candidatePosition, Point destinationPosition);
+
+/**
+ * @brief store the steps leading to the destination node in path
+ * @return the number of steps, 0 if the path is too long
+ */
+int ReconstructPath(const PATHNODE *destination, int8_t path[MAX_PATH_LENGTH]);
+
+/**
+ * @brief perform a single step of A* bread-first search by trying to step in every possible direction from pPath with goal (x,y). Check each step with PosOk
+ *
+ * @return false if we ran out of preallocated nodes to use, else true
+ */
+template <typename PosOk>
+bool GetPath(PosOk &posOk, PATHNODE *pPath, Point destination)
+{
+	for (auto dir : PathDirs) {
+		Point tile = pPath->position + dir;
+		bool ok = posOk(tile);
+		if ((ok && path_solid_pieces(pPath->position, tile)) || (!ok && tile == destination)) {
+			if (!ParentPath(pPath, tile, destination))
+				return false;
+		}
+	}
+
+	return true;
+}
+
+} // namespace detail
+
+/**
+ * @brief Find the shortest path from startPosition to destinationPosition, using posOk(Point) to check that each step is a valid position.
+ *
+ * Same as the std::function version, but the predicate is inlined into the search, which matters as it's called for
+ * every neighbour of every explored tile.
+ */
+template <typename PosOk>
+int FindPath(PosOk &&posOk, Point startPosition, Point destinationPosition, int8_t path[MAX_PATH_LENGTH])
+{
+	detail::StartPath(startPosition, destinationPosition);
+	// A* search until we find (dx,dy) or fail
+	PATHNODE *nextNode;
+	while ((nextNode = detail::GetNextPath()) != nullptr) {
+		// reached the end, success!
+		if (nextNode->position == destinationPosition)
+			return detail::ReconstructPath(nextNode, path);
+		// ran out of nodes, abort!
+		if (!detail::GetPath(posOk, nextNode, destinationPosition))
+			return 0;
+	}
+	// frontier is empty, no path!
+	return 0;
+}
+
 } // namespace devilution
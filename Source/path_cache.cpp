@@ -0,0 +1,228 @@
+/**
+ * @file path_cache.cpp
+ *
+ * Implementation of the caches shared by the path searches of the monster AI.
+ */
+#include "path_cache.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#include "gendung.h"
+#include "objects.h"
+
+namespace devilution {
+
+namespace {
+
+/** The longest path FindPath returns */
+constexpr int MaxPathSteps = MAX_PATH_LENGTH - 1;
+/** Reach fields cover the tiles that are at most MaxPathSteps away from the destination */
+constexpr int ReachFieldSize = 2 * MaxPathSteps + 1;
+static_assert(ReachFieldSize <= 64, "A row of a reach field has to fit in a uint64_t");
+/** One for each player */
+constexpr int ReachFieldCount = 4;
+
+/** Bumped on every map change, cached results from an older version are ignored */
+uint32_t PathCacheVersion = 1;
+
+/**
+ * @brief The tiles from which the destination can be reached in at most MaxPathSteps steps
+ *
+ * Rows are indexed by the y offset from the destination, bits by the x offset, both shifted by MaxPathSteps.
+ */
+struct ReachField {
+	Point destination;
+	/** Map version the field was built for, 0 if unused */
+	uint32_t version;
+	uint32_t lastUsed;
+	uint64_t inReach[ReachFieldSize];
+};
+
+ReachField ReachFields[ReachFieldCount];
+uint32_t ReachFieldClock;
+
+/** The search that last recorded a probe for a tile, to only record each tile once per search */
+uint32_t ProbeStamp[MAXDUNX][MAXDUNY];
+uint32_t ProbeSearch;
+
+/**
+ * @brief Check if anybody could walk on the tile, given it's not occupied
+ *
+ * Covers every tile that IsTileWalkable accepts, with or without ignoring doors.
+ */
+bool IsTilePassable(Point position)
+{
+	if (position.x < 0 || position.y < 0 || position.x >= MAXDUNX || position.y >= MAXDUNY)
+		return false;
+
+	int objectId = dObject[position.x][position.y];
+	if (objectId != 0 && Objects[abs(objectId) - 1].IsDoor())
+		return true;
+
+	return !IsTileSolid(position);
+}
+
+/**
+ * @brief Breadth first search backwards from the destination, one row of tiles at a time
+ *
+ * Steps need to be between passable tiles without cutting a corner, same as in path_solid_pieces, only the last step
+ * onto the destination is always allowed.
+ */
+void BuildReachField(ReachField &field, Point destination)
+{
+	uint64_t notSolid[ReachFieldSize] = {};
+	uint64_t passable[ReachFieldSize] = {};
+	const int minX = std::max(MaxPathSteps - destination.x, 0);
+	const int maxX = std::min(MaxPathSteps + MAXDUNX - 1 - destination.x, ReachFieldSize - 1);
+	const int minY = std::max(MaxPathSteps - destination.y, 0);
+	const int maxY = std::min(MaxPathSteps + MAXDUNY - 1 - destination.y, ReachFieldSize - 1);
+	for (int x = minX; x <= maxX; x++) {
+		const uint64_t bit = uint64_t { 1 } << x;
+		for (int y = minY; y <= maxY; y++) {
+			Point position = destination + Displacement { x - MaxPathSteps, y - MaxPathSteps };
+			if (!nSolidTable[dPiece[position.x][position.y]]) {
+				notSolid[y] |= bit;
+				passable[y] |= bit;
+			} else if (IsTilePassable(position)) {
+				passable[y] |= bit;
+			}
+		}
+	}
+	passable[MaxPathSteps] &= ~(uint64_t { 1 } << MaxPathSteps);
+
+	field.destination = destination;
+	field.version = PathCacheVersion;
+	memset(field.inReach, 0, sizeof(field.inReach));
+	// Each step of the search reaches the tiles one step further away
+	uint64_t frontier[ReachFieldSize] = {};
+	for (int y = MaxPathSteps - 1; y <= MaxPathSteps + 1; y++)
+		frontier[y] = passable[y] & (uint64_t { 7 } << (MaxPathSteps - 1));
+
+	for (int step = 1;; step++) {
+		// The frontier is at most step rows away from the destination
+		const int firstRow = std::max(MaxPathSteps - step, 0);
+		const int lastRow = std::min(MaxPathSteps + step, ReachFieldSize - 1);
+		bool done = true;
+		for (int y = firstRow; y <= lastRow; y++) {
+			field.inReach[y] |= frontier[y];
+			done = done && frontier[y] == 0;
+		}
+		if (done || step == MaxPathSteps)
+			break;
+
+		uint64_t next[ReachFieldSize] = {};
+		for (int y = firstRow; y <= lastRow; y++) {
+			const uint64_t row = frontier[y];
+			if (row == 0)
+				continue;
+			next[y] |= (row << 1) | (row >> 1);
+			for (int dy : { -1, 1 }) {
+				if (y + dy < 0 || y + dy >= ReachFieldSize)
+					continue;
+				// A diagonal step from (x, y) to (x + dx, y + dy) passes (x, y + dy) and (x + dx, y)
+				const uint64_t corner = row & notSolid[y + dy];
+				next[y + dy] |= row | (((corner << 1) | (corner >> 1)) & notSolid[y]);
+			}
+		}
+		for (int y = std::max(firstRow - 1, 0); y <= std::min(lastRow + 1, ReachFieldSize - 1); y++)
+			frontier[y] = next[y] & passable[y] & ~field.inReach[y];
+	}
+}
+
+ReachField &GetReachField(Point destination)
+{
+	ReachFieldClock++;
+	ReachField *oldest = &ReachFields[0];
+	for (ReachField &field : ReachFields) {
+		if (field.version == PathCacheVersion && field.destination == destination) {
+			field.lastUsed = ReachFieldClock;
+			return field;
+		}
+		if (oldest->version == PathCacheVersion && (field.version != PathCacheVersion || field.lastUsed < oldest->lastUsed))
+			oldest = &field;
+	}
+
+	BuildReachField(*oldest, destination);
+	oldest->lastUsed = ReachFieldClock;
+	return *oldest;
+}
+
+} // namespace
+
+void InvalidatePathCache()
+{
+	PathCacheVersion++;
+	if (PathCacheVersion == 0)
+		PathCacheVersion = 1;
+	for (ReachField &field : ReachFields)
+		field.version = 0;
+}
+
+bool MightFindPath(Point startPosition, Point destinationPosition)
+{
+	const int distance = std::max(abs(startPosition.x - destinationPosition.x), abs(startPosition.y - destinationPosition.y));
+	if (distance <= 1)
+		return true;
+	if (distance > MaxPathSteps)
+		return false;
+	// The reach field only knows about paths starting on a passable tile
+	if (!IsTilePassable(startPosition))
+		return true;
+
+	const ReachField &field = GetReachField(destinationPosition);
+	const Displacement offset = startPosition - destinationPosition;
+	return ((field.inReach[offset.deltaY + MaxPathSteps] >> (offset.deltaX + MaxPathSteps)) & 1) != 0;
+}
+
+bool CachedPath::IsCached(uint8_t predicateClass, Point startPosition, Point destinationPosition) const
+{
+	return version_ == PathCacheVersion
+	    && predicateClass_ == predicateClass
+	    && startPosition_ == startPosition
+	    && destinationPosition_ == destinationPosition;
+}
+
+int CachedPath::CopyPath(int8_t path[MAX_PATH_LENGTH]) const
+{
+	std::copy(steps_, steps_ + length_, path);
+	return length_;
+}
+
+void CachedPath::BeginSearch(uint8_t predicateClass, Point startPosition, Point destinationPosition)
+{
+	predicateClass_ = predicateClass;
+	startPosition_ = startPosition;
+	destinationPosition_ = destinationPosition;
+	version_ = PathCacheVersion;
+	probes_.clear();
+
+	ProbeSearch++;
+	if (ProbeSearch == 0) {
+		memset(ProbeStamp, 0, sizeof(ProbeStamp));
+		ProbeSearch = 1;
+	}
+}
+
+void CachedPath::Record(Point position, bool ok)
+{
+	if (position.x < 0 || position.y < 0 || position.x >= MAXDUNX || position.y >= MAXDUNY) {
+		// Can't be stored as a probe, so the result can't be reused
+		version_ = 0;
+		return;
+	}
+	uint32_t &stamp = ProbeStamp[position.x][position.y];
+	if (stamp == ProbeSearch)
+		return;
+	stamp = ProbeSearch;
+	probes_.push_back({ static_cast<uint8_t>(position.x), static_cast<uint8_t>(position.y), ok });
+}
+
+void CachedPath::EndSearch(const int8_t path[MAX_PATH_LENGTH], int length)
+{
+	length_ = length;
+	std::copy(path, path + length, steps_);
+}
+
+} // namespace devilution
@@ -0,0 +1,94 @@
+/**
+ * @file path_cache.h
+ *
+ * Interface of the caches shared by the path searches of the monster AI.
+ */
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "engine/point.hpp"
+#include "path.h"
+
+namespace devilution {
+
+/**
+ * @brief Forget all reach fields and cached paths, needs to be called whenever dPiece changes
+ */
+void InvalidatePathCache();
+
+/**
+ * @brief Check if a path search could possibly succeed, using a reach field shared by all searches for the same destination
+ *
+ * The reach field is the result of a breadth first search backwards from the destination over every tile that
+ * somebody could walk on, ignoring monsters, players and missiles. It's built on the first check for a destination and
+ * reused until the destination or the map changes, so monsters chasing the same player share one search per tick.
+ *
+ * @return false if FindPath is certain to fail because there is no path of at most 24 steps, even when nothing is in the way
+ */
+bool MightFindPath(Point startPosition, Point destinationPosition);
+
+/**
+ * @brief The last path search of one searcher, reused for the same search as long as the predicate still gives the
+ * same answer for every tile that the search looked at
+ */
+class CachedPath {
+public:
+	/**
+	 * @brief Same result as FindPath(posOk, startPosition, destinationPosition, path)
+	 * @param predicateClass Has to differ between predicates that can give different answers for the same tile
+	 */
+	template <typename PosOk>
+	int FindPath(PosOk &&posOk, uint8_t predicateClass, Point startPosition, Point destinationPosition, int8_t path[MAX_PATH_LENGTH])
+	{
+		if (IsCached(predicateClass, startPosition, destinationPosition) && ProbesMatch(posOk))
+			return CopyPath(path);
+
+		BeginSearch(predicateClass, startPosition, destinationPosition);
+		const int length = devilution::FindPath(
+		    [this, &posOk](Point position) {
+			    const bool ok = posOk(position);
+			    Record(position, ok);
+			    return ok;
+		    },
+		    startPosition, destinationPosition, path);
+		EndSearch(path, length);
+		return length;
+	}
+
+private:
+	/** A tile the search checked and the answer it got */
+	struct Probe {
+		uint8_t x;
+		uint8_t y;
+		bool ok;
+	};
+
+	bool IsCached(uint8_t predicateClass, Point startPosition, Point destinationPosition) const;
+	int CopyPath(int8_t path[MAX_PATH_LENGTH]) const;
+	void BeginSearch(uint8_t predicateClass, Point startPosition, Point destinationPosition);
+	void Record(Point position, bool ok);
+	void EndSearch(const int8_t path[MAX_PATH_LENGTH], int length);
+
+	template <typename PosOk>
+	bool ProbesMatch(PosOk &posOk) const
+	{
+		for (const Probe &probe : probes_) {
+			if (posOk(Point { probe.x, probe.y }) != probe.ok)
+				return false;
+		}
+		return true;
+	}
+
+	Point startPosition_;
+	Point destinationPosition_;
+	uint8_t predicateClass_ = 0;
+	/** Map version the result belongs to, 0 if there is no usable result */
+	uint32_t version_ = 0;
+	int length_ = 0;
+	int8_t steps_[MAX_PATH_LENGTH];
+	std::vector<Probe> probes_;
+};
+
+} // namespace devilution
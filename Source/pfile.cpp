@@ -453,6 +453,40 @@ void pfile_remove_temp_files()
 	mpqapi_flush_and_close(true);
 }
 
+std::vector<SaveFileData> pfile_read_temp_levels()
+{
+	std::vector<SaveFileData> levels;
+
+	HANDLE archive = OpenSaveArchive(gSaveNumber);
+	if (archive == nullptr)
+		return levels;
+
+	char szTemp[MAX_PATH];
+	for (uint8_t dwIndex = 0; GetTempSaveNames(dwIndex, szTemp); dwIndex++) {
+		size_t length;
+		auto buf = ReadArchive(archive, szTemp, &length);
+		if (buf == nullptr)
+			continue;
+		levels.push_back({ szTemp, { buf.get(), buf.get() + length } });
+	}
+	CloseArchive(&archive);
+
+	return levels;
+}
+
+void pfile_write_temp_levels(const std::vector<SaveFileData> &levels)
+{
+	PFileScopedArchiveWriter scopedWriter;
+	mpqapi_remove_hash_entries(GetTempSaveNames);
+	for (const SaveFileData &level : levels) {
+		size_t encodedLen = codec_get_encoded_len(level.data.size());
+		std::unique_ptr<byte[]> encoded { new byte[encodedLen] };
+		memcpy(encoded.get(), level.data.data(), level.data.size());
+		codec_encode(encoded.get(), level.data.size(), encodedLen, pfile_get_password());
+		mpqapi_write_file(level.name.c_str(), encoded.get(), encodedLen);
+	}
+}
+
 std::unique_ptr<byte[]> pfile_read(const char *pszName, size_t *pdwLen)
 {
 	HANDLE archive;
@@ -5,6 +5,9 @@
  */
 #pragma once
 
+#include <string>
+#include <vector>
+
 #include "player.h"
 #include "DiabloUI/diabloui.h"
 
@@ -14,6 +17,11 @@ namespace devilution {
 
 extern bool gbValidSaveFile;
 
+struct SaveFileData {
+	std::string name;
+	std::vector<byte> data;
+};
+
 class PFileScopedArchiveWriter {
 public:
 	// Opens the player save file for writing
@@ -39,6 +47,14 @@ bool LevelFileExists();
 void GetTempLevelNames(char *szTemp);
 void GetPermLevelNames(char *szPerm);
 void pfile_remove_temp_files();
+/**
+ * @brief Reads all temporary level files of the current game, the data is returned unencoded
+ */
+std::vector<SaveFileData> pfile_read_temp_levels();
+/**
+ * @brief Replaces the temporary level files of the current game
+ */
+void pfile_write_temp_levels(const std::vector<SaveFileData> &levels);
 std::unique_ptr<byte[]> pfile_read(const char *pszName, size_t *pdwLen);
 void pfile_update(bool forceSave);
 
@@ -23,6 +23,7 @@
 #include "minitext.h"
 #include "missiles.h"
 #include "nthread.h"
+#include "palette.h"
 #include "plrmsg.h"
 #include "qol/itemlabels.h"
 #include "qol/monhealthbar.h"
@@ -31,6 +32,8 @@
 #include "towners.h"
 #include "utils/endian.hpp"
 #include "utils/log.hpp"
+#include "utils/net_stats.h"
+#include "utils/profiler.h"
 
 #ifdef _DEBUG
 #include "debug.h"
@@ -559,7 +562,7 @@ void DrawDeadPlayer(const Surface &out, int x, int y, int sx, int sy)
  */
 void DrawObject(const Surface &out, int x, int y, int ox, int oy, bool pre)
 {
-	int8_t bv = dObject[x][y];
+	int bv = dObject[x][y];
 	if (bv == 0 || LightTableIndex >= LightsMax)
 		return;
 
@@ -674,7 +677,7 @@ void DrawFloor(const Surface &out, int x, int y, int sx, int sy)
  */
 void DrawItem(const Surface &out, int x, int y, int sx, int sy, bool pre)
 {
-	int8_t bItem = dItem[x][y];
+	int bItem = dItem[x][y];
 
 	if (bItem <= 0)
 		return;
@@ -1173,10 +1176,17 @@ void DrawGame(const Surface &fullOut, int x, int y)
 		break;
 	}
 
-	DrawFloor(out, x, y, sx, sy, rows, columns);
-	DrawTileContent(out, x, y, sx, sy, rows, columns);
+	{
+		profiler::RenderStageTimer timer(profiler::RenderStage::Floor);
+		DrawFloor(out, x, y, sx, sy, rows, columns);
+	}
+	{
+		profiler::RenderStageTimer timer(profiler::RenderStage::Dungeon);
+		DrawTileContent(out, x, y, sx, sy, rows, columns);
+	}
 
 	if (!zoomflag) {
+		profiler::RenderStageTimer timer(profiler::RenderStage::Zoom);
 		Zoom(fullOut.subregionY(0, gnViewportHeight));
 	}
 }
@@ -1191,10 +1201,20 @@ void DrawView(const Surface &out, int startX, int startY)
 {
 	DrawGame(out, startX, startY);
 	if (AutomapActive) {
+		profiler::RenderStageTimer timer(profiler::RenderStage::Automap);
 		DrawAutomap(out.subregionY(0, gnViewportHeight));
 	}
-	DrawMonsterHealthBar(out);
-	DrawItemNameLabels(out);
+	{
+		// Part of the panels, drawn ahead of the item labels as before so the labels stay on top
+		profiler::RenderStageTimer timer(profiler::RenderStage::Panels);
+		DrawMonsterHealthBar(out);
+	}
+	{
+		profiler::RenderStageTimer timer(profiler::RenderStage::ItemLabels);
+		DrawItemNameLabels(out);
+	}
+
+	profiler::RenderStageTimer panelsTimer(profiler::RenderStage::Panels);
 
 	if (stextflag != STORE_NONE && !qtextflag)
 		DrawSText(out);
@@ -1272,6 +1292,94 @@ void DrawFPS(const Surface &out)
 	DrawString(out, string, Point { 8, 65 }, UiFlags::ColorRed);
 }
 
+/**
+ * @brief Display the time spent in each game tick phase below the FPS counter
+ */
+void DrawTickProfiler(const Surface &out)
+{
+	if (!profiler::IsOverlayEnabled())
+		return;
+
+	const auto &stats = profiler::GetOverlayStats();
+	const profiler::PhaseStats &tickStats = profiler::GetOverlayTickStats();
+
+	constexpr int LineHeight = 12;
+	Point position { 8, 80 };
+	DrawString(out, fmt::format("GameTick  min {:.2f}  avg {:.2f}  p99 {:.2f} ms", tickStats.min / 1000, tickStats.avg / 1000, tickStats.p99 / 1000), position, UiFlags::ColorRed);
+	for (size_t i = 0; i < profiler::TickPhaseCount; i++) {
+		if (stats[i].samples == 0)
+			continue;
+		position.y += LineHeight;
+		const char *name = profiler::PhaseName(static_cast<profiler::TickPhase>(i));
+		DrawString(out, fmt::format("{}  min {:.2f}  avg {:.2f}  p99 {:.2f} ms", name, stats[i].min / 1000, stats[i].avg / 1000, stats[i].p99 / 1000), position, UiFlags::ColorRed);
+	}
+}
+
+/**
+ * @brief Display the render time of recent frames as stacked bars, one color per render stage
+ */
+void DrawRenderProfiler(const Surface &out)
+{
+	const profiler::FrameProfiler *frames = profiler::GetFrameProfiler();
+	if (!profiler::IsRenderOverlayEnabled() || frames == nullptr)
+		return;
+
+	constexpr int Frames = 120;
+	constexpr int BarWidth = 2;
+	constexpr int Height = 100;
+	/** Nanoseconds per pixel, the graph covers 25 ms */
+	constexpr uint32_t Scale = 250000;
+	constexpr std::array<uint8_t, profiler::RenderStageCount> StageColors {
+		PAL16_BLUE + 4,
+		PAL16_BLUE + 10,
+		PAL16_BEIGE + 4,
+		PAL16_YELLOW + 2,
+		PAL16_ORANGE + 2,
+		PAL16_GRAY + 4,
+		PAL16_GRAY + 10,
+		PAL16_RED + 2,
+		PAL16_RED + 8,
+	};
+
+	const Point origin { 8, gnViewportHeight - 20 };
+	for (int i = 0; i < Frames && i < static_cast<int>(frames->Size()); i++) {
+		const int x = origin.x + (Frames - 1 - i) * BarWidth;
+		int y = origin.y;
+		for (size_t stage = 0; stage < profiler::RenderStageCount; stage++) {
+			const int height = std::min<int>(frames->PhaseDuration(i, static_cast<profiler::RenderStage>(stage)) / Scale, y - (origin.y - Height));
+			for (int column = 0; column < BarWidth; column++)
+				DrawVerticalLine(out, { x + column, y - height }, height, StageColors[stage]);
+			y -= height;
+		}
+	}
+	// 60 FPS frame budget
+	DrawHorizontalLine(out, { origin.x, origin.y - static_cast<int>(16666666 / Scale) }, Frames * BarWidth, PAL16_RED);
+
+	const profiler::PhaseStats total = frames->TotalStats(Frames);
+	DrawString(out, fmt::format("Frame  avg {:.2f}  p99 {:.2f} ms", total.avg / 1000, total.p99 / 1000), origin + Displacement { 0, 2 }, UiFlags::ColorRed);
+}
+
+/**
+ * @brief Display the latency and traffic of each connected player in the top right corner
+ */
+void DrawNetStats(const Surface &out)
+{
+	const netstats::Rates *rates = netstats::GetOverlayRates();
+	if (!netstats::IsOverlayEnabled() || rates == nullptr)
+		return;
+
+	constexpr int LineHeight = 12;
+	Rectangle line { { 0, 8 }, { out.w() - 8, LineHeight } };
+	DrawString(out, fmt::format("turns {}  msgs {}  crypto {:.2f} ms/s  rejected {}", rates->turnsInTransit, rates->messagesQueued, rates->cryptoTime, rates->decryptFailures), line, UiFlags::ColorRed | UiFlags::AlignRight);
+	for (int i = 0; i < MAX_PLRS; i++) {
+		const netstats::PeerRates &peer = rates->peers[i];
+		if (!peer.connected)
+			continue;
+		line.position.y += LineHeight;
+		DrawString(out, fmt::format("{}  rtt {} ms  turns {}  in {:.0f}/s {:.1f} KiB/s  out {:.0f}/s {:.1f} KiB/s", Players[i]._pName, peer.roundTripTime, peer.turnsQueued, peer.packetsReceived, peer.bytesReceived / 1024, peer.packetsSent, peer.bytesSent / 1024), line, UiFlags::ColorRed | UiFlags::AlignRight);
+	}
+}
+
 /**
  * @brief Update part of the screen from the back buffer
  * @param dwX Back buffer coordinate
@@ -1652,7 +1760,7 @@ void scrollrt_draw_game_screen()
  */
 void DrawAndBlit()
 {
-	if (!gbRunGame) {
+	if (!gbRunGame || HeadlessMode) {
 		return;
 	}
 
@@ -1676,43 +1784,57 @@ void DrawAndBlit()
 
 	force_redraw = 0;
 
+	profiler::BeginFrame();
+
 	lock_buf(0);
 	const Surface &out = GlobalBackBuffer();
-	UndrawCursor(out);
+	{
+		profiler::RenderStageTimer timer(profiler::RenderStage::Cursor);
+		UndrawCursor(out);
+	}
 
 	nthread_UpdateProgressToNextGameTick();
 
 	DrawView(out, ViewX, ViewY);
-	if (ctrlPan) {
-		DrawCtrlPan(out);
-	}
-	if (drawhpflag) {
-		DrawLifeFlaskLower(out);
-	}
-	if (drawmanaflag) {
-		DrawManaFlaskLower(out);
+	{
+		profiler::RenderStageTimer timer(profiler::RenderStage::Panels);
+		if (ctrlPan) {
+			DrawCtrlPan(out);
+		}
+		if (drawhpflag) {
+			DrawLifeFlaskLower(out);
+		}
+		if (drawmanaflag) {
+			DrawManaFlaskLower(out);
 
-		DrawSpell(out);
-	}
-	if (drawbtnflag) {
-		DrawCtrlBtns(out);
-	}
-	if (drawsbarflag) {
-		DrawInvBelt(out);
-	}
-	if (talkflag) {
-		DrawTalkPan(out);
-		hgt = gnScreenHeight;
+			DrawSpell(out);
+		}
+		if (drawbtnflag) {
+			DrawCtrlBtns(out);
+		}
+		if (drawsbarflag) {
+			DrawInvBelt(out);
+		}
+		if (talkflag) {
+			DrawTalkPan(out);
+			hgt = gnScreenHeight;
+		}
+		DrawXPBar(out);
 	}
-	DrawXPBar(out);
 
-	if (IsHardwareCursor()) {
-		SetHardwareCursorVisible(ShouldShowCursor());
-	} else {
-		DrawCursor(out);
+	{
+		profiler::RenderStageTimer timer(profiler::RenderStage::Cursor);
+		if (IsHardwareCursor()) {
+			SetHardwareCursorVisible(ShouldShowCursor());
+		} else {
+			DrawCursor(out);
+		}
 	}
 
 	DrawFPS(out);
+	DrawTickProfiler(out);
+	DrawRenderProfiler(out);
+	DrawNetStats(out);
 
 	unlock_buf(0);
 
@@ -1720,6 +1842,8 @@ void DrawAndBlit()
 
 	RenderPresent();
 
+	profiler::EndFrame();
+
 	drawhpflag = false;
 	drawmanaflag = false;
 	drawbtnflag = false;
@@ -129,6 +129,43 @@ bool SNetGetGameInfo(game_info type, void *dst, unsigned int length);
  */
 bool SNetGetTurnsInTransit(uint32_t *turns);
 
+/**
+ * @brief Traffic and latency of the connection to one of the other players, see SNetGetNetStats
+ */
+struct NetPeerStats {
+	bool connected;
+	/** Round trip time in milliseconds averaged over the recent measurements, 0 until the first one */
+	uint32_t roundTripTime;
+	uint32_t packetsSent;
+	uint32_t packetsReceived;
+	uint64_t bytesSent;
+	uint64_t bytesReceived;
+	/** Turns that arrived from the player but haven't been processed yet */
+	uint32_t turnsQueued;
+};
+
+/**
+ * @brief Counters of the network layer, they add up from the start of the game
+ */
+struct NetStats {
+	NetPeerStats peers[MAX_PLRS];
+	/** Same as SNetGetTurnsInTransit */
+	uint32_t turnsInTransit;
+	/** Messages that arrived but haven't been processed yet */
+	uint32_t messagesQueued;
+	/** Received packets that were rejected */
+	uint32_t decryptFailures;
+	/** Time spent encrypting and decrypting packets in microseconds */
+	uint64_t cryptoTime;
+};
+
+/**
+ * @brief Retrieves the counters of the network layer
+ *
+ * Returns false if the game isn't played over the network.
+ */
+bool SNetGetNetStats(NetStats *stats);
+
 bool SNetJoinGame(char *gameName, char *gamePassword, int *playerid);
 
 /*  SNetLeaveGame @ 119
@@ -185,6 +222,15 @@ bool SNetSendMessage(int playerID, void *data, unsigned int databytes);
  */
 bool SNetSendTurn(char *data, unsigned int databytes);
 
+/**
+ * @brief Sends the messages and turns queued by SNetSendMessage and SNetSendTurn
+ *
+ * Everything queued for the same players since the last call goes out as a single packet.
+ *
+ * Returns true if the function was called successfully and false otherwise.
+ */
+bool SNetFlush();
+
 bool SFileOpenFile(const char *filename, HANDLE *phFile);
 
 // Functions implemented in StormLib
@@ -64,6 +64,14 @@ bool SNetSendTurn(char *data, unsigned int databytes)
 	return dvlnet_inst->SNetSendTurn(data, databytes);
 }
 
+bool SNetFlush()
+{
+#ifndef NONET
+	std::lock_guard<SdlMutex> lg(storm_net_mutex);
+#endif
+	return dvlnet_inst->SNetFlush();
+}
+
 void SNetGetProviderCaps(struct _SNETCAPS *caps)
 {
 #ifndef NONET
@@ -202,6 +210,14 @@ bool SNetGetTurnsInTransit(uint32_t *turns)
 	return dvlnet_inst->SNetGetTurnsInTransit(turns);
 }
 
+bool SNetGetNetStats(NetStats *stats)
+{
+#ifndef NONET
+	std::lock_guard<SdlMutex> lg(storm_net_mutex);
+#endif
+	return dvlnet_inst->SNetGetNetStats(stats);
+}
+
 /**
  * @brief engine calls this only once with argument 1
  */
@@ -9,6 +9,7 @@
 #include "engine/load_file.hpp"
 #include "engine/random.hpp"
 #include "init.h"
+#include "lighting.h"
 #include "player.h"
 #include "quests.h"
 #include "trigs.h"
@@ -252,6 +253,7 @@ void TownOpenHive()
 	dPiece[85][62] = 0x13;
 	dPiece[84][64] = 0x118;
 	SetDungeonMicros();
+	InvalidateVision();
 }
 
 /**
@@ -270,6 +272,7 @@ void TownOpenGrave()
 	dPiece[35][21] = 0x53b;
 	dPiece[34][21] = 0x53c;
 	SetDungeonMicros();
+	InvalidateVision();
 }
 
 /**
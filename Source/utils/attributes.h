@@ -31,3 +31,11 @@
 #else
 #define DVL_ATTRIBUTE_HOT
 #endif
+
+// Compiles a function for a specific instruction set, e.g. DVL_ATTRIBUTE_TARGET("avx2").
+// MSVC doesn't need it to use the intrinsics.
+#if DVL_HAVE_ATTRIBUTE(target)
+#define DVL_ATTRIBUTE_TARGET(isa) __attribute__((target(isa)))
+#else
+#define DVL_ATTRIBUTE_TARGET(isa)
+#endif
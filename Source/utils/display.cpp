@@ -138,13 +138,24 @@ bool SpawnWindow(const char *lpWindowName)
 	SDL_setenv("SDL_AUDIODRIVER", "winmm", /*overwrite=*/false);
 #endif
 
-	int initFlags = SDL_INIT_VIDEO | SDL_INIT_JOYSTICK;
+	int initFlags = SDL_INIT_VIDEO;
+	if (HeadlessMode) {
+		// The dummy driver still provides a window surface to render loading screens into
+#ifdef USE_SDL1
+		SDL_putenv(const_cast<char *>("SDL_VIDEODRIVER=dummy"));
+#else
+		SDL_setenv("SDL_VIDEODRIVER", "dummy", /*overwrite=*/true);
+#endif
+	} else {
+		initFlags |= SDL_INIT_JOYSTICK;
 #ifndef NOSOUND
-	initFlags |= SDL_INIT_AUDIO;
+		initFlags |= SDL_INIT_AUDIO;
 #endif
 #ifndef USE_SDL1
-	initFlags |= SDL_INIT_GAMECONTROLLER;
-
+		initFlags |= SDL_INIT_GAMECONTROLLER;
+#endif
+	}
+#ifndef USE_SDL1
 	SDL_SetHint(SDL_HINT_ORIENTATIONS, "LandscapeLeft LandscapeRight");
 #endif
 	if (SDL_Init(initFlags) <= -1) {
@@ -217,7 +228,7 @@ bool SpawnWindow(const char *lpWindowName)
 #endif
 	refreshDelay = 1000000 / refreshRate;
 
-	if (sgOptions.Graphics.bUpscale) {
+	if (sgOptions.Graphics.bUpscale && !HeadlessMode) {
 #ifndef USE_SDL1
 		Uint32 rendererFlags = SDL_RENDERER_ACCELERATED;
 
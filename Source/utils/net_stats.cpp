@@ -0,0 +1,167 @@
+/**
+ * @file net_stats.cpp
+ *
+ * Implementation of the network statistics overlay and log.
+ */
+#include "utils/net_stats.h"
+
+#include <chrono>
+#include <memory>
+
+#include "utils/file_util.h"
+#include "utils/log.hpp"
+
+namespace devilution {
+
+namespace netstats {
+
+namespace {
+
+constexpr uint32_t SampleInterval = 1000;
+
+bool ShowOverlay = false;
+std::string LogPath;
+std::unique_ptr<std::fstream> LogStream;
+
+bool HavePrevious = false;
+NetStats Previous;
+uint32_t PreviousTime;
+uint32_t FirstSampleTime;
+bool HaveRates = false;
+Rates OverlayRates;
+
+uint32_t NowMs()
+{
+	using namespace std::chrono;
+	return static_cast<uint32_t>(duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count());
+}
+
+template <typename T>
+T Delta(T previous, T current)
+{
+	return current >= previous ? current - previous : current;
+}
+
+void WriteLog(uint32_t now, const NetStats &current)
+{
+	if (LogStream == nullptr) {
+		LogStream = CreateFileStream(LogPath.c_str(), std::fstream::out | std::fstream::trunc);
+		if (LogStream == nullptr || LogStream->fail()) {
+			LogError("Unable to write network statistics to {}", LogPath);
+			LogPath.clear();
+			LogStream = nullptr;
+			return;
+		}
+	}
+	WriteJson(*LogStream, now - FirstSampleTime, OverlayRates, current);
+	// Keep the log complete when the game crashes or loses the connection
+	LogStream->flush();
+}
+
+} // namespace
+
+Rates ComputeRates(const NetStats &previous, const NetStats &current, float seconds)
+{
+	Rates rates {};
+	for (int i = 0; i < MAX_PLRS; i++) {
+		const NetPeerStats &before = previous.peers[i];
+		const NetPeerStats &after = current.peers[i];
+		PeerRates &peer = rates.peers[i];
+		peer.connected = after.connected;
+		peer.roundTripTime = after.roundTripTime;
+		peer.packetsSent = Delta(before.packetsSent, after.packetsSent) / seconds;
+		peer.packetsReceived = Delta(before.packetsReceived, after.packetsReceived) / seconds;
+		peer.bytesSent = Delta(before.bytesSent, after.bytesSent) / seconds;
+		peer.bytesReceived = Delta(before.bytesReceived, after.bytesReceived) / seconds;
+		peer.turnsQueued = after.turnsQueued;
+	}
+	rates.turnsInTransit = current.turnsInTransit;
+	rates.messagesQueued = current.messagesQueued;
+	rates.decryptFailures = Delta(previous.decryptFailures, current.decryptFailures);
+	rates.cryptoTime = Delta(previous.cryptoTime, current.cryptoTime) / 1000.F / seconds;
+	return rates;
+}
+
+void WriteJson(std::ostream &out, uint32_t time, const Rates &rates, const NetStats &totals)
+{
+	out << "{\"time_ms\":" << time
+	    << ",\"turns_in_transit\":" << rates.turnsInTransit
+	    << ",\"messages_queued\":" << rates.messagesQueued
+	    << ",\"decrypt_failures\":" << rates.decryptFailures
+	    << ",\"decrypt_failures_total\":" << totals.decryptFailures
+	    << ",\"crypto_ms_per_s\":" << rates.cryptoTime
+	    << ",\"peers\":[";
+	bool first = true;
+	for (int i = 0; i < MAX_PLRS; i++) {
+		const PeerRates &peer = rates.peers[i];
+		if (!peer.connected)
+			continue;
+		if (!first)
+			out << ",";
+		first = false;
+		out << "{\"player\":" << i
+		    << ",\"rtt_ms\":" << peer.roundTripTime
+		    << ",\"turns_queued\":" << peer.turnsQueued
+		    << ",\"packets_sent_per_s\":" << peer.packetsSent
+		    << ",\"packets_received_per_s\":" << peer.packetsReceived
+		    << ",\"bytes_sent_per_s\":" << peer.bytesSent
+		    << ",\"bytes_received_per_s\":" << peer.bytesReceived
+		    << ",\"bytes_sent\":" << totals.peers[i].bytesSent
+		    << ",\"bytes_received\":" << totals.peers[i].bytesReceived
+		    << "}";
+	}
+	out << "]}\n";
+}
+
+void EnableOverlay()
+{
+	ShowOverlay = true;
+}
+
+bool IsOverlayEnabled()
+{
+	return ShowOverlay;
+}
+
+void SetLogPath(const std::string &path)
+{
+	LogPath = path;
+}
+
+void Update()
+{
+	if (!ShowOverlay && LogPath.empty())
+		return;
+
+	const uint32_t now = NowMs();
+	if (HavePrevious && now - PreviousTime < SampleInterval)
+		return;
+
+	NetStats current {};
+	if (!SNetGetNetStats(&current)) {
+		HavePrevious = false;
+		HaveRates = false;
+		return;
+	}
+
+	if (HavePrevious) {
+		OverlayRates = ComputeRates(Previous, current, (now - PreviousTime) / 1000.F);
+		HaveRates = true;
+		if (!LogPath.empty())
+			WriteLog(now, current);
+	} else {
+		FirstSampleTime = now;
+	}
+	Previous = current;
+	PreviousTime = now;
+	HavePrevious = true;
+}
+
+const Rates *GetOverlayRates()
+{
+	return HaveRates ? &OverlayRates : nullptr;
+}
+
+} // namespace netstats
+
+} // namespace devilution
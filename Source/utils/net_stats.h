@@ -0,0 +1,68 @@
+/**
+ * @file net_stats.h
+ *
+ * On-screen overlay and log of the network counters, for diagnosing lag in multiplayer games.
+ */
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+#include "storm/storm.h"
+
+namespace devilution {
+
+namespace netstats {
+
+/** @brief Traffic of the connection to one player per second */
+struct PeerRates {
+	bool connected;
+	/** Milliseconds, see NetPeerStats::roundTripTime */
+	uint32_t roundTripTime;
+	float packetsSent;
+	float packetsReceived;
+	float bytesSent;
+	float bytesReceived;
+	uint32_t turnsQueued;
+};
+
+/** @brief The network counters between two samples */
+struct Rates {
+	std::array<PeerRates, MAX_PLRS> peers;
+	uint32_t turnsInTransit;
+	uint32_t messagesQueued;
+	/** Packets rejected since the previous sample */
+	uint32_t decryptFailures;
+	/** Milliseconds per second spent encrypting and decrypting */
+	float cryptoTime;
+};
+
+/**
+ * @brief Turns the difference of two samples of the counters into rates
+ *
+ * Counters that went down were reset by a new game and count from zero.
+ */
+Rates ComputeRates(const NetStats &previous, const NetStats &current, float seconds);
+
+/**
+ * @brief Writes a sample as a single line of JSON
+ * @param time Milliseconds since the first sample
+ */
+void WriteJson(std::ostream &out, uint32_t time, const Rates &rates, const NetStats &totals);
+
+/** @brief Shows the network counters next to the FPS counter in multiplayer games */
+void EnableOverlay();
+bool IsOverlayEnabled();
+/** @brief Appends a line of JSON with the network counters to the given file every second */
+void SetLogPath(const std::string &path);
+
+/** @brief Takes a new sample once per second, call once per game loop */
+void Update();
+/** @brief The rates for the overlay, nullptr until two samples have been taken */
+const Rates *GetOverlayRates();
+
+} // namespace netstats
+
+} // namespace devilution
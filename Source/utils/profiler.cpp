@@ -0,0 +1,267 @@
+/**
+ * @file profiler.cpp
+ *
+ * Implementation of the game loop and renderer timing instrumentation.
+ */
+#include "utils/profiler.h"
+
+#include <chrono>
+#include <memory>
+
+#include "utils/file_util.h"
+#include "utils/log.hpp"
+
+namespace devilution {
+
+namespace profiler {
+
+namespace {
+
+/** Number of recent ticks the overlay is based on, 10 seconds at the default tick rate */
+constexpr size_t OverlayTicks = 200;
+constexpr uint64_t OverlayRefreshInterval = 1000000000;
+
+std::unique_ptr<TickProfiler> Ticks;
+std::unique_ptr<FrameProfiler> Frames;
+std::string TracePath;
+std::string RenderCsvPath;
+bool ShowOverlay = false;
+bool ShowRenderOverlay = false;
+std::array<PhaseStats, TickPhaseCount> OverlayStats {};
+PhaseStats OverlayTickStats {};
+uint64_t OverlayUpdated = 0;
+
+uint64_t Now()
+{
+	using namespace std::chrono;
+	return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+void WriteTrace()
+{
+	auto stream = CreateFileStream(TracePath.c_str(), std::fstream::out | std::fstream::trunc);
+	if (stream == nullptr || stream->fail()) {
+		LogError("Unable to write trace file {}", TracePath);
+		return;
+	}
+
+	bool first = true;
+	*stream << "{\"traceEvents\":[";
+	if (Ticks != nullptr)
+		Ticks->WriteTraceEvents(*stream, "GameTick", 1, first);
+	if (Frames != nullptr)
+		Frames->WriteTraceEvents(*stream, "Frame", 2, first);
+	*stream << "\n]}\n";
+
+	Log("Wrote trace to {}", TracePath);
+}
+
+void WriteRenderCsv()
+{
+	auto stream = CreateFileStream(RenderCsvPath.c_str(), std::fstream::out | std::fstream::trunc);
+	if (stream == nullptr || stream->fail()) {
+		LogError("Unable to write frame timings to {}", RenderCsvPath);
+		return;
+	}
+
+	Frames->WriteCsv(*stream);
+	Log("Wrote {} frames to {}", Frames->Size(), RenderCsvPath);
+}
+
+} // namespace
+
+const char *PhaseName(TickPhase phase)
+{
+	switch (phase) {
+	case TickPhase::ProcessInput:
+		return "ProcessInput";
+	case TickPhase::ProcessPlayers:
+		return "ProcessPlayers";
+	case TickPhase::ProcessMonsters:
+		return "ProcessMonsters";
+	case TickPhase::ProcessObjects:
+		return "ProcessObjects";
+	case TickPhase::ProcessMissiles:
+		return "ProcessMissiles";
+	case TickPhase::ProcessItems:
+		return "ProcessItems";
+	case TickPhase::ProcessTowners:
+		return "ProcessTowners";
+	case TickPhase::ProcessLightList:
+		return "ProcessLightList";
+	case TickPhase::ProcessVisionList:
+		return "ProcessVisionList";
+	case TickPhase::SoundUpdate:
+		return "SoundUpdate";
+	case TickPhase::CheckTriggers:
+		return "CheckTriggers";
+	case TickPhase::CheckQuests:
+		return "CheckQuests";
+	case TickPhase::PfileUpdate:
+		return "PfileUpdate";
+	}
+	return "Unknown";
+}
+
+const char *PhaseName(RenderStage stage)
+{
+	switch (stage) {
+	case RenderStage::Floor:
+		return "Floor";
+	case RenderStage::Dungeon:
+		return "Dungeon";
+	case RenderStage::Zoom:
+		return "Zoom";
+	case RenderStage::Automap:
+		return "Automap";
+	case RenderStage::ItemLabels:
+		return "ItemLabels";
+	case RenderStage::Panels:
+		return "Panels";
+	case RenderStage::Cursor:
+		return "Cursor";
+	case RenderStage::TextureUpload:
+		return "TextureUpload";
+	case RenderStage::Present:
+		return "Present";
+	}
+	return "Unknown";
+}
+
+void Enable()
+{
+	if (Ticks == nullptr)
+		Ticks = std::make_unique<TickProfiler>();
+}
+
+bool IsEnabled()
+{
+	return Ticks != nullptr;
+}
+
+void SetTracePath(const std::string &path)
+{
+	Enable();
+	TracePath = path;
+}
+
+void EnableOverlay()
+{
+	Enable();
+	ShowOverlay = true;
+}
+
+bool IsOverlayEnabled()
+{
+	return ShowOverlay;
+}
+
+void BeginTick()
+{
+	if (Ticks != nullptr)
+		Ticks->BeginSample(Now());
+}
+
+void BeginPhase(TickPhase phase)
+{
+	if (Ticks != nullptr)
+		Ticks->BeginPhase(phase, Now());
+}
+
+void EndPhase()
+{
+	if (Ticks != nullptr)
+		Ticks->EndPhase(Now());
+}
+
+void EndTick()
+{
+	if (Ticks != nullptr)
+		Ticks->EndSample(Now());
+}
+
+const std::array<PhaseStats, TickPhaseCount> &GetOverlayStats()
+{
+	const uint64_t now = Now();
+	if (Ticks != nullptr && now - OverlayUpdated >= OverlayRefreshInterval) {
+		OverlayUpdated = now;
+		for (size_t i = 0; i < TickPhaseCount; i++)
+			OverlayStats[i] = Ticks->Stats(static_cast<TickPhase>(i), OverlayTicks);
+		OverlayTickStats = Ticks->TotalStats(OverlayTicks);
+	}
+	return OverlayStats;
+}
+
+const PhaseStats &GetOverlayTickStats()
+{
+	return OverlayTickStats;
+}
+
+void EnableRenderProfiler()
+{
+	if (Frames == nullptr)
+		Frames = std::make_unique<FrameProfiler>();
+}
+
+bool IsRenderProfilerEnabled()
+{
+	return Frames != nullptr;
+}
+
+void SetRenderCsvPath(const std::string &path)
+{
+	EnableRenderProfiler();
+	RenderCsvPath = path;
+}
+
+void EnableRenderOverlay()
+{
+	EnableRenderProfiler();
+	ShowRenderOverlay = true;
+}
+
+bool IsRenderOverlayEnabled()
+{
+	return ShowRenderOverlay;
+}
+
+void BeginFrame()
+{
+	if (Frames != nullptr)
+		Frames->BeginSample(Now());
+}
+
+void EndFrame()
+{
+	if (Frames != nullptr)
+		Frames->EndSample(Now());
+}
+
+const FrameProfiler *GetFrameProfiler()
+{
+	return Frames.get();
+}
+
+RenderStageTimer::RenderStageTimer(RenderStage stage)
+    : stage_(stage)
+    , start_(Frames != nullptr ? Now() : 0)
+{
+}
+
+RenderStageTimer::~RenderStageTimer()
+{
+	if (Frames != nullptr)
+		Frames->AddPhaseTime(stage_, start_, Now());
+}
+
+void Shutdown()
+{
+	if (!TracePath.empty())
+		WriteTrace();
+	if (Frames != nullptr && !RenderCsvPath.empty())
+		WriteRenderCsv();
+}
+
+} // namespace profiler
+
+} // namespace devilution
@@ -0,0 +1,369 @@
+/**
+ * @file profiler.h
+ *
+ * Lightweight timing instrumentation for the game loop and the renderer.
+ *
+ * The profiler is always compiled in but does nothing until it has been enabled, so the
+ * instrumentation points can stay in release builds.
+ */
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "utils/enum_traits.h"
+
+namespace devilution {
+
+namespace profiler {
+
+/**
+ * @brief Parts of a game tick, GameLogicStep values are mapped onto these
+ */
+enum class TickPhase : uint8_t {
+	ProcessInput,
+	ProcessPlayers,
+	ProcessMonsters,
+	ProcessObjects,
+	ProcessMissiles,
+	ProcessItems,
+	ProcessTowners,
+	ProcessLightList,
+	ProcessVisionList,
+	SoundUpdate,
+	CheckTriggers,
+	CheckQuests,
+	PfileUpdate,
+
+	LAST = PfileUpdate
+};
+
+/**
+ * @brief Parts of rendering a frame in DrawAndBlit
+ */
+enum class RenderStage : uint8_t {
+	Floor,
+	Dungeon,
+	Zoom,
+	Automap,
+	ItemLabels,
+	Panels,
+	Cursor,
+	TextureUpload,
+	Present,
+
+	LAST = Present
+};
+
+constexpr size_t TickPhaseCount = enum_size<TickPhase>::value;
+constexpr size_t RenderStageCount = enum_size<RenderStage>::value;
+
+const char *PhaseName(TickPhase phase);
+const char *PhaseName(RenderStage stage);
+
+/** @brief Timings of one phase in microseconds */
+struct PhaseStats {
+	/** Number of samples the phase ran in */
+	size_t samples;
+	float min;
+	float avg;
+	float p99;
+};
+
+/**
+ * @brief Records the duration of each phase for the most recent samples (game ticks or frames)
+ *
+ * Timestamps are passed in by the caller in nanoseconds so the class itself doesn't depend on a clock.
+ */
+template <typename Phase>
+class PhaseProfiler {
+public:
+	static constexpr size_t PhaseCount = enum_size<Phase>::value;
+
+	explicit PhaseProfiler(size_t capacity = 4096)
+	    : samples_(capacity)
+	{
+	}
+
+	void BeginSample(uint64_t now)
+	{
+		current_.start = now;
+		current_.duration = 0;
+		for (PhaseSample &phase : current_.phases)
+			phase = { NotRun, 0 };
+		inSample_ = true;
+		inPhase_ = false;
+	}
+
+	/** @brief Starts timing a phase, any phase that is still running ends at the same time */
+	void BeginPhase(Phase phase, uint64_t now)
+	{
+		if (!inSample_)
+			return;
+
+		EndPhase(now);
+		PhaseSample &sample = current_.phases[static_cast<size_t>(phase)];
+		// A phase can run more than once per sample, the time in between is counted as well
+		if (sample.begin == NotRun)
+			sample.begin = Elapsed(current_.start, now);
+		currentPhase_ = phase;
+		inPhase_ = true;
+	}
+
+	void EndPhase(uint64_t now)
+	{
+		if (!inPhase_)
+			return;
+
+		PhaseSample &sample = current_.phases[static_cast<size_t>(currentPhase_)];
+		sample.duration = Elapsed(current_.start, now) - sample.begin;
+		inPhase_ = false;
+	}
+
+	/**
+	 * @brief Adds the time of a scoped timer to a phase, independent of BeginPhase/EndPhase
+	 *
+	 * Repeated calls for the same phase add up, the phase is then reported as starting with the first call.
+	 */
+	void AddPhaseTime(Phase phase, uint64_t begin, uint64_t end)
+	{
+		if (!inSample_)
+			return;
+
+		PhaseSample &sample = current_.phases[static_cast<size_t>(phase)];
+		if (sample.begin == NotRun)
+			sample.begin = Elapsed(current_.start, begin);
+		sample.duration += Elapsed(begin, end);
+	}
+
+	void EndSample(uint64_t now)
+	{
+		if (!inSample_ || samples_.empty())
+			return;
+
+		EndPhase(now);
+		current_.duration = Elapsed(current_.start, now);
+		samples_[next_] = current_;
+		next_ = (next_ + 1) % samples_.size();
+		count_ = std::min(count_ + 1, samples_.size());
+		inSample_ = false;
+	}
+
+	/** @brief Number of samples that are currently stored */
+	size_t Size() const
+	{
+		return count_;
+	}
+
+	/**
+	 * @brief Duration of a stored sample in nanoseconds
+	 * @param age 0 for the most recent sample
+	 */
+	uint32_t SampleDuration(size_t age) const
+	{
+		return Sample(age).duration;
+	}
+
+	/** @brief Time spent in a phase during a stored sample in nanoseconds, 0 if it didn't run */
+	uint32_t PhaseDuration(size_t age, Phase phase) const
+	{
+		return Sample(age).phases[static_cast<size_t>(phase)].duration;
+	}
+
+	/**
+	 * @brief Calculates the timings of a phase
+	 * @param lastSamples Only look at this many of the most recent samples
+	 */
+	PhaseStats Stats(Phase phase, size_t lastSamples) const
+	{
+		return CollectStats(lastSamples, [phase](const Entry &entry, uint32_t &duration) {
+			const PhaseSample &sample = entry.phases[static_cast<size_t>(phase)];
+			duration = sample.duration;
+			return sample.begin != NotRun;
+		});
+	}
+
+	/** @brief Same as Stats but for the whole sample */
+	PhaseStats TotalStats(size_t lastSamples) const
+	{
+		return CollectStats(lastSamples, [](const Entry &entry, uint32_t &duration) {
+			duration = entry.duration;
+			return true;
+		});
+	}
+
+	/**
+	 * @brief Writes the stored samples as events in the Chrome trace event format (chrome://tracing, Perfetto)
+	 * @param sampleName Name of the event covering a whole sample
+	 * @param threadId Samples of different profilers are shown on separate tracks
+	 * @param first Whether no event has been written to the trace yet, updated by the call
+	 */
+	void WriteTraceEvents(std::ostream &out, const char *sampleName, int threadId, bool &first) const
+	{
+		for (size_t age = count_; age-- > 0;) {
+			const Entry &entry = Sample(age);
+			WriteTraceEvent(out, sampleName, threadId, entry.start, entry.duration, first);
+			for (size_t i = 0; i < PhaseCount; i++) {
+				const PhaseSample &phase = entry.phases[i];
+				if (phase.begin != NotRun)
+					WriteTraceEvent(out, PhaseName(static_cast<Phase>(i)), threadId, entry.start + phase.begin, phase.duration, first);
+			}
+		}
+	}
+
+	/**
+	 * @brief Writes one line per stored sample with the durations of all phases in microseconds
+	 */
+	void WriteCsv(std::ostream &out) const
+	{
+		out << "start_us,total_us";
+		for (size_t i = 0; i < PhaseCount; i++)
+			out << "," << PhaseName(static_cast<Phase>(i)) << "_us";
+		out << "\n";
+
+		for (size_t age = count_; age-- > 0;) {
+			const Entry &entry = Sample(age);
+			out << (entry.start - Sample(count_ - 1).start) / 1000 << "," << entry.duration / 1000.F;
+			for (const PhaseSample &phase : entry.phases)
+				out << "," << phase.duration / 1000.F;
+			out << "\n";
+		}
+	}
+
+private:
+	static constexpr uint32_t NotRun = UINT32_MAX;
+
+	struct PhaseSample {
+		/** Nanoseconds from the start of the sample */
+		uint32_t begin;
+		uint32_t duration;
+	};
+
+	struct Entry {
+		uint64_t start;
+		uint32_t duration;
+		std::array<PhaseSample, PhaseCount> phases;
+	};
+
+	static uint32_t Elapsed(uint64_t from, uint64_t to)
+	{
+		return static_cast<uint32_t>(std::min<uint64_t>(to - from, NotRun - 1));
+	}
+
+	static void WriteTraceEvent(std::ostream &out, const char *name, int threadId, uint64_t start, uint32_t duration, bool &first)
+	{
+		if (!first)
+			out << ",";
+		first = false;
+		out << "\n{\"name\":\"" << name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << threadId
+		    << ",\"ts\":" << start / 1000 << "." << start % 1000 / 100
+		    << ",\"dur\":" << duration / 1000 << "." << duration % 1000 / 100 << "}";
+	}
+
+	const Entry &Sample(size_t age) const
+	{
+		return samples_[(next_ + samples_.size() - 1 - age) % samples_.size()];
+	}
+
+	template <typename F>
+	PhaseStats CollectStats(size_t lastSamples, F &&getDuration) const
+	{
+		const size_t count = std::min(lastSamples, count_);
+		std::vector<uint32_t> durations;
+		durations.reserve(count);
+		for (size_t age = 0; age < count; age++) {
+			uint32_t duration;
+			if (getDuration(Sample(age), duration))
+				durations.push_back(duration);
+		}
+
+		PhaseStats stats {};
+		stats.samples = durations.size();
+		if (durations.empty())
+			return stats;
+
+		uint64_t total = 0;
+		uint32_t min = NotRun;
+		for (uint32_t duration : durations) {
+			total += duration;
+			min = std::min(min, duration);
+		}
+		const size_t p99Index = (durations.size() * 99 - 1) / 100;
+		std::nth_element(durations.begin(), durations.begin() + p99Index, durations.end());
+
+		stats.min = min / 1000.F;
+		stats.avg = static_cast<float>(total) / durations.size() / 1000.F;
+		stats.p99 = durations[p99Index] / 1000.F;
+		return stats;
+	}
+
+	std::vector<Entry> samples_;
+	size_t next_ = 0;
+	size_t count_ = 0;
+	Entry current_ {};
+	bool inSample_ = false;
+	bool inPhase_ = false;
+	Phase currentPhase_ {};
+};
+
+using TickProfiler = PhaseProfiler<TickPhase>;
+using FrameProfiler = PhaseProfiler<RenderStage>;
+
+/** @brief Turns on tick profiling */
+void Enable();
+bool IsEnabled();
+/** @brief Enables profiling and writes a Chrome trace of the stored ticks and frames to the given path on shutdown */
+void SetTracePath(const std::string &path);
+/** @brief Enables profiling and shows the tick timings next to the FPS counter */
+void EnableOverlay();
+bool IsOverlayEnabled();
+
+void BeginTick();
+void BeginPhase(TickPhase phase);
+void EndPhase();
+void EndTick();
+
+/** @brief Timings for the on-screen overlay, refreshed once per second */
+const std::array<PhaseStats, TickPhaseCount> &GetOverlayStats();
+const PhaseStats &GetOverlayTickStats();
+
+/** @brief Turns on render profiling */
+void EnableRenderProfiler();
+bool IsRenderProfilerEnabled();
+/** @brief Enables render profiling and writes the stored frames as CSV to the given path on shutdown */
+void SetRenderCsvPath(const std::string &path);
+/** @brief Enables render profiling and shows a frame time histogram on screen */
+void EnableRenderOverlay();
+bool IsRenderOverlayEnabled();
+
+void BeginFrame();
+void EndFrame();
+/** @brief Stored frames, nullptr if render profiling is disabled */
+const FrameProfiler *GetFrameProfiler();
+
+/**
+ * @brief Adds the time until the end of the scope to a render stage
+ */
+class RenderStageTimer {
+public:
+	explicit RenderStageTimer(RenderStage stage);
+	~RenderStageTimer();
+
+	RenderStageTimer(const RenderStageTimer &) = delete;
+	RenderStageTimer &operator=(const RenderStageTimer &) = delete;
+
+private:
+	RenderStage stage_;
+	uint64_t start_;
+};
+
+/** @brief Writes the trace and CSV files if they were requested */
+void Shutdown();
+
+} // namespace profiler
+
+} // namespace devilution
@@ -39,6 +39,20 @@ public:
 	{
 	}
 
+	/**
+	 * @brief Starts the thread with a stack of the given size, SDL1 and SDL before 2.0.9 use their default instead
+	 */
+	SdlThread(void (*handler)(void), [[maybe_unused]] size_t stackSize)
+#if defined(USE_SDL1) || !SDL_VERSION_ATLEAST(2, 0, 9)
+	    : SdlThread(handler)
+#else
+	    : thread(SDL_CreateThreadWithStackSize(ThreadTranslate, nullptr, stackSize, (void *)handler), ThreadDeleter)
+#endif
+	{
+		if (thread == nullptr)
+			ErrSdl();
+	}
+
 	SdlThread() = default;
 
 	bool joinable() const
@@ -0,0 +1,180 @@
+/**
+ * @file timedemo.cpp
+ *
+ * Implementation of the demo playback benchmark results.
+ */
+#include "utils/timedemo.h"
+
+#include <algorithm>
+#include <chrono>
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+#include <fmt/format.h>
+
+#include "config.h"
+#include "utils/file_util.h"
+#include "utils/log.hpp"
+
+namespace devilution {
+
+namespace timedemo {
+
+namespace {
+
+std::string ResultPath;
+std::vector<uint32_t> FrameTimes;
+std::vector<uint32_t> TickTimes;
+uint64_t LastFrame = 0;
+uint64_t TickStart = 0;
+
+/** @brief Current time in microseconds */
+uint64_t Now()
+{
+	using namespace std::chrono;
+	return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+uint32_t Elapsed(uint64_t from, uint64_t to)
+{
+	return static_cast<uint32_t>(std::min<uint64_t>(to - from, UINT32_MAX));
+}
+
+std::string FormatPercentiles(const Percentiles &percentiles)
+{
+	return fmt::format(R"({{"samples":{},"p50":{:.3f},"p95":{:.3f},"p99":{:.3f},"max":{:.3f}}})",
+	    percentiles.samples, percentiles.p50, percentiles.p95, percentiles.p99, percentiles.max);
+}
+
+/** @brief Escapes the characters that can't appear as is in a JSON string */
+std::string EscapeJson(const std::string &text)
+{
+	std::string escaped;
+	for (char c : text) {
+		if (c == '"' || c == '\\')
+			escaped += '\\';
+		if (static_cast<unsigned char>(c) < 0x20) {
+			escaped += fmt::format("\\u{:04x}", c);
+			continue;
+		}
+		escaped += c;
+	}
+	return escaped;
+}
+
+} // namespace
+
+Percentiles CalculatePercentiles(std::vector<uint32_t> durations)
+{
+	Percentiles percentiles {};
+	percentiles.samples = durations.size();
+	if (durations.empty())
+		return percentiles;
+
+	std::sort(durations.begin(), durations.end());
+	const auto percentile = [&durations](size_t p) {
+		return durations[(durations.size() * p - 1) / 100] / 1000.F;
+	};
+	percentiles.p50 = percentile(50);
+	percentiles.p95 = percentile(95);
+	percentiles.p99 = percentile(99);
+	percentiles.max = durations.back() / 1000.F;
+	return percentiles;
+}
+
+void WriteJson(std::ostream &out, const Result &result)
+{
+	const float fps = result.seconds > 0 ? result.frames / result.seconds : 0;
+	out << fmt::format(R"({{"demo":"{}","version":"{}","ticks":{},"frames":{},"seconds":{:.3f},"fps":{:.1f},"frame_ms":{},"tick_ms":{},"peak_rss_kb":{}}})",
+	    EscapeJson(result.demo), EscapeJson(result.version), result.ticks, result.frames, result.seconds, fps,
+	    FormatPercentiles(result.frameTime), FormatPercentiles(result.tickTime), result.peakRss);
+}
+
+uint64_t GetPeakResidentSetSize()
+{
+#if defined(__linux__) || defined(__APPLE__)
+	rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0)
+		return 0;
+#ifdef __APPLE__
+	// Reported in bytes on macOS and in KiB on Linux
+	return usage.ru_maxrss / 1024;
+#else
+	return usage.ru_maxrss;
+#endif
+#else
+	return 0;
+#endif
+}
+
+void SetResultPath(const std::string &path)
+{
+	ResultPath = path;
+}
+
+bool IsEnabled()
+{
+	return !ResultPath.empty();
+}
+
+void Start()
+{
+	FrameTimes.clear();
+	TickTimes.clear();
+	LastFrame = Now();
+}
+
+void BeginTick()
+{
+	if (IsEnabled())
+		TickStart = Now();
+}
+
+void EndTick()
+{
+	if (IsEnabled())
+		TickTimes.push_back(Elapsed(TickStart, Now()));
+}
+
+void EndFrame()
+{
+	if (!IsEnabled())
+		return;
+
+	const uint64_t now = Now();
+	FrameTimes.push_back(Elapsed(LastFrame, now));
+	LastFrame = now;
+}
+
+void Finish(const std::string &demo, uint32_t ticks, float seconds)
+{
+	if (!IsEnabled())
+		return;
+
+	Result result;
+	result.demo = demo;
+	result.version = PROJECT_VERSION;
+	result.ticks = ticks;
+	result.frames = static_cast<uint32_t>(FrameTimes.size());
+	result.seconds = seconds;
+	result.frameTime = CalculatePercentiles(std::move(FrameTimes));
+	result.tickTime = CalculatePercentiles(std::move(TickTimes));
+	result.peakRss = GetPeakResidentSetSize();
+	FrameTimes.clear();
+	TickTimes.clear();
+
+	auto stream = CreateFileStream(ResultPath.c_str(), std::fstream::out | std::fstream::trunc);
+	if (stream == nullptr || stream->fail()) {
+		LogError("Unable to write benchmark results to {}", ResultPath);
+		return;
+	}
+	WriteJson(*stream, result);
+	*stream << "\n";
+	Log("Wrote benchmark results to {}", ResultPath);
+}
+
+} // namespace timedemo
+
+} // namespace devilution
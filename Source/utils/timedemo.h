@@ -0,0 +1,66 @@
+/**
+ * @file timedemo.h
+ *
+ * Collects frame and tick times during demo playback and writes them as benchmark results.
+ */
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace devilution {
+
+namespace timedemo {
+
+/** @brief Distribution of durations in milliseconds */
+struct Percentiles {
+	size_t samples;
+	float p50;
+	float p95;
+	float p99;
+	float max;
+};
+
+/** @brief Outcome of playing back one demo */
+struct Result {
+	std::string demo;
+	std::string version;
+	uint32_t ticks;
+	uint32_t frames;
+	float seconds;
+	Percentiles frameTime;
+	Percentiles tickTime;
+	/** Peak resident set size of the process in KiB, 0 if the platform doesn't report it */
+	uint64_t peakRss;
+};
+
+/**
+ * @brief Calculates nearest-rank percentiles
+ * @param durations Durations in microseconds
+ */
+Percentiles CalculatePercentiles(std::vector<uint32_t> durations);
+
+/** @brief Writes the result as a single JSON object */
+void WriteJson(std::ostream &out, const Result &result);
+
+/** @brief Peak resident set size of the current process in KiB, 0 if unknown */
+uint64_t GetPeakResidentSetSize();
+
+/** @brief Collect timings during demo playback and write them to the given path when it ends */
+void SetResultPath(const std::string &path);
+bool IsEnabled();
+
+/** @brief Discards collected timings, the following frames and ticks are measured from now */
+void Start();
+void BeginTick();
+void EndTick();
+/** @brief Marks the end of a frame, the frame time is the time since the previous frame */
+void EndFrame();
+/** @brief Writes the collected timings to the result file */
+void Finish(const std::string &demo, uint32_t ticks, float seconds);
+
+} // namespace timedemo
+
+} // namespace devilution
@@ -0,0 +1,247 @@
+/**
+ * @file devilutionx_bench.cpp
+ *
+ * Plays back every demo in a directory with --timedemo and combines the results into one JSON file.
+ *
+ * Each demo runs in its own process so that the peak memory usage is reported per demo and a crash
+ * only affects the result of that demo.
+ */
+#include <algorithm>
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <cerrno>
+#include <spawn.h>
+#include <sys/wait.h>
+
+extern char **environ;
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+
+struct Options {
+	fs::path game;
+	fs::path demoDir;
+	fs::path output = "bench.json";
+	std::string dataDir;
+	bool headless = false;
+	int runs = 1;
+};
+
+void PrintUsage()
+{
+	std::cout << "Usage: devilutionx-bench [options] <demo directory>\n\n"
+	          << "Plays back every demo_<#>.dmo in the directory, the directory must also contain the save games used by the demos.\n\n"
+	          << "    --game <path>       devilutionx executable, defaults to the one next to devilutionx-bench\n"
+	          << "    --data-dir <path>   Passed on to devilutionx\n"
+	          << "    --headless          Play back without rendering, only the tick times are meaningful\n"
+	          << "    --runs <#>          Play back each demo this many times\n"
+	          << "    --output <file>     Where to write the results, defaults to bench.json\n";
+}
+
+bool ParseOptions(int argc, char **argv, Options &options)
+{
+	options.game = fs::path(argv[0]).parent_path() / "devilutionx";
+	for (int i = 1; i < argc; i++) {
+		const bool hasValue = i + 1 < argc;
+		if (strcmp(argv[i], "--game") == 0 && hasValue) {
+			options.game = argv[++i];
+		} else if (strcmp(argv[i], "--data-dir") == 0 && hasValue) {
+			options.dataDir = argv[++i];
+		} else if (strcmp(argv[i], "--headless") == 0) {
+			options.headless = true;
+		} else if (strcmp(argv[i], "--runs") == 0 && hasValue) {
+			options.runs = std::max(atoi(argv[++i]), 1);
+		} else if (strcmp(argv[i], "--output") == 0 && hasValue) {
+			options.output = argv[++i];
+		} else if (argv[i][0] != '-' && options.demoDir.empty()) {
+			options.demoDir = argv[i];
+		} else {
+			return false;
+		}
+	}
+	return !options.demoDir.empty();
+}
+
+/**
+ * @brief Reads the number out of a demo_<#>.dmo file name
+ * @return -1 unless the name is exactly the one the game gives demo number #, as in demo_1.dmo but not demo_01.dmo
+ */
+int DemoNumber(const fs::path &file)
+{
+	if (file.extension() != ".dmo")
+		return -1;
+	const std::string stem = file.stem().string();
+	const std::string prefix = "demo_";
+	if (stem.compare(0, prefix.size(), prefix) != 0)
+		return -1;
+	const char *first = stem.data() + prefix.size();
+	const char *last = stem.data() + stem.size();
+	// from_chars would take a sign as well
+	if (first == last || *first < '0' || *first > '9' || (*first == '0' && last - first > 1))
+		return -1;
+	int number;
+	const std::from_chars_result result = std::from_chars(first, last, number);
+	if (result.ec != std::errc() || result.ptr != last)
+		return -1;
+	return number;
+}
+
+/** @brief Numbers of the demo_<#>.dmo files in the directory in ascending order */
+std::vector<int> FindDemos(const fs::path &demoDir)
+{
+	std::vector<int> demos;
+	for (const fs::directory_entry &entry : fs::directory_iterator(demoDir)) {
+		const int number = DemoNumber(entry.path().filename());
+		if (number >= 0)
+			demos.push_back(number);
+	}
+	std::sort(demos.begin(), demos.end());
+	return demos;
+}
+
+#ifdef _WIN32
+/** @brief Quotes an argument so that the C runtime of the child process splits it back out unchanged */
+std::string QuoteArgument(const std::string &arg)
+{
+	if (!arg.empty() && arg.find_first_of(" \t\n\v\"") == std::string::npos)
+		return arg;
+	std::string quoted = "\"";
+	size_t backslashes = 0;
+	for (char c : arg) {
+		if (c == '\\') {
+			backslashes++;
+			continue;
+		}
+		// Backslashes only escape when they come before a quote
+		quoted.append(c == '"' ? backslashes * 2 + 1 : backslashes, '\\');
+		backslashes = 0;
+		quoted += c;
+	}
+	quoted.append(backslashes * 2, '\\');
+	return quoted + "\"";
+}
+#endif
+
+/**
+ * @brief Runs a program and waits for it to exit, the arguments reach it as they are without going through a shell
+ * @return The exit status, -1 if the program couldn't be started
+ */
+int RunProcess(const std::vector<std::string> &args)
+{
+#ifdef _WIN32
+	std::vector<std::string> quoted;
+	for (const std::string &arg : args)
+		quoted.push_back(QuoteArgument(arg));
+	std::vector<const char *> argv;
+	for (const std::string &arg : quoted)
+		argv.push_back(arg.c_str());
+	argv.push_back(nullptr);
+	return static_cast<int>(_spawnv(_P_WAIT, args[0].c_str(), argv.data()));
+#else
+	std::vector<char *> argv;
+	for (const std::string &arg : args)
+		argv.push_back(const_cast<char *>(arg.c_str()));
+	argv.push_back(nullptr);
+	pid_t pid;
+	if (posix_spawn(&pid, argv[0], nullptr, nullptr, argv.data(), environ) != 0)
+		return -1;
+	int status;
+	while (waitpid(pid, &status, 0) == -1) {
+		if (errno != EINTR)
+			return -1;
+	}
+	if (WIFEXITED(status))
+		return WEXITSTATUS(status);
+	return -1;
+#endif
+}
+
+/** @brief Plays back a demo and returns the JSON object written by the game, empty on failure */
+std::string RunDemo(const Options &options, int demo)
+{
+	const fs::path resultPath = fs::temp_directory_path() / ("devilutionx-bench-" + std::to_string(demo) + ".json");
+	fs::remove(resultPath);
+
+	std::vector<std::string> args { options.game.string(), "--save-dir", options.demoDir.string(), "--demo", std::to_string(demo),
+		"--timedemo", "--bench-json", resultPath.string() };
+	if (options.headless)
+		args.emplace_back("--headless");
+	if (!options.dataDir.empty()) {
+		args.emplace_back("--data-dir");
+		args.push_back(options.dataDir);
+	}
+
+	std::cout << args[0];
+	for (size_t i = 1; i < args.size(); i++)
+		std::cout << ' ' << args[i];
+	std::cout << std::endl;
+	const int status = RunProcess(args);
+
+	std::ifstream file(resultPath);
+	std::stringstream result;
+	result << file.rdbuf();
+	file.close();
+	fs::remove(resultPath);
+
+	std::string json = result.str();
+	while (!json.empty() && (json.back() == '\n' || json.back() == '\r'))
+		json.pop_back();
+	if (json.empty())
+		std::cerr << "demo_" << demo << ".dmo failed (exit status " << status << ")" << std::endl;
+	return json;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+	Options options;
+	if (!ParseOptions(argc, argv, options)) {
+		PrintUsage();
+		return 1;
+	}
+
+	const std::vector<int> demos = FindDemos(options.demoDir);
+	if (demos.empty()) {
+		std::cerr << "No demos found in " << options.demoDir.string() << std::endl;
+		return 1;
+	}
+
+	std::vector<std::string> results;
+	int failed = 0;
+	for (int demo : demos) {
+		for (int run = 0; run < options.runs; run++) {
+			std::string result = RunDemo(options, demo);
+			if (result.empty())
+				failed++;
+			else
+				results.push_back(std::move(result));
+		}
+	}
+
+	std::ofstream output(options.output);
+	output << "{\"runs\":" << options.runs << ",\"headless\":" << (options.headless ? "true" : "false") << ",\"results\":[";
+	for (size_t i = 0; i < results.size(); i++)
+		output << (i == 0 ? "\n" : ",\n") << results[i];
+	output << "\n]}\n";
+	if (!output) {
+		std::cerr << "Unable to write " << options.output.string() << std::endl;
+		return 1;
+	}
+
+	std::cout << "Wrote " << results.size() << " results to " << options.output.string() << std::endl;
+	return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,119 @@
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <cstring>
+
+#include "engine/render/dun_render.hpp"
+#include "gendung.h"
+#include "options.h"
+#include "render_benchmark.hpp"
+
+using namespace devilution;
+
+namespace {
+
+/** Same order as the tile types in dun_render.cpp */
+enum class Tile : uint8_t {
+	Square,
+	TransparentSquare,
+	LeftTriangle,
+	RightTriangle,
+	LeftTrapezoid,
+	RightTrapezoid,
+};
+
+constexpr std::array<const char *, 6> TileNames { "Square", "TransparentSquare", "LeftTriangle", "RightTriangle", "LeftTrapezoid", "RightTrapezoid" };
+
+/** Room for the largest tile, a 32x32 square */
+constexpr size_t FrameSize = 32 * 32;
+
+/**
+ * @brief Builds a dungeon CEL with one frame per tile type
+ *
+ * The pixel data is a gradient, except for the transparent square which alternates 16 opaque and 16 transparent pixels per row.
+ */
+std::unique_ptr<byte[]> MakeDungeonCels()
+{
+	constexpr size_t TableSize = TileNames.size() * sizeof(uint32_t);
+	auto cels = std::make_unique<byte[]>(TableSize + TileNames.size() * FrameSize);
+	for (size_t tile = 0; tile < TileNames.size(); tile++) {
+		const uint32_t offset = SDL_SwapLE32(static_cast<uint32_t>(TableSize + tile * FrameSize));
+		memcpy(&cels[tile * sizeof(uint32_t)], &offset, sizeof(offset));
+
+		byte *frame = &cels[TableSize + tile * FrameSize];
+		if (static_cast<Tile>(tile) == Tile::TransparentSquare) {
+			for (int y = 0; y < 32; y++) {
+				*frame++ = static_cast<byte>(16);
+				for (int x = 0; x < 16; x++)
+					*frame++ = static_cast<byte>(x + y);
+				*frame++ = static_cast<byte>(-16);
+			}
+			continue;
+		}
+		for (size_t i = 0; i < FrameSize; i++)
+			frame[i] = static_cast<byte>(i % 128);
+	}
+	return cels;
+}
+
+enum class Transparency : uint8_t {
+	Solid,
+	Stippled,
+	Blended,
+};
+
+/**
+ * Arguments: tile type, light table index, Transparency, clipped
+ */
+void BM_RenderTile(benchmark::State &state)
+{
+	InitBenchmarkLighting(static_cast<int>(state.range(1)));
+	pDungeonCels = MakeDungeonCels();
+
+	const auto tile = static_cast<Tile>(state.range(0));
+	const auto transparency = static_cast<Transparency>(state.range(2));
+	const bool clipped = state.range(3) != 0;
+	level_cel_block = (static_cast<uint32_t>(tile) << 12) | static_cast<uint32_t>(tile);
+	cel_transparency_active = transparency != Transparency::Solid;
+	cel_foliage_active = false;
+	arch_draw_type = 0;
+	sgOptions.Graphics.bBlendedTransparancy = transparency == Transparency::Blended;
+
+	SDLSurfaceUniquePtr surface = CreateBenchmarkSurface();
+	const Surface out(surface.get());
+	// The position is the bottom left corner, the clipped tile sticks out of the top left of the surface
+	const int x = clipped ? -12 : 320;
+	const int y = clipped ? 20 : 240;
+
+	for (auto _ : state) {
+		RenderTile(out, x, y);
+		benchmark::ClobberMemory();
+	}
+
+	state.SetLabel(TileNames[static_cast<size_t>(tile)]);
+	state.SetItemsProcessed(state.iterations());
+	pDungeonCels = nullptr;
+}
+
+BENCHMARK(BM_RenderTile)
+    ->ArgNames({ "tile", "light", "trans", "clipped" })
+    ->ArgsProduct({ benchmark::CreateDenseRange(0, 5, 1), { 0, 8, 15 }, { 0, 1, 2 }, { 0, 1 } });
+
+void BM_RenderBlackTile(benchmark::State &state)
+{
+	const bool clipped = state.range(0) != 0;
+	SDLSurfaceUniquePtr surface = CreateBenchmarkSurface();
+	const Surface out(surface.get());
+	const int x = clipped ? -12 : 320;
+	const int y = clipped ? 20 : 240;
+
+	for (auto _ : state) {
+		world_draw_black_tile(out, x, y);
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_RenderBlackTile)->ArgName("clipped")->DenseRange(0, 1);
+
+} // namespace
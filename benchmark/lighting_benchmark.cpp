@@ -0,0 +1,96 @@
+#include <benchmark/benchmark.h>
+
+#include "gendung.h"
+#include "lighting.h"
+
+using namespace devilution;
+
+namespace {
+
+void InitBenchmarkLightMap()
+{
+	currlevel = 5;
+	MakeLightRadiusTables();
+	InitLighting();
+	memset(dPreLight, 15, sizeof(dPreLight));
+	memset(dLight, 15, sizeof(dLight));
+}
+
+/**
+ * Arguments: light radius
+ */
+void BM_DoLighting(benchmark::State &state)
+{
+	InitBenchmarkLightMap();
+	const int radius = static_cast<int>(state.range(0));
+	const int lnum = AddLight({ 56, 56 }, radius);
+	ChangeLightOffset(lnum, { -3, 5 });
+
+	for (auto _ : state) {
+		DoLighting(Lights[lnum].position.tile, radius, lnum);
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations());
+	InitLighting();
+}
+
+BENCHMARK(BM_DoLighting)->ArgName("radius")->Arg(3)->Arg(8)->Arg(15);
+
+/**
+ * Arguments: number of lights, all of them move every tick
+ */
+void BM_ProcessLightList(benchmark::State &state)
+{
+	InitBenchmarkLightMap();
+	const int count = static_cast<int>(state.range(0));
+	for (int i = 0; i < count; i++)
+		AddLight({ 16 + (i % 8) * 10, 16 + (i / 8) * 10 }, 3 + i % 8);
+	ProcessLightList();
+
+	int tick = 0;
+	for (auto _ : state) {
+		tick++;
+		for (int i = 0; i < count; i++)
+			ChangeLightXY(i, { 16 + (i % 8) * 10 + tick % 2, 16 + (i / 8) * 10 });
+		ProcessLightList();
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations());
+	InitLighting();
+}
+
+BENCHMARK(BM_ProcessLightList)->ArgName("lights")->Arg(1)->Arg(8)->Arg(32);
+
+/**
+ * Arguments: number of players, only the first one moves every tick
+ */
+void BM_ProcessVisionList(benchmark::State &state)
+{
+	// Pillars every few tiles so that the rays get blocked now and then
+	for (int x = 0; x < MAXDUNX; x++) {
+		for (int y = 0; y < MAXDUNY; y++)
+			dPiece[x][y] = x % 7 == 0 && y % 5 == 0 ? 1 : 0;
+	}
+	nBlockTable[1] = true;
+	InitVision();
+	const int count = static_cast<int>(state.range(0));
+	for (int i = 0; i < count; i++)
+		AddVision({ 30 + i * 15, 56 }, 10, i == 0);
+	ProcessVisionList();
+
+	int tick = 0;
+	for (auto _ : state) {
+		tick++;
+		ChangeVisionXY(VisionList[0]._lid, { 30 + tick % 2, 56 });
+		ProcessVisionList();
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations());
+	memset(dPiece, 0, sizeof(dPiece));
+	nBlockTable[1] = false;
+	InitVision();
+}
+
+BENCHMARK(BM_ProcessVisionList)->ArgName("players")->Arg(1)->Arg(4);
+
+} // namespace
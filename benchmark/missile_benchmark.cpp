@@ -0,0 +1,94 @@
+#include <benchmark/benchmark.h>
+
+#include <cstring>
+
+#include "engine/random.hpp"
+#include "gendung.h"
+#include "lighting.h"
+#include "missiles.h"
+#include "monster.h"
+#include "player.h"
+
+using namespace devilution;
+
+namespace {
+
+/** The spells being spammed, fire walls, lightning and inferno */
+constexpr missile_id BenchmarkSpells[] = { MIS_FIREWALL, MIS_LIGHTCTRL, MIS_FLAMEC };
+
+/**
+ * @brief An empty walled in level without monsters, so the missiles fly and burn until they run out or hit a wall
+ */
+void InitBenchmarkLevel()
+{
+	leveltype = DTYPE_CATHEDRAL;
+	currlevel = 1;
+	gbIsMultiplayer = false;
+	memset(dPiece, 0, sizeof(dPiece));
+	memset(dMonster, 0, sizeof(dMonster));
+	memset(dObject, 0, sizeof(dObject));
+	memset(dPlayer, 0, sizeof(dPlayer));
+	memset(dFlags, 0, sizeof(dFlags));
+	memset(dMissile, 0, sizeof(dMissile));
+	nSolidTable[1] = true;
+	nMissileTable[1] = true;
+	for (int x = 0; x < MAXDUNX; x++) {
+		for (int y = 0; y < MAXDUNY; y++) {
+			if (x < 20 || x >= MAXDUNX - 20 || y < 20 || y >= MAXDUNY - 20)
+				dPiece[x][y] = 1;
+		}
+	}
+	InitLighting();
+	InitMissiles();
+
+	auto &player = Players[MyPlayerId];
+	player.plractive = true;
+	player.plrlevel = currlevel;
+	player._pLevel = 20;
+	player._pISplDur = 0;
+	player.position.tile = { 56, 56 };
+}
+
+/**
+ * @brief Casts spells from random tiles until the missile limit is close
+ */
+void CastBenchmarkSpells()
+{
+	int spell = 0;
+	while (ActiveMissileCount < MAXMISSILES - 10) {
+		const Point src { 26 + GenerateRnd(60), 26 + GenerateRnd(60) };
+		const Point dst = src + Displacement { GenerateRnd(9) - 4, GenerateRnd(9) - 4 };
+		AddMissile(src, dst, GenerateRnd(8), BenchmarkSpells[spell], TARGET_MONSTERS, MyPlayerId, 1, 5);
+		spell = (spell + 1) % std::size(BenchmarkSpells);
+	}
+}
+
+void BM_ProcessMissiles(benchmark::State &state)
+{
+	InitBenchmarkLevel();
+	SetRndSeed(1);
+	// Recast regularly to keep the missile count near the limit
+	constexpr int TicksPerCast = 16;
+	int tick = 0;
+	int64_t missiles = 0;
+	for (auto _ : state) {
+		if (tick++ % TicksPerCast == 0) {
+			state.PauseTiming();
+			CastBenchmarkSpells();
+			state.ResumeTiming();
+		}
+		missiles += ActiveMissileCount;
+		ProcessMissiles();
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(missiles);
+
+	InitMissiles();
+	memset(dPiece, 0, sizeof(dPiece));
+	memset(dFlags, 0, sizeof(dFlags));
+	memset(dMissile, 0, sizeof(dMissile));
+}
+
+BENCHMARK(BM_ProcessMissiles);
+
+} // namespace
@@ -0,0 +1,123 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+
+#include "engine/random.hpp"
+#include "gendung.h"
+#include "missiles.h"
+#include "monster.h"
+#include "path_cache.h"
+#include "player.h"
+
+using namespace devilution;
+
+namespace {
+
+/** Types found together on the first levels, each with a different AI */
+constexpr _monster_id BenchmarkMonsterTypes[] = { MT_NZOMBIE, MT_RFALLSP, MT_WSKELAX };
+
+constexpr Point BenchmarkPlayerPosition { 56, 56 };
+
+/**
+ * @brief An open level with the player standing in a walled off room, so the monsters keep chasing without ever reaching the player
+ */
+void InitBenchmarkLevel()
+{
+	leveltype = DTYPE_CATHEDRAL;
+	currlevel = 1;
+	gbIsMultiplayer = false;
+	memset(dPiece, 0, sizeof(dPiece));
+	memset(dMonster, 0, sizeof(dMonster));
+	memset(dObject, 0, sizeof(dObject));
+	memset(dPlayer, 0, sizeof(dPlayer));
+	nSolidTable[1] = true;
+	for (int x = BenchmarkPlayerPosition.x - 3; x <= BenchmarkPlayerPosition.x + 3; x++) {
+		for (int y = BenchmarkPlayerPosition.y - 3; y <= BenchmarkPlayerPosition.y + 3; y++) {
+			if (std::max(abs(x - BenchmarkPlayerPosition.x), abs(y - BenchmarkPlayerPosition.y)) == 3)
+				dPiece[x][y] = 1;
+		}
+	}
+	// The whole level is in view of the player, except for the cell where the golems wait
+	for (auto &column : dFlags) {
+		for (int8_t &flags : column)
+			flags = BFLAG_VISIBLE | BFLAG_LIT;
+	}
+	dFlags[GolemHoldingCell.x][GolemHoldingCell.y] = 0;
+	InvalidatePathCache();
+
+	auto &player = Players[MyPlayerId];
+	player.plractive = true;
+	player.plrlevel = currlevel;
+	player._pLvlChanging = false;
+	player._pHitPoints = 100 << 6;
+	player.position.tile = BenchmarkPlayerPosition;
+	player.position.future = BenchmarkPlayerPosition;
+	dPlayer[BenchmarkPlayerPosition.x][BenchmarkPlayerPosition.y] = MyPlayerId + 1;
+
+	for (size_t i = 0; i < std::size(BenchmarkMonsterTypes); i++) {
+		auto &monsterType = LevelMonsterTypes[i];
+		monsterType.mtype = BenchmarkMonsterTypes[i];
+		monsterType.MData = &MonsterData[BenchmarkMonsterTypes[i]];
+		monsterType.mMinHP = monsterType.MData->mMinHP;
+		monsterType.mMaxHP = monsterType.MData->mMaxHP;
+		for (auto &anim : monsterType.Anims) {
+			anim.Frames = 8;
+			anim.Rate = 1;
+		}
+	}
+}
+
+/**
+ * @brief Spreads the monsters over a square around the room of the player
+ */
+void PlaceBenchmarkMonsters(int count)
+{
+	InitLevelMonsters();
+	memset(dMonster, 0, sizeof(dMonster));
+	SetRndSeed(count);
+	// Same as InitMonsters, the golems wait outside of the map until they are summoned
+	for (int i = 0; i < MAX_PLRS; i++)
+		AddMonster(GolemHoldingCell, DIR_S, 0, false);
+	for (int i = 0; i < count; i++) {
+		Point position;
+		do {
+			position = { 26 + GenerateRnd(60), 26 + GenerateRnd(60) };
+		} while (std::max(abs(position.x - BenchmarkPlayerPosition.x), abs(position.y - BenchmarkPlayerPosition.y)) <= 3 || dMonster[position.x][position.y] != 0);
+		AddMonster(position, static_cast<Direction>(GenerateRnd(8)), static_cast<int>(i % std::size(BenchmarkMonsterTypes)), true);
+	}
+}
+
+/**
+ * Arguments: number of monsters
+ */
+void BM_ProcessMonsters(benchmark::State &state)
+{
+	InitBenchmarkLevel();
+	const int count = static_cast<int>(state.range(0));
+	// The monsters crowd around the room after a while, start over regularly to keep them moving
+	constexpr int TicksPerRound = 200;
+	int tick = 0;
+	for (auto _ : state) {
+		if (tick++ % TicksPerRound == 0) {
+			state.PauseTiming();
+			PlaceBenchmarkMonsters(count);
+			state.ResumeTiming();
+		}
+		ProcessMonsters();
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * count);
+
+	InitLevelMonsters();
+	memset(dMonster, 0, sizeof(dMonster));
+	memset(dPlayer, 0, sizeof(dPlayer));
+	memset(dPiece, 0, sizeof(dPiece));
+	InvalidatePathCache();
+}
+
+BENCHMARK(BM_ProcessMonsters)->ArgName("monsters")->Arg(50)->Arg(200);
+
+} // namespace
@@ -0,0 +1,125 @@
+#include <benchmark/benchmark.h>
+
+#include <functional>
+
+#include "engine/random.hpp"
+#include "gendung.h"
+#include "path.h"
+#include "path_cache.h"
+
+using namespace devilution;
+
+namespace {
+
+bool Walkable[MAXDUNX][MAXDUNY];
+
+constexpr Point Start { 56, 56 };
+
+/** @brief Fills the map with randomly placed solid tiles, the same for every run */
+void InitBenchmarkMap(int wallChance)
+{
+	SetRndSeed(3);
+	for (int x = 0; x < MAXDUNX; x++) {
+		for (int y = 0; y < MAXDUNY; y++) {
+			Walkable[x][y] = GenerateRnd(100) >= wallChance;
+			dPiece[x][y] = Walkable[x][y] ? 0 : 1;
+		}
+	}
+	// Always start on a walkable tile, or MightFindPath has nothing to check
+	Walkable[Start.x][Start.y] = true;
+	dPiece[Start.x][Start.y] = 0;
+	nSolidTable[0] = false;
+	nSolidTable[1] = true;
+	InvalidatePathCache();
+}
+
+bool PosOkBenchmark(Point position)
+{
+	return position.x >= 0 && position.x < MAXDUNX && position.y >= 0 && position.y < MAXDUNY && Walkable[position.x][position.y];
+}
+
+Point Destination(const benchmark::State &state)
+{
+	const int distance = static_cast<int>(state.range(1));
+	return Start + Displacement { distance, distance / 2 };
+}
+
+/**
+ * Arguments: percentage of solid tiles, distance to the destination
+ */
+void BM_FindPath(benchmark::State &state)
+{
+	InitBenchmarkMap(static_cast<int>(state.range(0)));
+	const Point destination = Destination(state);
+	int8_t path[MAX_PATH_LENGTH];
+
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(FindPath([](Point position) { return PosOkBenchmark(position); }, Start, destination, path));
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+
+/**
+ * Arguments: percentage of solid tiles, distance to the destination
+ */
+void BM_FindPathStdFunction(benchmark::State &state)
+{
+	InitBenchmarkMap(static_cast<int>(state.range(0)));
+	const Point destination = Destination(state);
+	const std::function<bool(Point)> posOk = [](Point position) { return PosOkBenchmark(position); };
+	int8_t path[MAX_PATH_LENGTH];
+
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(FindPath(posOk, Start, destination, path));
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+
+/**
+ * Arguments: percentage of solid tiles, distance to the destination, whether the map changes between checks
+ */
+void BM_MightFindPath(benchmark::State &state)
+{
+	InitBenchmarkMap(static_cast<int>(state.range(0)));
+	const Point destination = Destination(state);
+	const bool rebuild = state.range(2) != 0;
+
+	for (auto _ : state) {
+		if (rebuild)
+			InvalidatePathCache();
+		benchmark::DoNotOptimize(MightFindPath(Start, destination));
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+
+/**
+ * Arguments: percentage of solid tiles, distance to the destination
+ */
+void BM_CachedPath(benchmark::State &state)
+{
+	InitBenchmarkMap(static_cast<int>(state.range(0)));
+	const Point destination = Destination(state);
+	CachedPath cache;
+	int8_t path[MAX_PATH_LENGTH];
+
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(cache.FindPath([](Point position) { return PosOkBenchmark(position); }, 0, Start, destination, path));
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+
+// Distance 40 is out of reach and exhausts the path nodes
+BENCHMARK(BM_FindPath)
+    ->ArgNames({ "walls", "distance" })
+    ->ArgsProduct({ { 0, 20, 35 }, { 4, 20, 40 } });
+BENCHMARK(BM_FindPathStdFunction)
+    ->ArgNames({ "walls", "distance" })
+    ->ArgsProduct({ { 0, 20, 35 }, { 4, 20, 40 } });
+BENCHMARK(BM_MightFindPath)
+    ->ArgNames({ "walls", "distance", "rebuild" })
+    ->ArgsProduct({ { 0, 20, 35 }, { 4, 20, 40 }, { 0, 1 } });
+BENCHMARK(BM_CachedPath)
+    ->ArgNames({ "walls", "distance" })
+    ->ArgsProduct({ { 0, 20, 35 }, { 4, 20, 40 } });
+
+} // namespace
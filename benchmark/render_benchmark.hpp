@@ -0,0 +1,34 @@
+/**
+ * @file render_benchmark.hpp
+ *
+ * Shared setup of the renderer microbenchmarks.
+ */
+#pragma once
+
+#include "engine.h"
+#include "lighting.h"
+#include "scrollrt.h"
+#include "utils/sdl_wrap.h"
+
+namespace devilution {
+
+/**
+ * @brief Fills the light tables with a simple falloff instead of loading them from the game data
+ */
+inline void InitBenchmarkLighting(int lightTableIndex)
+{
+	InitLightMax();
+	for (size_t i = 0; i < LightTables.size(); i++) {
+		const int shade = static_cast<int>(i / 256);
+		LightTables[i] = shade >= LightsMax ? 0 : static_cast<uint8_t>((i % 256) * (LightsMax - shade) / LightsMax);
+	}
+	LightTableIndex = lightTableIndex;
+}
+
+/** @brief An 8-bit surface the size of the default game resolution */
+inline SDLSurfaceUniquePtr CreateBenchmarkSurface()
+{
+	return SDLWrap::CreateRGBSurfaceWithFormat(0, 640, 480, 8, SDL_PIXELFORMAT_INDEX8);
+}
+
+} // namespace devilution
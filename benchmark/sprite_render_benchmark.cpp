@@ -0,0 +1,168 @@
+#include <benchmark/benchmark.h>
+
+#include <cstring>
+#include <vector>
+
+#include "engine/cel_sprite.hpp"
+#include "engine/render/cel_render.hpp"
+#include "engine/render/cl2_render.hpp"
+#include "options.h"
+#include "render_benchmark.hpp"
+
+using namespace devilution;
+
+namespace {
+
+constexpr int SpriteWidth = 96;
+constexpr int SpriteHeight = 128;
+constexpr int RunLength = 24;
+
+void AppendLE32(std::vector<byte> &data, uint32_t value)
+{
+	value = SDL_SwapLE32(value);
+	const auto *bytes = reinterpret_cast<const byte *>(&value);
+	data.insert(data.end(), bytes, bytes + sizeof(value));
+}
+
+/** @brief Wraps the pixel data of a single frame in a sprite file with the frame header used by the clipped draw functions */
+CelSprite MakeSprite(const std::vector<byte> &pixels)
+{
+	constexpr uint16_t HeaderSize = 10;
+	std::vector<byte> data;
+	AppendLE32(data, 1);
+	AppendLE32(data, 12);
+	AppendLE32(data, 12 + HeaderSize + pixels.size());
+	data.push_back(static_cast<byte>(HeaderSize));
+	data.resize(data.size() + HeaderSize - 1);
+	data.insert(data.end(), pixels.begin(), pixels.end());
+
+	auto owned = std::make_unique<byte[]>(data.size());
+	memcpy(owned.get(), data.data(), data.size());
+	return CelSprite(std::move(owned), SpriteWidth);
+}
+
+/** @brief Rows of alternating opaque and transparent runs */
+CelSprite MakeCelSprite()
+{
+	std::vector<byte> pixels;
+	for (int y = 0; y < SpriteHeight; y++) {
+		for (int x = 0; x < SpriteWidth; x += 2 * RunLength) {
+			pixels.push_back(static_cast<byte>(RunLength));
+			for (int i = 0; i < RunLength; i++)
+				pixels.push_back(static_cast<byte>(x + i + y));
+			pixels.push_back(static_cast<byte>(-RunLength));
+		}
+	}
+	return MakeSprite(pixels);
+}
+
+/** @brief Rows of an opaque run, a transparent run, a fill run and another transparent run */
+CelSprite MakeCl2Sprite()
+{
+	std::vector<byte> pixels;
+	for (int y = 0; y < SpriteHeight; y++) {
+		for (int x = 0; x < SpriteWidth; x += 4 * RunLength) {
+			pixels.push_back(static_cast<byte>(-RunLength));
+			for (int i = 0; i < RunLength; i++)
+				pixels.push_back(static_cast<byte>(x + i + y));
+			pixels.push_back(static_cast<byte>(RunLength));
+			pixels.push_back(static_cast<byte>(0xBF - RunLength));
+			pixels.push_back(static_cast<byte>(y));
+			pixels.push_back(static_cast<byte>(RunLength));
+		}
+	}
+	return MakeSprite(pixels);
+}
+
+/** @brief Bottom left corner of the sprite, the clipped sprite sticks out of the left and bottom of the surface */
+Point SpritePosition(bool clipped)
+{
+	return clipped ? Point { -SpriteWidth / 2, 480 + SpriteHeight / 4 } : Point { 200, 300 };
+}
+
+/**
+ * Arguments: light table index, clipped
+ */
+void BM_CelDrawLight(benchmark::State &state)
+{
+	InitBenchmarkLighting(static_cast<int>(state.range(0)));
+	const CelSprite sprite = MakeCelSprite();
+	SDLSurfaceUniquePtr surface = CreateBenchmarkSurface();
+	const Surface out(surface.get());
+	const Point position = SpritePosition(state.range(1) != 0);
+
+	for (auto _ : state) {
+		CelClippedDrawLightTo(out, position, sprite, 1);
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * SpriteWidth * SpriteHeight);
+}
+
+BENCHMARK(BM_CelDrawLight)
+    ->ArgNames({ "light", "clipped" })
+    ->ArgsProduct({ { 0, 8 }, { 0, 1 } });
+
+/**
+ * Arguments: blended, clipped
+ */
+void BM_CelBlitLightTrans(benchmark::State &state)
+{
+	InitBenchmarkLighting(8);
+	cel_transparency_active = true;
+	sgOptions.Graphics.bBlendedTransparancy = state.range(0) != 0;
+	const CelSprite sprite = MakeCelSprite();
+	SDLSurfaceUniquePtr surface = CreateBenchmarkSurface();
+	const Surface out(surface.get());
+	const Point position = SpritePosition(state.range(1) != 0);
+
+	for (auto _ : state) {
+		CelClippedBlitLightTransTo(out, position, sprite, 1);
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * SpriteWidth * SpriteHeight);
+	cel_transparency_active = false;
+}
+
+BENCHMARK(BM_CelBlitLightTrans)
+    ->ArgNames({ "blended", "clipped" })
+    ->ArgsProduct({ { 0, 1 }, { 0, 1 } });
+
+/**
+ * Arguments: light table index, clipped
+ */
+void BM_Cl2DrawLight(benchmark::State &state)
+{
+	InitBenchmarkLighting(static_cast<int>(state.range(0)));
+	const CelSprite sprite = MakeCl2Sprite();
+	SDLSurfaceUniquePtr surface = CreateBenchmarkSurface();
+	const Surface out(surface.get());
+	const Point position = SpritePosition(state.range(1) != 0);
+
+	for (auto _ : state) {
+		Cl2DrawLight(out, position.x, position.y, sprite, 1);
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * SpriteWidth * SpriteHeight);
+}
+
+BENCHMARK(BM_Cl2DrawLight)
+    ->ArgNames({ "light", "clipped" })
+    ->ArgsProduct({ { 0, 8 }, { 0, 1 } });
+
+void BM_Cl2DrawOutline(benchmark::State &state)
+{
+	const CelSprite sprite = MakeCl2Sprite();
+	SDLSurfaceUniquePtr surface = CreateBenchmarkSurface();
+	const Surface out(surface.get());
+	const Point position = SpritePosition(state.range(0) != 0);
+
+	for (auto _ : state) {
+		Cl2DrawOutline(out, 1, position.x, position.y, sprite, 1);
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * SpriteWidth * SpriteHeight);
+}
+
+BENCHMARK(BM_Cl2DrawOutline)->ArgName("clipped")->DenseRange(0, 1);
+
+} // namespace
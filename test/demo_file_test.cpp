@@ -0,0 +1,396 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#include "engine/demo_file.hpp"
+
+using namespace devilution;
+using namespace devilution::demo;
+
+namespace {
+
+DemoMsg MakeTick(DemoMsgType type, float progress)
+{
+	DemoMsg msg {};
+	msg.type = type;
+	msg.progressToNextGameTick = progress;
+	return msg;
+}
+
+DemoMsg MakeMessage(uint32_t message, int32_t wParam, int32_t lParam, float progress)
+{
+	DemoMsg msg = MakeTick(DemoMsgType::Message, progress);
+	msg.message = message;
+	msg.wParam = wParam;
+	msg.lParam = lParam;
+	return msg;
+}
+
+void ExpectEqual(const DemoMsg &expected, const DemoMsg *actual)
+{
+	ASSERT_NE(actual, nullptr);
+	EXPECT_EQ(actual->type, expected.type);
+	EXPECT_EQ(actual->message, expected.message);
+	EXPECT_EQ(actual->wParam, expected.wParam);
+	EXPECT_EQ(actual->lParam, expected.lParam);
+	EXPECT_FLOAT_EQ(actual->progressToNextGameTick, expected.progressToNextGameTick);
+}
+
+std::vector<DemoMsg> MakeRecording(int ticks)
+{
+	std::vector<DemoMsg> recording;
+	for (int i = 0; i < ticks; i++) {
+		if (i % 7 == 0)
+			recording.push_back(MakeMessage(0x0200, i % 3, ((i % 480) << 16) | (i % 640), 0.25F));
+		if (i % 50 == 0)
+			recording.push_back(MakeMessage(0x0100, -i, -1, 0.5F));
+		recording.push_back(MakeTick(DemoMsgType::Rendering, 0.5F));
+		recording.push_back(MakeTick(DemoMsgType::GameTick, 1.0F));
+	}
+	return recording;
+}
+
+/**
+ * @brief Stands in for the game during playback
+ *
+ * Messages queue commands that the next game tick carries out, like the commands sent through the loopback network.
+ * A keyframe only holds the state, as a save game doesn't hold the queued commands either.
+ */
+struct ToyGame {
+	uint32_t state = 1;
+	std::vector<int32_t> commands;
+
+	void Play(const DemoMsg &msg)
+	{
+		if (msg.type == DemoMsgType::Message)
+			commands.push_back(msg.wParam);
+		if (msg.type != DemoMsgType::GameTick)
+			return;
+		for (int32_t command : commands)
+			state = state * 31 + static_cast<uint32_t>(command);
+		commands.clear();
+		state = state * 1103515245 + 12345;
+	}
+
+	std::vector<byte> Save() const
+	{
+		std::vector<byte> data(sizeof(state));
+		memcpy(data.data(), &state, sizeof(state));
+		return data;
+	}
+
+	void Load(const std::vector<byte> &data)
+	{
+		memcpy(&state, data.data(), sizeof(state));
+		commands.clear();
+	}
+};
+
+void PlayUntil(DemoReader &reader, ToyGame &game, uint32_t &ticks, uint32_t lastTick)
+{
+	while (ticks < lastTick) {
+		const DemoMsg *msg = reader.Peek();
+		ASSERT_NE(msg, nullptr);
+		game.Play(*msg);
+		if (msg->type == DemoMsgType::GameTick)
+			ticks++;
+		reader.Pop();
+	}
+}
+
+/** @brief Overwrites part of a block, starting at the given offset from the start of the block header */
+void PatchBlock(const char *path, const DemoBlockInfo &block, uint32_t offset, const std::vector<uint8_t> &bytes)
+{
+	std::fstream demo(path, std::ios::in | std::ios::out | std::ios::binary);
+	demo.seekp(block.offset + offset);
+	demo.write(reinterpret_cast<const char *>(bytes.data()), bytes.size());
+}
+
+/** Offsets within the block header of a demo file */
+constexpr uint32_t BlockRawSizeOffset = 5;
+constexpr uint32_t BlockDataOffset = 13;
+
+void RoundTrip(bool compress)
+{
+	const char *path = "Test_DemoFile_RoundTrip.dmo";
+	const std::vector<DemoMsg> recording = MakeRecording(20000);
+
+	DemoWriter writer;
+	ASSERT_TRUE(writer.Open(path, { DemoFileVersion, 3, 800, 600 }, compress));
+	for (const DemoMsg &msg : recording)
+		writer.Write(msg);
+	writer.Close();
+
+	DemoReader reader;
+	ASSERT_TRUE(reader.Open(path));
+	EXPECT_EQ(reader.Header().version, DemoFileVersion);
+	EXPECT_EQ(reader.Header().saveNumber, 3);
+	EXPECT_EQ(reader.Header().width, 800);
+	EXPECT_EQ(reader.Header().height, 600);
+	ASSERT_GT(reader.Blocks().size(), 1);
+	EXPECT_EQ(reader.Blocks()[0].firstTick, 0);
+
+	for (const DemoMsg &msg : recording) {
+		ExpectEqual(msg, reader.Peek());
+		reader.Pop();
+	}
+	EXPECT_EQ(reader.Peek(), nullptr);
+
+	// Seeking to a block continues with the record following its first tick
+	const DemoBlockInfo &block = reader.Blocks()[1];
+	ASSERT_TRUE(reader.SeekToBlock(1));
+	uint32_t ticks = 0;
+	size_t i = 0;
+	while (ticks < block.firstTick) {
+		if (recording[i].type == DemoMsgType::GameTick)
+			ticks++;
+		i++;
+	}
+	ExpectEqual(recording[i], reader.Peek());
+
+	reader.Close();
+	std::remove(path);
+}
+
+} // namespace
+
+TEST(DemoFile, RoundTrip)
+{
+	RoundTrip(true);
+}
+
+TEST(DemoFile, RoundTripUncompressed)
+{
+	RoundTrip(false);
+}
+
+TEST(DemoFile, Keyframes)
+{
+	const char *path = "Test_DemoFile_Keyframes.dmo";
+	const std::vector<DemoMsg> recording = MakeRecording(300);
+
+	DemoKeyframe keyframe;
+	keyframe.gameData.assign(1000, static_cast<byte>(7));
+	keyframe.levels.push_back({ "templ01", std::vector<byte>(500, static_cast<byte>(3)) });
+	keyframe.levels.push_back({ "temps02", std::vector<byte>(20, static_cast<byte>(9)) });
+
+	DemoWriter writer;
+	ASSERT_TRUE(writer.Open(path, { DemoFileVersion, 0, 640, 480 }));
+	for (const DemoMsg &msg : recording) {
+		if (writer.KeyframeDue(100)) {
+			keyframe.rngState = writer.Tick();
+			writer.WriteKeyframe(keyframe);
+			EXPECT_FALSE(writer.KeyframeDue(100));
+		}
+		writer.Write(msg);
+	}
+	writer.Close();
+
+	DemoReader reader;
+	ASSERT_TRUE(reader.Open(path));
+
+	// Keyframes are skipped during normal playback
+	for (const DemoMsg &msg : recording) {
+		ExpectEqual(msg, reader.Peek());
+		reader.Pop();
+	}
+	EXPECT_EQ(reader.Peek(), nullptr);
+
+	EXPECT_EQ(reader.FindKeyframe(99), -1);
+	const int index = reader.FindKeyframe(250);
+	ASSERT_NE(index, -1);
+	EXPECT_EQ(reader.Blocks()[index].kind, DemoBlockKind::Keyframe);
+	EXPECT_EQ(reader.Blocks()[index].firstTick, 200);
+
+	DemoKeyframe loaded;
+	ASSERT_TRUE(reader.ReadKeyframe(index, loaded));
+	EXPECT_EQ(loaded.rngState, 200);
+	EXPECT_EQ(loaded.gameData, keyframe.gameData);
+	ASSERT_EQ(loaded.levels.size(), 2);
+	EXPECT_EQ(loaded.levels[0].name, "templ01");
+	EXPECT_EQ(loaded.levels[0].data, keyframe.levels[0].data);
+	EXPECT_EQ(loaded.levels[1].name, "temps02");
+	EXPECT_EQ(loaded.levels[1].data, keyframe.levels[1].data);
+
+	// Playback resumes with the messages leading up to the game tick the keyframe was taken before
+	ASSERT_TRUE(reader.SeekToBlock(index + 1));
+	uint32_t ticks = 0;
+	size_t i = 0;
+	while (ticks < 200) {
+		if (recording[i].type == DemoMsgType::GameTick)
+			ticks++;
+		i++;
+	}
+	ASSERT_EQ(recording[i].type, DemoMsgType::Message);
+	for (; i < recording.size(); i++) {
+		ExpectEqual(recording[i], reader.Peek());
+		reader.Pop();
+	}
+	EXPECT_EQ(reader.Peek(), nullptr);
+
+	reader.Close();
+	std::remove(path);
+}
+
+TEST(DemoFile, SeekMatchesStraightPlayback)
+{
+	const char *path = "Test_DemoFile_SeekMatchesStraightPlayback.dmo";
+	const std::vector<DemoMsg> recording = MakeRecording(1000);
+
+	// Recorded the way RunGameLoop does, asking for a keyframe before the messages of every loop iteration
+	ToyGame game;
+	DemoWriter writer;
+	ASSERT_TRUE(writer.Open(path, { DemoFileVersion, 0, 640, 480 }));
+	for (const DemoMsg &msg : recording) {
+		if (writer.KeyframeDue(100)) {
+			DemoKeyframe keyframe;
+			keyframe.gameData = game.Save();
+			writer.WriteKeyframe(keyframe);
+		}
+		writer.Write(msg);
+		game.Play(msg);
+	}
+	writer.Close();
+
+	DemoReader reader;
+	ASSERT_TRUE(reader.Open(path));
+	ToyGame straight;
+	uint32_t ticks = 0;
+	PlayUntil(reader, straight, ticks, 750);
+
+	const int index = reader.FindKeyframe(750);
+	ASSERT_NE(index, -1);
+	DemoKeyframe keyframe;
+	ASSERT_TRUE(reader.ReadKeyframe(index, keyframe));
+	ToyGame seeked;
+	seeked.Load(keyframe.gameData);
+	ASSERT_TRUE(reader.SeekToBlock(index + 1));
+	ticks = reader.Blocks()[index].firstTick;
+	EXPECT_EQ(ticks, 700);
+	PlayUntil(reader, seeked, ticks, 750);
+
+	EXPECT_EQ(seeked.state, straight.state);
+
+	reader.Close();
+	std::remove(path);
+}
+
+TEST(DemoFile, CorruptBlockEndsPlayback)
+{
+	const char *path = "Test_DemoFile_CorruptBlockEndsPlayback.dmo";
+	const std::vector<DemoMsg> recording = MakeRecording(20000);
+
+	DemoWriter writer;
+	ASSERT_TRUE(writer.Open(path, { DemoFileVersion, 0, 640, 480 }));
+	for (const DemoMsg &msg : recording)
+		writer.Write(msg);
+	writer.Close();
+
+	std::vector<DemoBlockInfo> blocks;
+	{
+		DemoReader reader;
+		ASSERT_TRUE(reader.Open(path));
+		blocks = reader.Blocks();
+	}
+	ASSERT_GT(blocks.size(), 3);
+	// An invalid dictionary size in the compressed data of the second block
+	PatchBlock(path, blocks[1], BlockDataOffset + 1, { 0xFF });
+
+	DemoReader reader;
+	ASSERT_TRUE(reader.Open(path));
+	size_t played = 0;
+	while (reader.Peek() != nullptr) {
+		ExpectEqual(recording[played], reader.Peek());
+		reader.Pop();
+		played++;
+	}
+	EXPECT_GT(played, 0);
+	EXPECT_LT(played, recording.size());
+	// The blocks after it are still there, but can only be reached by seeking
+	EXPECT_FALSE(reader.SeekToBlock(1));
+	EXPECT_EQ(reader.Peek(), nullptr);
+	EXPECT_TRUE(reader.SeekToBlock(2));
+	EXPECT_NE(reader.Peek(), nullptr);
+
+	reader.Close();
+	std::remove(path);
+}
+
+TEST(DemoFile, CorruptKeyframeIsRejected)
+{
+	const char *path = "Test_DemoFile_CorruptKeyframeIsRejected.dmo";
+
+	DemoKeyframe keyframe;
+	keyframe.gameData.assign(1000, static_cast<byte>(7));
+	DemoWriter writer;
+	ASSERT_TRUE(writer.Open(path, { DemoFileVersion, 0, 640, 480 }));
+	writer.WriteKeyframe(keyframe);
+	writer.Write(MakeTick(DemoMsgType::GameTick, 1.0F));
+	writer.Close();
+
+	int index;
+	DemoBlockInfo block;
+	{
+		DemoReader reader;
+		ASSERT_TRUE(reader.Open(path));
+		index = reader.FindKeyframe(0);
+		ASSERT_NE(index, -1);
+		block = reader.Blocks()[index];
+	}
+	// The compressed data expands to more than the header announces
+	PatchBlock(path, block, BlockRawSizeOffset, { 0xF0, 0, 0, 0 });
+
+	DemoReader reader;
+	ASSERT_TRUE(reader.Open(path));
+	DemoKeyframe loaded;
+	EXPECT_FALSE(reader.ReadKeyframe(index, loaded));
+
+	reader.Close();
+	std::remove(path);
+}
+
+TEST(DemoFile, ReadTextDemo)
+{
+	const char *path = "Test_DemoFile_ReadTextDemo.dmo";
+	{
+		std::ofstream demo(path, std::ios::out | std::ios::trunc);
+		demo << "0,2,640,480\n";
+		demo << "1,0.5\n";
+		demo << "2,0.75,512,1,1966160\n";
+		demo << "0,1\n";
+	}
+
+	DemoReader reader;
+	ASSERT_TRUE(reader.Open(path));
+	EXPECT_EQ(reader.Header().version, 0);
+	EXPECT_EQ(reader.Header().saveNumber, 2);
+	EXPECT_EQ(reader.Header().width, 640);
+	EXPECT_EQ(reader.Header().height, 480);
+
+	ExpectEqual(MakeTick(DemoMsgType::Rendering, 0.5F), reader.Peek());
+	reader.Pop();
+	ExpectEqual(MakeMessage(512, 1, 1966160, 0.75F), reader.Peek());
+	reader.Pop();
+	ExpectEqual(MakeTick(DemoMsgType::GameTick, 1.0F), reader.Peek());
+	reader.Pop();
+	EXPECT_EQ(reader.Peek(), nullptr);
+
+	reader.Close();
+	std::remove(path);
+}
+
+TEST(DemoFile, RejectsUnknownFile)
+{
+	const char *path = "Test_DemoFile_RejectsUnknownFile.dmo";
+	{
+		std::ofstream demo(path, std::ios::out | std::ios::trunc | std::ios::binary);
+		demo << "not a demo";
+	}
+
+	DemoReader reader;
+	EXPECT_FALSE(reader.Open(path));
+	EXPECT_FALSE(reader.IsOpen());
+	std::remove(path);
+}
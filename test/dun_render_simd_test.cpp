@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <random>
+
+#include "engine/render/dun_render_simd.hpp"
+
+using namespace devilution;
+
+namespace {
+
+using Row = std::array<uint8_t, 32>;
+
+constexpr std::array<SimdLevel, 3> VectorLevels { SimdLevel::SSE2, SimdLevel::AVX2, SimdLevel::NEON };
+
+std::array<uint8_t, 256> MakeTable()
+{
+	std::array<uint8_t, 256> table;
+	for (size_t i = 0; i < table.size(); i++)
+		table[i] = static_cast<uint8_t>(255 - i);
+	return table;
+}
+
+Row RandomRow(std::mt19937 &rng)
+{
+	Row row;
+	for (uint8_t &pixel : row)
+		pixel = static_cast<uint8_t>(rng());
+	return row;
+}
+
+} // namespace
+
+TEST(DunRenderSimd, KernelsMatchScalar)
+{
+	const TileRowKernels &scalar = GetTileRowKernels(SimdLevel::Scalar);
+	const std::array<uint8_t, 256> table = MakeTable();
+
+	for (SimdLevel level : VectorLevels) {
+		if (!IsSimdLevelSupported(level))
+			continue;
+		const TileRowKernels &kernels = GetTileRowKernels(level);
+
+		std::mt19937 rng(42);
+		std::vector<uint32_t> masks { 0x00000000, 0xFFFFFFFF, 0xAAAAAAAA, 0x55555555, 0xFFFF0000, 0x0000FFFF, 0x80000001 };
+		for (int i = 0; i < 100; i++)
+			masks.push_back(static_cast<uint32_t>(rng()));
+
+		for (uint32_t mask : masks) {
+			const Row src = RandomRow(rng);
+			const Row dst = RandomRow(rng);
+
+			Row expected = dst;
+			Row actual = dst;
+			scalar.copyMasked(expected.data(), src.data(), mask);
+			kernels.copyMasked(actual.data(), src.data(), mask);
+			EXPECT_EQ(actual, expected) << SimdLevelName(level) << " copyMasked " << std::hex << mask;
+
+			expected = dst;
+			actual = dst;
+			scalar.fillMasked(expected.data(), 7, mask);
+			kernels.fillMasked(actual.data(), 7, mask);
+			EXPECT_EQ(actual, expected) << SimdLevelName(level) << " fillMasked " << std::hex << mask;
+
+			expected = dst;
+			actual = dst;
+			scalar.lookupMasked(expected.data(), src.data(), table.data(), mask);
+			kernels.lookupMasked(actual.data(), src.data(), table.data(), mask);
+			EXPECT_EQ(actual, expected) << SimdLevelName(level) << " lookupMasked " << std::hex << mask;
+		}
+	}
+}
+
+TEST(DunRenderSimd, MinBlendMatchesScalar)
+{
+	const MinBlendKernel scalar = GetMinBlendKernel(SimdLevel::Scalar);
+
+	for (SimdLevel level : VectorLevels) {
+		if (!IsSimdLevelSupported(level))
+			continue;
+		const MinBlendKernel kernel = GetMinBlendKernel(level);
+
+		std::mt19937 rng(42);
+		for (int count = 0; count <= 32; count++) {
+			const Row src = RandomRow(rng);
+			const Row dst = RandomRow(rng);
+
+			Row expected = dst;
+			Row actual = dst;
+			scalar(expected.data(), src.data(), count);
+			kernel(actual.data(), src.data(), count);
+			EXPECT_EQ(actual, expected) << SimdLevelName(level) << " minBlend " << count;
+		}
+	}
+}
+
+TEST(DunRenderSimd, LookupCoversWholeTable)
+{
+	const std::array<uint8_t, 256> table = MakeTable();
+
+	for (SimdLevel level : VectorLevels) {
+		if (!IsSimdLevelSupported(level))
+			continue;
+		const TileRowKernels &kernels = GetTileRowKernels(level);
+		if (kernels.lookup == nullptr)
+			continue;
+
+		for (int first = 0; first < 256; first += 32) {
+			Row src;
+			for (size_t i = 0; i < src.size(); i++)
+				src[i] = static_cast<uint8_t>(first + i);
+			Row dst {};
+			kernels.lookup(dst.data(), src.data(), table.data());
+			for (size_t i = 0; i < dst.size(); i++)
+				EXPECT_EQ(dst[i], table[src[i]]) << SimdLevelName(level) << " index " << (first + i);
+		}
+	}
+}
@@ -0,0 +1,195 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "dvlnet/base.h"
+
+using namespace devilution;
+using namespace devilution::net;
+
+namespace {
+
+/**
+ * @brief A player whose packets are collected instead of being sent over the network
+ */
+class TestNet : public base {
+public:
+	explicit TestNet(plr_t self)
+	{
+		plr_self = self;
+		connected_table[self] = true;
+		setup_password("");
+	}
+
+	int create(std::string /*addrstr*/, std::string /*passwd*/) override
+	{
+		return plr_self;
+	}
+
+	int join(std::string /*addrstr*/, std::string /*passwd*/) override
+	{
+		return plr_self;
+	}
+
+	void poll() override
+	{
+	}
+
+	void send(packet &pkt) override
+	{
+		sent.push_back(pkt.Data());
+		destinations.push_back(pkt.Destination());
+	}
+
+	std::string make_default_gamename() override
+	{
+		return "";
+	}
+
+	void Deliver(const buffer_t &data)
+	{
+		auto pkt = pktfty->make_packet(data);
+		RecvLocal(*pkt);
+	}
+
+	std::vector<buffer_t> sent;
+	std::vector<plr_t> destinations;
+};
+
+void SendMessage(TestNet &net, int playerId, const std::string &message)
+{
+	ASSERT_TRUE(net.SNetSendMessage(playerId, const_cast<char *>(message.data()), message.size()));
+}
+
+std::string ReceiveMessage(TestNet &net, int expectedSender)
+{
+	int sender;
+	void *data;
+	uint32_t size;
+	if (!net.SNetReceiveMessage(&sender, &data, &size))
+		return "";
+	EXPECT_EQ(sender, expectedSender);
+	return std::string(static_cast<char *>(data), size);
+}
+
+} // namespace
+
+TEST(DvlnetBase, MessagesAndTurnOfATickShareAPacket)
+{
+	TestNet sender(0);
+	TestNet receiver(1);
+
+	SendMessage(sender, SNPLAYER_OTHERS, "first");
+	SendMessage(sender, SNPLAYER_OTHERS, "second");
+	uint32_t turn = 0x12345678;
+	ASSERT_TRUE(sender.SNetSendTurn(reinterpret_cast<char *>(&turn), sizeof(turn)));
+	SendMessage(sender, SNPLAYER_OTHERS, "third");
+	EXPECT_TRUE(sender.sent.empty());
+
+	ASSERT_TRUE(sender.SNetFlush());
+	ASSERT_EQ(sender.sent.size(), 1);
+	EXPECT_EQ(sender.destinations[0], PLR_BROADCAST);
+	ASSERT_TRUE(sender.SNetFlush());
+	EXPECT_EQ(sender.sent.size(), 1);
+
+	receiver.Deliver(sender.sent[0]);
+	EXPECT_EQ(ReceiveMessage(receiver, 0), "first");
+	EXPECT_EQ(ReceiveMessage(receiver, 0), "second");
+	EXPECT_EQ(ReceiveMessage(receiver, 0), "third");
+	EXPECT_EQ(ReceiveMessage(receiver, 0), "");
+
+	uint32_t ownTurn = 1;
+	ASSERT_TRUE(receiver.SNetSendTurn(reinterpret_cast<char *>(&ownTurn), sizeof(ownTurn)));
+	char *turns[MAX_PLRS];
+	size_t sizes[MAX_PLRS];
+	uint32_t status[MAX_PLRS];
+	ASSERT_TRUE(receiver.SNetReceiveTurns(turns, sizes, status));
+	ASSERT_EQ(sizes[0], sizeof(turn));
+	uint32_t receivedTurn;
+	memcpy(&receivedTurn, turns[0], sizeof(receivedTurn));
+	EXPECT_EQ(receivedTurn, turn);
+}
+
+TEST(DvlnetBase, MessagesKeepTheirOrderAcrossDestinations)
+{
+	TestNet sender(0);
+	TestNet receiver(1);
+
+	SendMessage(sender, 1, "a");
+	SendMessage(sender, 1, "b");
+	SendMessage(sender, SNPLAYER_ALL, "c");
+	SendMessage(sender, 2, "not for 1");
+	SendMessage(sender, 1, "d");
+	ASSERT_TRUE(sender.SNetFlush());
+
+	ASSERT_EQ(sender.sent.size(), 4);
+	EXPECT_EQ(sender.destinations, (std::vector<plr_t> { 1, PLR_BROADCAST, 2, 1 }));
+	EXPECT_EQ(ReceiveMessage(sender, 0), "c");
+
+	for (size_t i = 0; i < sender.sent.size(); i++) {
+		if (sender.destinations[i] == 1 || sender.destinations[i] == PLR_BROADCAST)
+			receiver.Deliver(sender.sent[i]);
+	}
+	EXPECT_EQ(ReceiveMessage(receiver, 0), "a");
+	EXPECT_EQ(ReceiveMessage(receiver, 0), "b");
+	EXPECT_EQ(ReceiveMessage(receiver, 0), "c");
+	EXPECT_EQ(ReceiveMessage(receiver, 0), "d");
+	EXPECT_EQ(ReceiveMessage(receiver, 0), "");
+}
+
+TEST(DvlnetBase, LargeBundlesAreSplit)
+{
+	TestNet sender(0);
+	TestNet receiver(1);
+
+	const std::string message(500, 'x');
+	for (int i = 0; i < 200; i++)
+		SendMessage(sender, SNPLAYER_OTHERS, message);
+	ASSERT_TRUE(sender.SNetFlush());
+	EXPECT_GT(sender.sent.size(), 1);
+
+	for (const buffer_t &data : sender.sent) {
+		EXPECT_LT(data.size(), packet_factory::max_packet_size);
+		receiver.Deliver(data);
+	}
+	int received = 0;
+	while (ReceiveMessage(receiver, 0) == message)
+		received++;
+	EXPECT_EQ(received, 200);
+}
+
+TEST(DvlnetBase, CountsTrafficAndRoundTripTime)
+{
+	TestNet host(0);
+	TestNet guest(1);
+
+	uint32_t turn = 1;
+	ASSERT_TRUE(host.SNetSendTurn(reinterpret_cast<char *>(&turn), sizeof(turn)));
+	ASSERT_TRUE(host.SNetFlush());
+	ASSERT_EQ(host.sent.size(), 1);
+	guest.Deliver(host.sent[0]);
+
+	ASSERT_TRUE(guest.SNetSendTurn(reinterpret_cast<char *>(&turn), sizeof(turn)));
+	ASSERT_TRUE(guest.SNetFlush());
+	ASSERT_EQ(guest.sent.size(), 1);
+	host.Deliver(guest.sent[0]);
+
+	NetStats hostStats;
+	ASSERT_TRUE(host.SNetGetNetStats(&hostStats));
+	EXPECT_FALSE(hostStats.peers[0].connected);
+	EXPECT_TRUE(hostStats.peers[1].connected);
+	EXPECT_EQ(hostStats.peers[1].packetsReceived, 1);
+	EXPECT_EQ(hostStats.peers[1].bytesReceived, guest.sent[0].size());
+	EXPECT_EQ(hostStats.peers[1].turnsQueued, 1);
+	EXPECT_LT(hostStats.peers[1].roundTripTime, 1000);
+
+	NetStats guestStats;
+	ASSERT_TRUE(guest.SNetGetNetStats(&guestStats));
+	EXPECT_TRUE(guestStats.peers[0].connected);
+	EXPECT_EQ(guestStats.peers[0].packetsSent, 1);
+	EXPECT_EQ(guestStats.peers[0].bytesSent, guest.sent[0].size());
+	EXPECT_EQ(guestStats.peers[0].packetsReceived, 1);
+	EXPECT_EQ(guestStats.decryptFailures, 0);
+}
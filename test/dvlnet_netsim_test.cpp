@@ -0,0 +1,158 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "dvlnet/base.h"
+#include "dvlnet/netsim.h"
+
+using namespace devilution;
+using namespace devilution::net;
+
+namespace {
+
+using Clock = link_simulator::clock;
+using std::chrono::milliseconds;
+
+const Clock::time_point Start = Clock::time_point() + std::chrono::hours(1);
+
+/**
+ * @brief A player whose packets are collected when they leave the simulated network
+ */
+class TestNet : public base {
+public:
+	TestNet()
+	{
+		plr_self = 0;
+		connected_table[0] = true;
+		setup_password("");
+	}
+
+	int create(std::string /*addrstr*/, std::string /*passwd*/) override
+	{
+		return plr_self;
+	}
+
+	int join(std::string /*addrstr*/, std::string /*passwd*/) override
+	{
+		return plr_self;
+	}
+
+	void poll() override
+	{
+	}
+
+	void send(packet &pkt) override
+	{
+		sent.push_back(pkt.Data());
+	}
+
+	std::string make_default_gamename() override
+	{
+		return "";
+	}
+
+	std::vector<buffer_t> sent;
+};
+
+/**
+ * @brief A simulated network on which time only passes when the test says so
+ */
+class ManualClockNet : public netsim<TestNet> {
+public:
+	Clock::time_point now = Start;
+
+protected:
+	Clock::time_point Now() const override
+	{
+		return now;
+	}
+};
+
+} // namespace
+
+TEST(LinkSimulator, Latency)
+{
+	net_conditions conditions;
+	conditions.latency = 50;
+	link_simulator link(conditions, 1);
+
+	EXPECT_EQ(link.Schedule(Start, 100), Start + milliseconds(50));
+	EXPECT_EQ(link.Schedule(Start + milliseconds(10), 100), Start + milliseconds(60));
+}
+
+TEST(LinkSimulator, BandwidthQueuesPackets)
+{
+	net_conditions conditions;
+	conditions.latency = 10;
+	conditions.bandwidth = 1000;
+	link_simulator link(conditions, 1);
+
+	// 500 bytes take half a second at 1000 bytes per second, the second packet waits for the first one
+	EXPECT_EQ(link.Schedule(Start, 500), Start + milliseconds(510));
+	EXPECT_EQ(link.Schedule(Start, 500), Start + milliseconds(1010));
+	EXPECT_EQ(link.Schedule(Start + milliseconds(2000), 100), Start + milliseconds(2110));
+}
+
+TEST(LinkSimulator, JitterKeepsOrder)
+{
+	net_conditions conditions;
+	conditions.latency = 20;
+	conditions.jitter = 100;
+	link_simulator link(conditions, 1);
+
+	Clock::time_point previous = Start;
+	for (int i = 0; i < 1000; i++) {
+		const Clock::time_point now = Start + milliseconds(i);
+		const Clock::time_point arrival = link.Schedule(now, 100);
+		EXPECT_GE(arrival, previous);
+		EXPECT_GE(arrival, now + milliseconds(20));
+		EXPECT_LE(arrival, now + milliseconds(120));
+		previous = arrival;
+	}
+}
+
+TEST(LinkSimulator, LostPacketsAreSentAgain)
+{
+	net_conditions conditions;
+	conditions.latency = 30;
+	conditions.loss = 100;
+	link_simulator link(conditions, 1);
+
+	// Every try is lost, until the packet gets through after the last retransmission of 200 ms each
+	EXPECT_EQ(link.Schedule(Start, 100), Start + milliseconds(30 + 5 * 200));
+}
+
+TEST(Netsim, PacketsAreHeldBack)
+{
+	simulated_conditions.latency = 20;
+	ManualClockNet net;
+	simulated_conditions = {};
+
+	uint32_t turn = 1;
+	ASSERT_TRUE(net.SNetSendTurn(reinterpret_cast<char *>(&turn), sizeof(turn)));
+	ASSERT_TRUE(net.SNetFlush());
+	net.poll();
+	EXPECT_TRUE(net.sent.empty());
+
+	net.now += milliseconds(19);
+	net.poll();
+	EXPECT_TRUE(net.sent.empty());
+
+	net.now += milliseconds(1);
+	net.poll();
+	EXPECT_EQ(net.sent.size(), 1);
+}
+
+TEST(Netsim, LeavingSendsEverything)
+{
+	simulated_conditions.latency = 1000;
+	netsim<TestNet> net;
+	simulated_conditions = {};
+
+	uint32_t turn = 1;
+	ASSERT_TRUE(net.SNetSendTurn(reinterpret_cast<char *>(&turn), sizeof(turn)));
+	ASSERT_TRUE(net.SNetFlush());
+	ASSERT_TRUE(net.SNetLeaveGame(0));
+	EXPECT_EQ(net.sent.size(), 2);
+}
@@ -0,0 +1,196 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <thread>
+
+#include <asio/ts/buffer.hpp>
+#include <asio/ts/internet.hpp>
+#include <asio/ts/io_context.hpp>
+#include <asio/ts/net.hpp>
+
+#include "dvlnet/frame_queue.h"
+#include "dvlnet/packet.h"
+#include "dvlnet/tcp_server.h"
+
+using namespace devilution;
+using namespace devilution::net;
+
+namespace {
+
+/**
+ * @brief A player talking to the server over a socket of its own, without a game attached
+ */
+class TestClient {
+public:
+	TestClient(packet_factory &pktfty, unsigned short port)
+	    : pktfty(pktfty)
+	    , socket(ioc)
+	{
+		socket.connect(asio::ip::tcp::endpoint(asio::ip::address_v4::loopback(), port));
+	}
+
+	void Send(packet &pkt)
+	{
+		SendFrame(frame_queue::MakeFrame(pkt.Data()));
+	}
+
+	void SendFrame(const buffer_t &frame)
+	{
+		asio::write(socket, asio::buffer(frame));
+	}
+
+	/**
+	 * @brief Waits for the next packet of the given type, skipping the others
+	 * @return nullptr if the server closed the connection or nothing arrived in time
+	 */
+	std::unique_ptr<packet> Receive(packet_type type)
+	{
+		while (true) {
+			while (queue.PacketReady()) {
+				auto pkt = pktfty.make_packet(queue.ReadPacket());
+				if (pkt->Type() == type)
+					return pkt;
+			}
+			if (!ReadSome())
+				return nullptr;
+		}
+	}
+
+	/**
+	 * @brief Whether the server closes the connection, the packets sent before that are skipped
+	 */
+	bool Closed()
+	{
+		while (!closed && ReadSome()) {
+			while (queue.PacketReady())
+				queue.ReadPacket();
+		}
+		return closed;
+	}
+
+	std::unique_ptr<packet> Join(cookie_t cookie, buffer_t info)
+	{
+		auto request = pktfty.make_packet<PT_JOIN_REQUEST>(PLR_BROADCAST, PLR_MASTER, cookie, std::move(info));
+		Send(*request);
+		return Receive(PT_JOIN_ACCEPT);
+	}
+
+private:
+	packet_factory &pktfty;
+	asio::io_context ioc;
+	asio::ip::tcp::socket socket;
+	frame_queue queue;
+	bool closed = false;
+
+	bool ReadSome()
+	{
+		bool done = false;
+		asio::error_code error;
+		size_t bytesRead = 0;
+		socket.async_read_some(asio::buffer(queue.WriteBuffer(), queue.WriteBufferSize()), [&](const asio::error_code &ec, size_t size) {
+			done = true;
+			error = ec;
+			bytesRead = size;
+		});
+		ioc.restart();
+		ioc.run_for(std::chrono::seconds(5));
+		if (!done) {
+			socket.cancel();
+			ioc.restart();
+			ioc.run();
+			return false;
+		}
+		if (error) {
+			closed = true;
+			return false;
+		}
+		queue.CommitWrite(bytesRead);
+		return true;
+	}
+};
+
+/**
+ * @brief One session of the dedicated server, with the io_context running on a worker thread of its own
+ */
+class TcpServerTest : public ::testing::Test {
+protected:
+	asio::io_context ioc;
+	std::unique_ptr<tcp_server> server;
+	std::thread worker;
+	packet_factory pktfty { "" };
+
+	void SetUp() override
+	{
+		server = std::make_unique<tcp_server>(ioc, "127.0.0.1", 0, "");
+		worker = std::thread([this]() { ioc.run(); });
+	}
+
+	void TearDown() override
+	{
+		ioc.stop();
+		worker.join();
+		server = nullptr;
+	}
+};
+
+const buffer_t GameInfo { 1, 2, 3, 4 };
+
+constexpr plr_t HostPlayer = 0;
+constexpr plr_t GuestPlayer = 1;
+constexpr plr_t FaultyPlayer = 2;
+
+} // namespace
+
+TEST_F(TcpServerTest, RelaysTurns)
+{
+	TestClient host(pktfty, server->Port());
+	auto hostAccept = host.Join(1, GameInfo);
+	ASSERT_NE(hostAccept, nullptr);
+	EXPECT_EQ(hostAccept->NewPlayer(), HostPlayer);
+	EXPECT_EQ(hostAccept->Info(), GameInfo);
+
+	TestClient guest(pktfty, server->Port());
+	auto guestAccept = guest.Join(2, {});
+	ASSERT_NE(guestAccept, nullptr);
+	EXPECT_EQ(guestAccept->NewPlayer(), GuestPlayer);
+	EXPECT_EQ(guestAccept->Cookie(), 2);
+	// The settings of the player that created the game
+	EXPECT_EQ(guestAccept->Info(), GameInfo);
+
+	auto turn = pktfty.make_packet<PT_TURN>(HostPlayer, PLR_BROADCAST, 42);
+	host.Send(*turn);
+	auto relayed = guest.Receive(PT_TURN);
+	ASSERT_NE(relayed, nullptr);
+	EXPECT_EQ(relayed->Source(), HostPlayer);
+	EXPECT_EQ(relayed->Turn(), 42);
+}
+
+TEST_F(TcpServerTest, RefusesGameWithoutSettings)
+{
+	TestClient host(pktfty, server->Port());
+	EXPECT_EQ(host.Join(1, {}), nullptr);
+	EXPECT_TRUE(host.Closed());
+}
+
+TEST_F(TcpServerTest, DropsOnlyFaultyConnection)
+{
+	TestClient host(pktfty, server->Port());
+	ASSERT_NE(host.Join(1, GameInfo), nullptr);
+	TestClient guest(pktfty, server->Port());
+	ASSERT_NE(guest.Join(2, {}), nullptr);
+	TestClient faulty(pktfty, server->Port());
+	ASSERT_NE(faulty.Join(3, {}), nullptr);
+
+	faulty.SendFrame(frame_queue::MakeFrame({ 0xDE, 0xAD }));
+	EXPECT_TRUE(faulty.Closed());
+	auto disconnect = host.Receive(PT_DISCONNECT);
+	ASSERT_NE(disconnect, nullptr);
+	EXPECT_EQ(disconnect->NewPlayer(), FaultyPlayer);
+
+	auto turn = pktfty.make_packet<PT_TURN>(GuestPlayer, PLR_BROADCAST, 7);
+	guest.Send(*turn);
+	auto relayed = host.Receive(PT_TURN);
+	ASSERT_NE(relayed, nullptr);
+	EXPECT_EQ(relayed->Turn(), 7);
+}
@@ -0,0 +1,123 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+
+#include "dvlnet/frame_queue.h"
+
+using namespace devilution::net;
+
+namespace {
+
+buffer_t MakePacket(size_t size, unsigned char seed)
+{
+	buffer_t packet(size);
+	for (size_t i = 0; i < size; i++)
+		packet[i] = static_cast<unsigned char>(seed + i);
+	return packet;
+}
+
+bool Matches(buffer_view view, const buffer_t &packet)
+{
+	return view.size == packet.size() && std::equal(packet.begin(), packet.end(), view.data);
+}
+
+} // namespace
+
+TEST(FrameQueue, FrameSplitAcrossWrites)
+{
+	frame_queue queue;
+	const buffer_t packet = MakePacket(1000, 7);
+	const buffer_t frame = frame_queue::MakeFrame(packet);
+
+	for (size_t i = 0; i < frame.size(); i += 100) {
+		EXPECT_FALSE(queue.PacketReady());
+		queue.Write(frame.data() + i, std::min<size_t>(100, frame.size() - i));
+	}
+	ASSERT_TRUE(queue.PacketReady());
+	EXPECT_TRUE(Matches(queue.ReadPacket(), packet));
+	EXPECT_FALSE(queue.PacketReady());
+}
+
+TEST(FrameQueue, ManyFramesInOneWrite)
+{
+	frame_queue queue;
+	buffer_t frames;
+	for (unsigned char i = 0; i < 50; i++)
+		frame_queue::AppendFrame(frames, MakePacket(1 + i * 13, i));
+	// Keep the start of one more frame back
+	frame_queue::AppendFrame(frames, MakePacket(300, 99));
+	queue.Write(frames.data(), frames.size() - 10);
+
+	for (unsigned char i = 0; i < 50; i++) {
+		ASSERT_TRUE(queue.PacketReady());
+		EXPECT_TRUE(Matches(queue.ReadPacket(), MakePacket(1 + i * 13, i)));
+	}
+	EXPECT_FALSE(queue.PacketReady());
+
+	queue.Write(frames.data() + frames.size() - 10, 10);
+	ASSERT_TRUE(queue.PacketReady());
+	EXPECT_TRUE(Matches(queue.ReadPacket(), MakePacket(300, 99)));
+}
+
+TEST(FrameQueue, ReceiveInPlace)
+{
+	frame_queue queue;
+	const buffer_t packet = MakePacket(frame_queue::max_frame_size, 3);
+	buffer_t stream;
+	for (int i = 0; i < 5; i++)
+		frame_queue::AppendFrame(stream, packet);
+
+	// Chunks that never line up with the frames, like a socket would deliver them
+	size_t received = 0;
+	int packets = 0;
+	while (received < stream.size()) {
+		const size_t size = std::min({ queue.WriteBufferSize(), stream.size() - received, size_t { 40000 } });
+		ASSERT_GT(size, 0);
+		std::copy_n(stream.data() + received, size, queue.WriteBuffer());
+		queue.CommitWrite(size);
+		received += size;
+		while (queue.PacketReady()) {
+			EXPECT_TRUE(Matches(queue.ReadPacket(), packet));
+			packets++;
+		}
+		EXPECT_GE(queue.WriteBufferSize(), sizeof(framesize_t) + frame_queue::max_frame_size);
+	}
+	EXPECT_EQ(packets, 5);
+}
+
+TEST(FrameQueue, InvalidFrameSize)
+{
+	frame_queue queue;
+	const unsigned char emptyFrame[] = { 0, 0, 0, 0 };
+	queue.Write(emptyFrame, sizeof(emptyFrame));
+	EXPECT_THROW(queue.PacketReady(), frame_queue_exception);
+
+	frame_queue other;
+	const unsigned char hugeFrame[] = { 0, 0, 1, 0 };
+	other.Write(hugeFrame, sizeof(hugeFrame));
+	EXPECT_THROW(other.PacketReady(), frame_queue_exception);
+}
+
+TEST(FrameSendQueue, OneWriteAtATime)
+{
+	frame_send_queue queue;
+	EXPECT_FALSE(queue.ReadyToSend());
+	queue.Push(MakePacket(10, 1));
+	queue.Push(MakePacket(20, 2));
+	ASSERT_TRUE(queue.ReadyToSend());
+
+	buffer_t expected;
+	frame_queue::AppendFrame(expected, MakePacket(10, 1));
+	frame_queue::AppendFrame(expected, MakePacket(20, 2));
+	const buffer_t &sending = queue.BeginSend();
+	EXPECT_EQ(sending, expected);
+
+	queue.Push(MakePacket(30, 3));
+	EXPECT_FALSE(queue.ReadyToSend());
+	EXPECT_EQ(sending, expected);
+	queue.EndSend();
+	ASSERT_TRUE(queue.ReadyToSend());
+	EXPECT_EQ(queue.BeginSend(), frame_queue::MakeFrame(MakePacket(30, 3)));
+	queue.EndSend();
+	EXPECT_FALSE(queue.ReadyToSend());
+}
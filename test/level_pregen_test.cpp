@@ -0,0 +1,270 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "diablo.h"
+#include "engine/random.hpp"
+#include "gendung.h"
+#include "level_pregen.h"
+#include "lighting.h"
+#include "multi.h"
+#include "quests.h"
+
+using namespace devilution;
+
+namespace {
+
+/** The levels the stairs lead to from each of the test levels, and how they are entered */
+constexpr int AdjacentOffsets[2] = { -1, 1 };
+constexpr lvl_entry AdjacentEntries[2] = { ENTRY_PREV, ENTRY_MAIN };
+
+dungeon_type TestLevelType(int level)
+{
+	if (level == 0)
+		return DTYPE_TOWN;
+	if (level <= 4 || level >= 21)
+		return DTYPE_CATHEDRAL;
+	if (level <= 8)
+		return DTYPE_CATACOMBS;
+	if (level <= 12 || level >= 17)
+		return DTYPE_CAVES;
+	return DTYPE_HELL;
+}
+
+/**
+ * @brief Sets up a single player game without quests, where every tile is made of its own four pieces
+ */
+class LevelPregenTest : public ::testing::Test {
+protected:
+	void SetUp() override
+	{
+		std::copy(std::begin(glSeedTbl), std::end(glSeedTbl), savedSeeds_);
+		std::copy(std::begin(gnLevelTypeTbl), std::end(gnLevelTypeTbl), savedLevelTypes_);
+		std::copy(std::begin(Quests), std::end(Quests), savedQuests_);
+		savedCurrlevel_ = currlevel;
+		savedLeveltype_ = leveltype;
+		savedIsMultiplayer_ = gbIsMultiplayer;
+
+		SetRndSeed(42);
+		for (int i = 0; i < NUMLEVELS; i++) {
+			glSeedTbl[i] = AdvanceRndSeed();
+			gnLevelTypeTbl[i] = TestLevelType(i);
+		}
+		for (auto &quest : Quests)
+			quest._qactive = QUEST_NOTAVAIL;
+		gbIsMultiplayer = false;
+		DisableLighting = false;
+
+		pMegaTiles = std::make_unique<MegaTile[]>(MAXTILES);
+		for (int i = 0; i < MAXTILES; i++) {
+			pMegaTiles[i].micro1 = static_cast<uint16_t>(4 * i);
+			pMegaTiles[i].micro2 = static_cast<uint16_t>(4 * i + 1);
+			pMegaTiles[i].micro3 = static_cast<uint16_t>(4 * i + 2);
+			pMegaTiles[i].micro4 = static_cast<uint16_t>(4 * i + 3);
+		}
+	}
+
+	void TearDown() override
+	{
+		FreePregeneratedLevels();
+		pMegaTiles = nullptr;
+		std::copy(std::begin(savedSeeds_), std::end(savedSeeds_), glSeedTbl);
+		std::copy(std::begin(savedLevelTypes_), std::end(savedLevelTypes_), gnLevelTypeTbl);
+		std::copy(std::begin(savedQuests_), std::end(savedQuests_), Quests);
+		currlevel = savedCurrlevel_;
+		leveltype = savedLeveltype_;
+		gbIsMultiplayer = savedIsMultiplayer_;
+		DRLG_Init_Globals();
+		memset(dPiece, 0, sizeof(dPiece));
+		memset(dTransVal, 0, sizeof(dTransVal));
+	}
+
+private:
+	uint32_t savedSeeds_[NUMLEVELS];
+	dungeon_type savedLevelTypes_[NUMLEVELS];
+	QuestStruct savedQuests_[MAXQUESTS];
+	BYTE savedCurrlevel_;
+	dungeon_type savedLeveltype_;
+	bool savedIsMultiplayer_;
+};
+
+/**
+ * @brief Lays out the level and fills the grids the generators clear, like a level that has been played on for a while
+ */
+void EnterLevel(int level)
+{
+	currlevel = level;
+	leveltype = gnLevelTypeTbl[level];
+	CreateDungeonLayout(ENTRY_MAIN);
+	for (int x = 0; x < MAXDUNX; x++) {
+		for (int y = 0; y < MAXDUNY; y++) {
+			dPlayer[x][y] = static_cast<int8_t>((x + y) % 5);
+			dMonster[x][y] = static_cast<int16_t>((x * 3 + y) % 7);
+			dDead[x][y] = static_cast<int8_t>((x + 2 * y) % 3);
+			dObject[x][y] = static_cast<EntityIndex>((x * y) % 4);
+			dItem[x][y] = static_cast<EntityIndex>((x + y) % 6);
+			dMissile[x][y] = static_cast<EntityIndex>((x ^ y) % 5);
+			dLight[x][y] = static_cast<char>((x + y) % 16);
+			dFlags[x][y] |= BFLAG_EXPLORED;
+		}
+	}
+	SetRndSeed(1234);
+}
+
+/**
+ * @brief The state the generators leave behind, along with the grids they clear
+ */
+std::vector<uint8_t> CaptureLevel()
+{
+	std::vector<uint8_t> state;
+	auto append = [&state](const auto &data) {
+		const auto *bytes = reinterpret_cast<const uint8_t *>(&data);
+		state.insert(state.end(), bytes, bytes + sizeof(data));
+	};
+	append(dungeon);
+	append(pdungeon);
+	append(dflags);
+	append(dPiece);
+	append(dTransVal);
+	append(dLight);
+	append(dFlags);
+	append(dSpecial);
+	append(dPlayer);
+	append(dMonster);
+	append(dDead);
+	append(dObject);
+	append(dItem);
+	append(dMissile);
+	append(TransVal);
+	append(TransList);
+	append(ViewX);
+	append(ViewY);
+	append(dminx);
+	append(dminy);
+	append(dmaxx);
+	append(dmaxy);
+	append(setpc_x);
+	append(setpc_y);
+	append(setpc_w);
+	append(setpc_h);
+	append(themeCount);
+	append(themeLoc);
+	append(currlevel);
+	const uint32_t rngState = GetLCGEngineState();
+	append(rngState);
+	return state;
+}
+
+TEST_F(LevelPregenTest, PregeneratedLevelMatchesFreshLevel)
+{
+	// Covers each type of level, the catacombs also build on the levels above
+	for (int level : { 2, 6, 7, 10, 14, 18, 22 }) {
+		for (int i = 0; i < 2; i++) {
+			const int adjacent = level + AdjacentOffsets[i];
+
+			FreePregeneratedLevels();
+			EnterLevel(level);
+			currlevel = adjacent;
+			CreateDungeonLayout(AdjacentEntries[i]);
+			const std::vector<uint8_t> expected = CaptureLevel();
+
+			EnterLevel(level);
+			const std::vector<uint8_t> current = CaptureLevel();
+			int generated = 0;
+			while (PregenerateAdjacentLevel())
+				generated++;
+			EXPECT_EQ(generated, 2) << "Both levels next to level " << level << " should be pregenerated";
+			EXPECT_TRUE(CaptureLevel() == current) << "Pregenerating changed level " << level;
+
+			ASSERT_TRUE(IsLevelPregenerated(adjacent, AdjacentEntries[i]));
+			currlevel = adjacent;
+			CreateDungeonLayout(AdjacentEntries[i]);
+			EXPECT_TRUE(CaptureLevel() == expected) << "The pregenerated level " << adjacent << " differs from the one generated on the spot";
+		}
+	}
+}
+
+TEST_F(LevelPregenTest, PregeneratingInSlicesMatchesFreshLevel)
+{
+	for (int level : { 2, 6, 10, 14 }) {
+		FreePregeneratedLevels();
+		EnterLevel(level);
+		currlevel = level + 1;
+		CreateDungeonLayout(ENTRY_MAIN);
+		const std::vector<uint8_t> expected = CaptureLevel();
+
+		EnterLevel(level);
+		int slices = 0;
+		while (!IsLevelPregenerated(level + 1, ENTRY_MAIN)) {
+			// The game goes on between the slices
+			SetRndSeed(slices);
+			dMonster[slices % MAXDUNX][0] = static_cast<int16_t>(slices);
+			const std::vector<uint8_t> current = CaptureLevel();
+			ASSERT_TRUE(PregenerateAdjacentLevel(/*timeLimit=*/0));
+			EXPECT_TRUE(CaptureLevel() == current) << "Pregenerating changed level " << level << " in slice " << slices;
+			slices++;
+		}
+		// Without time to spare the generators stop at every attempt, both levels take at least two slices
+		EXPECT_GE(slices, 4) << "Levels next to level " << level << " weren't generated in slices";
+
+		currlevel = level + 1;
+		CreateDungeonLayout(ENTRY_MAIN);
+		EXPECT_TRUE(CaptureLevel() == expected) << "The pregenerated level " << level + 1 << " differs from the one generated on the spot";
+	}
+}
+
+TEST_F(LevelPregenTest, LayingOutALevelFinishesThePregeneration)
+{
+	EnterLevel(10);
+	currlevel = 9;
+	CreateDungeonLayout(ENTRY_PREV);
+	const std::vector<uint8_t> expected = CaptureLevel();
+
+	EnterLevel(10);
+	ASSERT_TRUE(PregenerateAdjacentLevel(/*timeLimit=*/0));
+	EXPECT_FALSE(IsLevelPregenerated(9, ENTRY_PREV));
+
+	currlevel = 9;
+	CreateDungeonLayout(ENTRY_PREV);
+	EXPECT_TRUE(CaptureLevel() == expected);
+	EXPECT_TRUE(IsLevelPregenerated(9, ENTRY_PREV));
+}
+
+TEST_F(LevelPregenTest, PregeneratedLevelFollowsGameChanges)
+{
+	EnterLevel(6);
+	while (PregenerateAdjacentLevel()) {
+	}
+	EXPECT_TRUE(IsLevelPregenerated(7, ENTRY_MAIN));
+	EXPECT_TRUE(IsLevelPregenerated(5, ENTRY_PREV));
+	EXPECT_FALSE(IsLevelPregenerated(7, ENTRY_TWARPDN));
+	EXPECT_FALSE(PregenerateAdjacentLevel());
+
+	// Level 7 builds on level 6 when the blind quest is missing
+	Quests[Q_BLIND]._qactive = QUEST_INIT;
+	EXPECT_FALSE(IsLevelPregenerated(7, ENTRY_MAIN));
+	EXPECT_TRUE(PregenerateAdjacentLevel());
+	EXPECT_TRUE(PregenerateAdjacentLevel());
+	EXPECT_TRUE(IsLevelPregenerated(7, ENTRY_MAIN));
+
+	// Levels with quest set pieces are generated on the spot
+	Quests[Q_BLIND]._qlevel = 7;
+	FreePregeneratedLevels();
+	EXPECT_TRUE(PregenerateAdjacentLevel());
+	EXPECT_FALSE(PregenerateAdjacentLevel());
+	EXPECT_FALSE(IsLevelPregenerated(7, ENTRY_MAIN));
+
+	// The cathedral tiles aren't loaded on level 5
+	EnterLevel(5);
+	FreePregeneratedLevels();
+	EXPECT_TRUE(PregenerateAdjacentLevel());
+	EXPECT_FALSE(PregenerateAdjacentLevel());
+	EXPECT_FALSE(IsLevelPregenerated(4, ENTRY_PREV));
+	EXPECT_TRUE(IsLevelPregenerated(6, ENTRY_MAIN));
+}
+
+} // namespace
@@ -1,7 +1,18 @@
 #include <gtest/gtest.h>
 
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include "automap.h"
 #include "control.h"
+#include "engine/random.hpp"
+#include "gendung.h"
 #include "lighting.h"
+#include "town.h"
+#include "utils/stdcompat/algorithm.hpp"
 
 using namespace devilution;
 
@@ -36,3 +47,521 @@ TEST(Lighting, CrawlTables)
 		}
 	}
 }
+
+namespace {
+
+/** @brief Lights the whole map from scratch, the way ProcessLightList used to after any light changed */
+void RelightReference(char (&out)[MAXDUNX][MAXDUNY])
+{
+	char current[MAXDUNX][MAXDUNY];
+	memcpy(current, dLight, sizeof(dLight));
+
+	memcpy(dLight, dPreLight, sizeof(dLight));
+	for (int i = 0; i < ActiveLightCount; i++) {
+		int j = ActiveLights[i];
+		DoLighting(Lights[j].position.tile, Lights[j]._lradius, j);
+	}
+
+	memcpy(out, dLight, sizeof(dLight));
+	memcpy(dLight, current, sizeof(dLight));
+}
+
+Point RandomTile()
+{
+	// Include the map edges where the light areas are clipped
+	return { GenerateRnd(MAXDUNX), GenerateRnd(MAXDUNY) };
+}
+
+void TestIncrementalLighting(int level)
+{
+	const uint8_t previousLevel = currlevel;
+	currlevel = level;
+	MakeLightRadiusTables();
+	SetRndSeed(level);
+	for (auto &column : dPreLight) {
+		for (char &light : column)
+			light = static_cast<char>(GenerateRnd(16));
+	}
+	memcpy(dLight, dPreLight, sizeof(dLight));
+	InitLighting();
+
+	std::vector<int> lights;
+	for (int i = 0; i < 20; i++)
+		lights.push_back(AddLight(RandomTile(), GenerateRnd(16)));
+
+	char expected[MAXDUNX][MAXDUNY];
+	for (int tick = 0; tick < 300; tick++) {
+		// Several changes to the same light between two updates happen when a monster walks
+		for (int change = GenerateRnd(6); change > 0; change--) {
+			const int i = GenerateRnd(static_cast<int>(lights.size()));
+			const Point tile = Lights[lights[i]].position.tile;
+			switch (GenerateRnd(6)) {
+			case 0:
+				ChangeLightXY(lights[i], { clamp(tile.x + GenerateRnd(3) - 1, 0, MAXDUNX - 1), clamp(tile.y + GenerateRnd(3) - 1, 0, MAXDUNY - 1) });
+				break;
+			case 1:
+				ChangeLightOffset(lights[i], { GenerateRnd(15) - 7, GenerateRnd(15) - 7 });
+				break;
+			case 2:
+				ChangeLightRadius(lights[i], GenerateRnd(16));
+				break;
+			case 3:
+				ChangeLight(lights[i], RandomTile(), GenerateRnd(16));
+				break;
+			case 4:
+				AddUnLight(lights[i]);
+				lights.erase(lights.begin() + i);
+				lights.push_back(AddLight(RandomTile(), GenerateRnd(16)));
+				break;
+			default:
+				break;
+			}
+		}
+		ProcessLightList();
+
+		RelightReference(expected);
+		EXPECT_EQ(memcmp(dLight, expected, sizeof(dLight)), 0) << "level " << level << ", tick " << tick;
+		if (::testing::Test::HasFailure())
+			break;
+	}
+
+	InitLighting();
+	currlevel = previousLevel;
+}
+
+/** @brief The quadrant walk DoLighting used before it was turned into precomputed stamps */
+class QuadrantLighting {
+public:
+	QuadrantLighting()
+	{
+		for (int j = 0; j < 16; j++) {
+			for (int i = 0; i < 128; i++) {
+				if (i > (j + 1) * 8) {
+					lightradius[j][i] = 15;
+				} else {
+					double fs = (double)15 * i / ((double)8 * (j + 1));
+					lightradius[j][i] = (uint8_t)(fs + 0.5);
+				}
+			}
+		}
+		if (currlevel >= 17) {
+			for (int j = 0; j < 16; j++) {
+				double fa = (sqrt((double)(16 - j))) / 128;
+				fa *= fa;
+				for (int i = 0; i < 128; i++) {
+					lightradius[15 - j][i] = 15 - (uint8_t)(fa * (double)((128 - i) * (128 - i)));
+					if (lightradius[15 - j][i] > 15)
+						lightradius[15 - j][i] = 0;
+					lightradius[15 - j][i] = lightradius[15 - j][i] - (uint8_t)((15 - j) / 2);
+					if (lightradius[15 - j][i] > 15)
+						lightradius[15 - j][i] = 0;
+				}
+			}
+		}
+		for (int j = 0; j < 8; j++) {
+			for (int i = 0; i < 8; i++) {
+				for (int k = 0; k < 16; k++) {
+					for (int l = 0; l < 16; l++) {
+						int a = (8 * l - j);
+						int b = (8 * k - i);
+						lightblock[j * 8 + i][k][l] = static_cast<uint8_t>(sqrt(a * a + b * b));
+					}
+				}
+			}
+		}
+	}
+
+	void Apply(char (&map)[MAXDUNX][MAXDUNY], Point position, int nRadius, Point offset) const
+	{
+		int xoff = offset.x;
+		int yoff = offset.y;
+		if (xoff < 0) {
+			xoff += 8;
+			position -= { 1, 0 };
+		}
+		if (yoff < 0) {
+			yoff += 8;
+			position -= { 0, 1 };
+		}
+		int distX = xoff;
+		int distY = yoff;
+		int lightX = 0;
+		int lightY = 0;
+		int blockX = 0;
+		int blockY = 0;
+
+		const int minX = position.x - 15 < 0 ? position.x + 1 : 15;
+		const int maxX = position.x + 15 > MAXDUNX ? MAXDUNX - position.x : 15;
+		const int minY = position.y - 15 < 0 ? position.y + 1 : 15;
+		const int maxY = position.y + 15 > MAXDUNY ? MAXDUNY - position.y : 15;
+
+		const auto setLight = [&](Point temp, int8_t v) {
+			if (temp.x >= 0 && temp.x < MAXDUNX && temp.y >= 0 && temp.y < MAXDUNY && v < map[temp.x][temp.y])
+				map[temp.x][temp.y] = v;
+		};
+		if (position.x >= 0 && position.x < MAXDUNX && position.y >= 0 && position.y < MAXDUNY) {
+			if (currlevel < 17)
+				map[position.x][position.y] = 0;
+			else
+				setLight(position, lightradius[nRadius][0]);
+		}
+
+		int mult = xoff + 8 * yoff;
+		for (int y = 0; y < minY; y++) {
+			for (int x = 1; x < maxX; x++) {
+				int radiusBlock = lightblock[mult][y][x];
+				if (radiusBlock < 128)
+					setLight(position + Displacement { x, y }, lightradius[nRadius][radiusBlock]);
+			}
+		}
+		RotateRadius(&xoff, &yoff, &distX, &distY, &lightX, &lightY, &blockX, &blockY);
+		mult = xoff + 8 * yoff;
+		for (int y = 0; y < maxY; y++) {
+			for (int x = 1; x < maxX; x++) {
+				int radiusBlock = lightblock[mult][y + blockY][x + blockX];
+				if (radiusBlock < 128)
+					setLight(position + Displacement { y, -x }, lightradius[nRadius][radiusBlock]);
+			}
+		}
+		RotateRadius(&xoff, &yoff, &distX, &distY, &lightX, &lightY, &blockX, &blockY);
+		mult = xoff + 8 * yoff;
+		for (int y = 0; y < maxY; y++) {
+			for (int x = 1; x < minX; x++) {
+				int radiusBlock = lightblock[mult][y + blockY][x + blockX];
+				if (radiusBlock < 128)
+					setLight(position - Displacement { x, y }, lightradius[nRadius][radiusBlock]);
+			}
+		}
+		RotateRadius(&xoff, &yoff, &distX, &distY, &lightX, &lightY, &blockX, &blockY);
+		mult = xoff + 8 * yoff;
+		for (int y = 0; y < minY; y++) {
+			for (int x = 1; x < minX; x++) {
+				int radiusBlock = lightblock[mult][y + blockY][x + blockX];
+				if (radiusBlock < 128)
+					setLight(position + Displacement { -y, x }, lightradius[nRadius][radiusBlock]);
+			}
+		}
+	}
+
+private:
+	static void RotateRadius(int *x, int *y, int *dx, int *dy, int *lx, int *ly, int *bx, int *by)
+	{
+		*bx = 0;
+		*by = 0;
+
+		int swap = *dx;
+		*dx = 7 - *dy;
+		*dy = swap;
+		swap = *lx;
+		*lx = 7 - *ly;
+		*ly = swap;
+
+		*x = *dx - *lx;
+		*y = *dy - *ly;
+
+		if (*x < 0) {
+			*x += 8;
+			*bx = 1;
+		}
+		if (*y < 0) {
+			*y += 8;
+			*by = 1;
+		}
+	}
+
+	uint8_t lightradius[16][128];
+	uint8_t lightblock[64][16][16];
+};
+
+void TestLightStamps(int level)
+{
+	const uint8_t previousLevel = currlevel;
+	currlevel = level;
+	MakeLightRadiusTables();
+	const QuadrantLighting reference;
+	InitLighting();
+	const int lnum = AddLight({ 0, 0 }, 0);
+
+	SetRndSeed(level);
+	char initial[MAXDUNX][MAXDUNY];
+	for (auto &column : initial) {
+		for (char &light : column)
+			light = static_cast<char>(GenerateRnd(16));
+	}
+
+	// Positions next to the map edges where the quadrants are cut short
+	const int positions[] = { 0, 1, 7, 14, 15, 56, 97, 98, 105, 111 };
+	const int offsets[] = { -7, -1, 0, 3, 7 };
+	char expected[MAXDUNX][MAXDUNY];
+	int mismatches = 0;
+	std::string firstMismatch;
+	for (int radius = 0; radius < 16; radius += 3) {
+		for (int x : positions) {
+			for (int y : positions) {
+				for (int xoff : offsets) {
+					for (int yoff : offsets) {
+						Lights[lnum].position.offset = { xoff, yoff };
+						memcpy(dLight, initial, sizeof(dLight));
+						DoLighting({ x, y }, radius, lnum);
+						memcpy(expected, initial, sizeof(expected));
+						reference.Apply(expected, { x, y }, radius, { xoff, yoff });
+						if (memcmp(dLight, expected, sizeof(dLight)) != 0 && mismatches++ == 0)
+							firstMismatch = fmt::format("radius {}, tile {}:{}, offset {}:{}", radius, x, y, xoff, yoff);
+					}
+				}
+			}
+		}
+	}
+	EXPECT_EQ(mismatches, 0) << "level " << level << ", first mismatch at " << firstMismatch;
+
+	InitLighting();
+	currlevel = previousLevel;
+}
+
+/** @brief The ray crawl DoVision did for every vision source on each update, before the visible tiles were cached */
+void CrawlVisionReference(Point position, int nRadius, bool doautomap, bool visible)
+{
+	constexpr uint8_t RadiusAdj[23] = { 0, 0, 0, 0, 1, 1, 1, 2, 2, 2, 3, 4, 3, 2, 2, 2, 1, 1, 1, 0, 0, 0, 0 };
+	const auto reveal = [&](int x, int y) {
+		if (doautomap) {
+			if (dFlags[x][y] != 0)
+				SetAutomapView({ x, y });
+			dFlags[x][y] |= BFLAG_EXPLORED;
+		}
+		if (visible)
+			dFlags[x][y] |= BFLAG_LIT;
+		dFlags[x][y] |= BFLAG_VISIBLE;
+	};
+	const auto inMap = [](int x, int y) { return x >= 0 && x < MAXDUNX && y >= 0 && y < MAXDUNY; };
+
+	if (inMap(position.x, position.y))
+		reveal(position.x, position.y);
+
+	const int signs[4][2] = { { 1, 1 }, { -1, -1 }, { 1, -1 }, { -1, 1 } };
+	const int adjacent[4][4] = { { -1, 0, 0, -1 }, { 0, 1, 1, 0 }, { -1, 0, 0, 1 }, { 0, -1, 1, 0 } };
+	for (int v = 0; v < 4; v++) {
+		for (int j = 0; j < 23; j++) {
+			bool blocked = false;
+			for (int k = 0; k < 2 * (nRadius - RadiusAdj[j]) && !blocked; k += 2) {
+				const int x = position.x + signs[v][0] * VisionCrawlTable[j][k];
+				const int y = position.y + signs[v][1] * VisionCrawlTable[j][k + 1];
+				const bool diagonal = VisionCrawlTable[j][k] > 0 && VisionCrawlTable[j][k + 1] > 0;
+				const int x1 = x + (diagonal ? adjacent[v][0] : 0);
+				const int y1 = y + (diagonal ? adjacent[v][1] : 0);
+				const int x2 = x + (diagonal ? adjacent[v][2] : 0);
+				const int y2 = y + (diagonal ? adjacent[v][3] : 0);
+				if (!inMap(x, y))
+					continue;
+				blocked = nBlockTable[dPiece[x][y]];
+				if ((inMap(x1, y1) && !nBlockTable[dPiece[x1][y1]]) || (inMap(x2, y2) && !nBlockTable[dPiece[x2][y2]])) {
+					reveal(x, y);
+					if (!blocked && dTransVal[x][y] != 0)
+						TransList[dTransVal[x][y]] = true;
+				}
+			}
+		}
+	}
+}
+
+/** @brief ProcessVisionList with every source crawled again */
+void ProcessVisionListReference()
+{
+	for (int i = 0; i < VisionCount; i++) {
+		if (VisionList[i]._ldel)
+			DoUnVision(VisionList[i].position.tile, VisionList[i]._lradius);
+		if (VisionList[i]._lunflag) {
+			DoUnVision(VisionList[i].position.old, VisionList[i].oldRadius);
+			VisionList[i]._lunflag = false;
+		}
+	}
+	memset(TransList, 0, sizeof(TransList));
+	for (int i = 0; i < VisionCount; i++) {
+		if (!VisionList[i]._ldel)
+			CrawlVisionReference(VisionList[i].position.tile, VisionList[i]._lradius, VisionList[i]._lflags, VisionList[i]._lflags);
+	}
+	bool deleted;
+	do {
+		deleted = false;
+		for (int i = 0; i < VisionCount; i++) {
+			if (!VisionList[i]._ldel)
+				continue;
+			VisionCount--;
+			if (VisionCount > 0 && i != VisionCount)
+				VisionList[i] = VisionList[VisionCount];
+			deleted = true;
+		}
+	} while (deleted);
+}
+
+/** @brief Everything ProcessVisionList changes */
+struct VisionState {
+	int8_t flags[MAXDUNX][MAXDUNY];
+	bool transList[256];
+	bool automapView[DMAXX][DMAXY];
+	LightStruct visionList[MAXVISION];
+	int visionCount;
+
+	void Save()
+	{
+		memcpy(flags, dFlags, sizeof(flags));
+		memcpy(transList, TransList, sizeof(transList));
+		memcpy(automapView, AutomapView, sizeof(automapView));
+		memcpy(visionList, VisionList, sizeof(visionList));
+		visionCount = VisionCount;
+	}
+
+	void Restore() const
+	{
+		memcpy(dFlags, flags, sizeof(flags));
+		memcpy(TransList, transList, sizeof(transList));
+		memcpy(AutomapView, automapView, sizeof(automapView));
+		memcpy(VisionList, visionList, sizeof(visionList));
+		VisionCount = visionCount;
+	}
+};
+
+void ClearVisionMap()
+{
+	memset(dPiece, 0, sizeof(dPiece));
+	memset(dFlags, 0, sizeof(dFlags));
+	memset(dTransVal, 0, sizeof(dTransVal));
+	memset(AutomapView, 0, sizeof(AutomapView));
+	nBlockTable[1] = false;
+	InitVision();
+}
+
+} // namespace
+
+TEST(Lighting, CachedVisionMatchesCrawl)
+{
+	SetRndSeed(1);
+	nBlockTable[0] = false;
+	nBlockTable[1] = true;
+	for (int x = 0; x < MAXDUNX; x++) {
+		for (int y = 0; y < MAXDUNY; y++) {
+			dPiece[x][y] = GenerateRnd(100) < 15 ? 1 : 0;
+			dTransVal[x][y] = static_cast<int8_t>(GenerateRnd(4));
+			// Some of the map was explored before, which decides when the automap gets revealed
+			dFlags[x][y] = GenerateRnd(4) == 0 ? BFLAG_EXPLORED : 0;
+		}
+	}
+	memset(AutomapView, 0, sizeof(AutomapView));
+	InitVision();
+
+	for (int i = 0; i < 4; i++)
+		AddVision(RandomTile(), 2 + GenerateRnd(14), i == 0);
+
+	auto expected = std::make_unique<VisionState>();
+	auto actual = std::make_unique<VisionState>();
+	for (int tick = 0; tick < 300; tick++) {
+		const int i = GenerateRnd(VisionCount);
+		const Point tile = VisionList[i].position.tile;
+		switch (GenerateRnd(6)) {
+		case 0:
+			ChangeVisionXY(VisionList[i]._lid, RandomTile());
+			break;
+		case 1:
+			ChangeVisionRadius(VisionList[i]._lid, 2 + GenerateRnd(14));
+			break;
+		case 2: {
+			// Open or close a door next to the source
+			const int x = clamp(tile.x + GenerateRnd(9) - 4, 0, MAXDUNX - 1);
+			const int y = clamp(tile.y + GenerateRnd(9) - 4, 0, MAXDUNY - 1);
+			dPiece[x][y] = 1 - dPiece[x][y];
+			InvalidateVision();
+			ChangeVisionXY(VisionList[i]._lid, tile);
+		} break;
+		case 3:
+			// The first source is the local player, which is never removed
+			if (i > 0 && VisionCount > 2) {
+				VisionList[i]._ldel = true;
+				ChangeVisionXY(VisionList[i]._lid, tile);
+			} else {
+				AddVision(RandomTile(), 2 + GenerateRnd(14), false);
+			}
+			break;
+		default:
+			// Most of the time one of the sources takes a step
+			ChangeVisionXY(VisionList[i]._lid, { clamp(tile.x + GenerateRnd(3) - 1, 0, MAXDUNX - 1), clamp(tile.y + GenerateRnd(3) - 1, 0, MAXDUNY - 1) });
+			break;
+		}
+
+		const auto before = std::make_unique<VisionState>();
+		before->Save();
+		ProcessVisionListReference();
+		expected->Save();
+		before->Restore();
+		ProcessVisionList();
+		actual->Save();
+
+		ASSERT_EQ(actual->visionCount, expected->visionCount) << "tick " << tick;
+		EXPECT_EQ(memcmp(actual->flags, expected->flags, sizeof(actual->flags)), 0) << "tick " << tick;
+		EXPECT_EQ(memcmp(actual->transList, expected->transList, sizeof(actual->transList)), 0) << "tick " << tick;
+		EXPECT_EQ(memcmp(actual->automapView, expected->automapView, sizeof(actual->automapView)), 0) << "tick " << tick;
+		if (::testing::Test::HasFailure())
+			break;
+	}
+
+	ClearVisionMap();
+}
+
+TEST(Lighting, CachedVisionFollowsTownChanges)
+{
+	ClearVisionMap();
+	const dungeon_type oldLevelType = leveltype;
+	leveltype = DTYPE_TOWN;
+	// SetDungeonMicros reads the micros of every piece on the map
+	pLevelPieces = std::make_unique<uint16_t[]>(16 * MAXTILES);
+	// The closed grave blocks the view, the open one doesn't
+	for (int x = 36; x <= 37; x++) {
+		for (int y = 21; y <= 24; y++) {
+			dPiece[x][y] = 0x52b + (y - 21) * 2 + (x - 36);
+			nBlockTable[dPiece[x][y]] = true;
+		}
+	}
+
+	AddVision({ 33, 22 }, 10, true);
+	ProcessVisionList();
+	EXPECT_EQ(dFlags[39][22] & BFLAG_VISIBLE, 0);
+
+	// Opened by a network message while the cached field of the source is still around
+	TownOpenGrave();
+	ChangeVisionXY(VisionList[0]._lid, VisionList[0].position.tile);
+
+	auto before = std::make_unique<VisionState>();
+	before->Save();
+	ProcessVisionListReference();
+	auto expected = std::make_unique<VisionState>();
+	expected->Save();
+	before->Restore();
+	ProcessVisionList();
+	EXPECT_NE(dFlags[39][22] & BFLAG_VISIBLE, 0);
+	EXPECT_EQ(memcmp(dFlags, expected->flags, sizeof(dFlags)), 0);
+
+	for (int piece = 0x52b; piece <= 0x532; piece++)
+		nBlockTable[piece] = false;
+	pLevelPieces = nullptr;
+	leveltype = oldLevelType;
+	ClearVisionMap();
+}
+
+TEST(Lighting, IncrementalMatchesFullRelight)
+{
+	TestIncrementalLighting(5);
+}
+
+TEST(Lighting, IncrementalMatchesFullRelightHellfire)
+{
+	// The crypt and nest falloff tables reach further than the light radius
+	TestIncrementalLighting(21);
+}
+
+TEST(Lighting, StampsMatchQuadrants)
+{
+	TestLightStamps(5);
+}
+
+TEST(Lighting, StampsMatchQuadrantsHellfire)
+{
+	TestLightStamps(21);
+}
@@ -0,0 +1,148 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "automap.h"
+#include "gendung.h"
+#include "init.h"
+#include "items.h"
+#include "lighting.h"
+#include "loadsave.h"
+#include "missiles.h"
+#include "monster.h"
+#include "objects.h"
+#include "pfile.h"
+#include "portal.h"
+#include "quests.h"
+#include "utils/endian.hpp"
+#include "utils/paths.h"
+
+using namespace devilution;
+
+namespace {
+
+/**
+ * @brief A dungeon level with every monster, missile, object and item slot the build allows in use
+ */
+class LoadSaveTest : public ::testing::Test {
+protected:
+	void SetUp() override
+	{
+		paths::SetPrefPath(".");
+		std::remove("multi_0.sv");
+
+		gbVanilla = true;
+		gbIsHellfire = false;
+		gbIsSpawn = false;
+		gbIsMultiplayer = true;
+		gbIsHellfireSaveGame = false;
+		MyPlayerId = 0;
+
+		_uiheroinfo info {};
+		strcpy(info.name, "TestPlayer");
+		info.heroclass = HeroClass::Warrior;
+		ASSERT_TRUE(pfile_ui_save_create(&info));
+		// Keep the player off the level, LoadLevel would turn on its light
+		Players[MyPlayerId].plrlevel = 0;
+
+		setlevel = false;
+		currlevel = 1;
+		leveltype = DTYPE_CATHEDRAL;
+		for (auto &quest : Quests) {
+			quest._qactive = QUEST_NOTAVAIL;
+			quest._qlevel = 0;
+		}
+		for (auto &portal : Portals)
+			portal.open = false;
+		LevelMonsterTypes[0].MData = &MonsterData[MT_NZOMBIE];
+
+		ActiveMonsterCount = MAXMONSTERS;
+		for (int i = 0; i < MAXMONSTERS; i++) {
+			// In reverse, so the list itself has to come back as well
+			ActiveMonsters[i] = MAXMONSTERS - 1 - i;
+			auto &monster = Monsters[i];
+			monster._mMTidx = 0;
+			monster._mmode = MM_STAND;
+			monster._mdir = DIR_S;
+			monster._uniqtype = 0;
+			monster.mlid = NO_LIGHT;
+			monster._mhitpoints = (i + 1) << 6;
+		}
+
+		ActiveMissileCount = MAXMISSILES;
+		for (int i = 0; i < MAXMISSILES; i++) {
+			ActiveMissiles[i] = i;
+			AvailableMissiles[i] = i;
+			Missiles[i]._mirange = i;
+		}
+
+		ActiveObjectCount = MAXOBJECTS;
+		for (int i = 0; i < MAXOBJECTS; i++) {
+			ActiveObjects[i] = i;
+			AvailableObjects[i] = i;
+			Objects[i]._otype = OBJ_L1LIGHT;
+			Objects[i]._oRndSeed = i + 1;
+		}
+
+		ActiveItemCount = MAXITEMS;
+		for (int i = 0; i < MAXITEMS; i++) {
+			ActiveItems[i] = i;
+			AvailableItems[i] = i;
+			auto &item = Items[i];
+			item._itype = ITYPE_MISC;
+			item.IDidx = IDI_HEAL;
+			item._iCurs = ICURS_POTION_OF_HEALING;
+			item._iUid = 0;
+			item._iSeed = i + 1;
+		}
+
+		// Close to the end of the level and the game, so a cut off save shows up here
+		AutomapView[DMAXX - 1][DMAXY - 1] = true;
+		AutomapActive = true;
+		AutoMapScale = 75;
+	}
+};
+
+} // namespace
+
+TEST_F(LoadSaveTest, LevelRoundTripsAtEntityLimits)
+{
+	SaveLevel();
+
+	ActiveMonsterCount = 0;
+	ActiveObjectCount = 0;
+	ActiveItemCount = 0;
+	for (auto &monster : Monsters)
+		monster._mhitpoints = 0;
+	for (auto &object : Objects)
+		object._oRndSeed = 0;
+	for (int i = 0; i < MAXITEMS; i++)
+		Items[i]._iSeed = 0;
+	AutomapView[DMAXX - 1][DMAXY - 1] = false;
+
+	LoadLevel();
+
+	ASSERT_EQ(ActiveMonsterCount, MAXMONSTERS);
+	for (int i = 0; i < MAXMONSTERS; i++) {
+		EXPECT_EQ(ActiveMonsters[i], MAXMONSTERS - 1 - i);
+		EXPECT_EQ(Monsters[i]._mhitpoints, (i + 1) << 6) << "monster " << i;
+	}
+	ASSERT_EQ(ActiveObjectCount, MAXOBJECTS);
+	for (int i = 0; i < MAXOBJECTS; i++)
+		EXPECT_EQ(Objects[i]._oRndSeed, static_cast<uint32_t>(i + 1)) << "object " << i;
+	ASSERT_EQ(ActiveItemCount, MAXITEMS);
+	for (int i = 0; i < MAXITEMS; i++)
+		EXPECT_EQ(Items[i]._iSeed, i + 1) << "item " << i;
+	EXPECT_TRUE(AutomapView[DMAXX - 1][DMAXY - 1]);
+}
+
+TEST_F(LoadSaveTest, GameSnapshotKeepsEverythingAtEntityLimits)
+{
+	std::vector<byte> snapshot = SaveGameSnapshot();
+
+	ASSERT_GE(snapshot.size(), 4U);
+	EXPECT_EQ(LoadBE32(&snapshot[snapshot.size() - 4]), 75U);
+	EXPECT_EQ(snapshot[snapshot.size() - 5], byte { 1 });
+}
@@ -0,0 +1,123 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <vector>
+
+#include "engine/random.hpp"
+#include "gendung.h"
+#include "missiles.h"
+#include "monster.h"
+#include "player.h"
+
+using namespace devilution;
+
+namespace {
+
+/** The enemy UpdateEnemy picked for a monster */
+struct EnemyChoice {
+	int enemy;
+	Point enemyPosition;
+	bool targetsMonster;
+	bool noEnemy;
+};
+
+/**
+ * @brief A crowd of monsters with golems and berserk monsters among them, spread over a few rooms away from the player
+ */
+class UpdateEnemyTest : public ::testing::Test {
+protected:
+	void SetUp() override
+	{
+		previousLevel_ = currlevel;
+		wasMultiplayer_ = gbIsMultiplayer;
+		currlevel = 1;
+		gbIsMultiplayer = false;
+
+		auto &player = Players[0];
+		player.plractive = true;
+		player.plrlevel = currlevel;
+		player._pLvlChanging = false;
+		player._pHitPoints = 100 << 6;
+		player.position.tile = { 50, 50 };
+		player.position.future = player.position.tile;
+
+		for (int x = 0; x < MAXDUNX; x++) {
+			for (int y = 0; y < MAXDUNY; y++)
+				dTransVal[x][y] = static_cast<int8_t>((x / 4 + y / 4) % 3);
+		}
+
+		InitLevelMonsters();
+		SetRndSeed(12);
+		ActiveMonsterCount = 100;
+		for (int i = 0; i < ActiveMonsterCount; i++) {
+			// Not in order, the golems have to be picked in the order of ActiveMonsters
+			const int mi = (i * 7) % MAXMONSTERS;
+			ActiveMonsters[i] = mi;
+			auto &monster = Monsters[mi];
+			monster._mAi = GenerateRnd(3) == 0 ? AI_SKELBOW : AI_ZOMBIE;
+			monster.mtalkmsg = TEXT_NONE;
+			monster._mhitpoints = (1 + GenerateRnd(100)) << 6;
+			monster.position.tile = { 20 + GenerateRnd(12), 20 + GenerateRnd(12) };
+			monster.position.future = monster.position.tile;
+			monster._mFlags = 0;
+			if (i % 10 == 0)
+				monster._mFlags |= MFLAG_GOLEM;
+			if (i % 10 == 5)
+				monster._mFlags |= MFLAG_BERSERK;
+		}
+		// A dead golem and one that hasn't been summoned yet are skipped either way
+		Monsters[ActiveMonsters[10]]._mhitpoints = 0;
+		Monsters[ActiveMonsters[20]].position.tile = GolemHoldingCell;
+	}
+
+	void TearDown() override
+	{
+		ForgetGolemTargets();
+		InitLevelMonsters();
+		Players[0].plractive = false;
+		memset(dTransVal, 0, sizeof(dTransVal));
+		gbIsMultiplayer = wasMultiplayer_;
+		currlevel = previousLevel_;
+	}
+
+private:
+	uint8_t previousLevel_;
+	bool wasMultiplayer_;
+};
+
+std::vector<EnemyChoice> ChooseEnemies()
+{
+	std::vector<EnemyChoice> choices;
+	for (int i = 0; i < ActiveMonsterCount; i++) {
+		auto &monster = Monsters[ActiveMonsters[i]];
+		monster._menemy = 0;
+		monster.enemyPosition = { 0, 0 };
+		monster._mFlags &= ~(MFLAG_TARGETS_MONSTER | MFLAG_NO_ENEMY);
+		UpdateEnemy(monster);
+		choices.push_back({ monster._menemy, monster.enemyPosition, (monster._mFlags & MFLAG_TARGETS_MONSTER) != 0, (monster._mFlags & MFLAG_NO_ENEMY) != 0 });
+	}
+	return choices;
+}
+
+} // namespace
+
+TEST_F(UpdateEnemyTest, GolemTargetsMatchFullScan)
+{
+	const std::vector<EnemyChoice> expected = ChooseEnemies();
+	CollectGolemTargets();
+	const std::vector<EnemyChoice> actual = ChooseEnemies();
+	ForgetGolemTargets();
+
+	ASSERT_EQ(actual.size(), expected.size());
+	int ordinaryMonstersAfterGolems = 0;
+	for (size_t i = 0; i < expected.size(); i++) {
+		EXPECT_EQ(actual[i].enemy, expected[i].enemy) << "Active monster " << i << " picked another enemy";
+		EXPECT_EQ(actual[i].enemyPosition, expected[i].enemyPosition) << "Active monster " << i << " picked another enemy";
+		EXPECT_EQ(actual[i].targetsMonster, expected[i].targetsMonster) << "Active monster " << i << " picked another enemy";
+		EXPECT_EQ(actual[i].noEnemy, expected[i].noEnemy) << "Active monster " << i << " picked another enemy";
+		if (expected[i].targetsMonster && (Monsters[ActiveMonsters[i]]._mFlags & (MFLAG_GOLEM | MFLAG_BERSERK)) == 0)
+			ordinaryMonstersAfterGolems++;
+	}
+	// Otherwise the golem list would have nothing to do with the outcome
+	EXPECT_GT(ordinaryMonstersAfterGolems, 0);
+}
@@ -0,0 +1,68 @@
+#include <gtest/gtest.h>
+
+#include <sstream>
+
+#include "utils/net_stats.h"
+
+using namespace devilution;
+using namespace devilution::netstats;
+
+TEST(NetStats, ComputeRates)
+{
+	NetStats previous {};
+	previous.peers[1] = { true, 40, 100, 200, 10000, 20000, 3 };
+	previous.decryptFailures = 1;
+	previous.cryptoTime = 1000;
+
+	NetStats current = previous;
+	current.peers[1] = { true, 50, 140, 260, 14000, 26000, 2 };
+	current.turnsInTransit = 4;
+	current.messagesQueued = 5;
+	current.decryptFailures = 3;
+	current.cryptoTime = 5000;
+
+	const Rates rates = ComputeRates(previous, current, 2);
+	EXPECT_FALSE(rates.peers[0].connected);
+	EXPECT_TRUE(rates.peers[1].connected);
+	EXPECT_EQ(rates.peers[1].roundTripTime, 50);
+	EXPECT_FLOAT_EQ(rates.peers[1].packetsSent, 20);
+	EXPECT_FLOAT_EQ(rates.peers[1].packetsReceived, 30);
+	EXPECT_FLOAT_EQ(rates.peers[1].bytesSent, 2000);
+	EXPECT_FLOAT_EQ(rates.peers[1].bytesReceived, 3000);
+	EXPECT_EQ(rates.peers[1].turnsQueued, 2);
+	EXPECT_EQ(rates.turnsInTransit, 4);
+	EXPECT_EQ(rates.messagesQueued, 5);
+	EXPECT_EQ(rates.decryptFailures, 2);
+	EXPECT_FLOAT_EQ(rates.cryptoTime, 2);
+}
+
+TEST(NetStats, ComputeRatesAfterReset)
+{
+	NetStats previous {};
+	previous.peers[2] = { true, 40, 100, 200, 10000, 20000, 0 };
+
+	NetStats current {};
+	current.peers[2] = { true, 0, 10, 20, 1000, 2000, 0 };
+
+	const Rates rates = ComputeRates(previous, current, 1);
+	EXPECT_FLOAT_EQ(rates.peers[2].packetsSent, 10);
+	EXPECT_FLOAT_EQ(rates.peers[2].packetsReceived, 20);
+	EXPECT_FLOAT_EQ(rates.peers[2].bytesSent, 1000);
+	EXPECT_FLOAT_EQ(rates.peers[2].bytesReceived, 2000);
+}
+
+TEST(NetStats, WriteJson)
+{
+	NetStats previous {};
+	NetStats current {};
+	current.peers[3] = { true, 25, 10, 20, 300, 400, 1 };
+	current.turnsInTransit = 2;
+	current.decryptFailures = 1;
+
+	std::ostringstream out;
+	WriteJson(out, 1500, ComputeRates(previous, current, 1), current);
+	EXPECT_EQ(out.str(),
+	    "{\"time_ms\":1500,\"turns_in_transit\":2,\"messages_queued\":0,\"decrypt_failures\":1,\"decrypt_failures_total\":1,\"crypto_ms_per_s\":0,\"peers\":["
+	    "{\"player\":3,\"rtt_ms\":25,\"turns_queued\":1,\"packets_sent_per_s\":10,\"packets_received_per_s\":20,\"bytes_sent_per_s\":300,\"bytes_received_per_s\":400,\"bytes_sent\":300,\"bytes_received\":400}"
+	    "]}\n");
+}
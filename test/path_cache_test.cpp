@@ -0,0 +1,152 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstring>
+
+#include "engine/random.hpp"
+#include "gendung.h"
+#include "path_cache.h"
+#include "utils/stdcompat/algorithm.hpp"
+
+namespace devilution {
+
+namespace {
+
+/** Maps from the path steps returned by FindPath to the movement, the steps start at 1 */
+constexpr Displacement StepDisplacements[9] = { { 0, 0 }, { 0, -1 }, { -1, 0 }, { 1, 0 }, { 0, 1 }, { -1, -1 }, { 1, -1 }, { 1, 1 }, { -1, 1 } };
+
+/** Tiles that are walkable but taken, like the ones monsters and players stand on */
+std::array<std::array<bool, MAXDUNY>, MAXDUNX> Occupied;
+
+/**
+ * @brief Fills the map with random walls and occupied tiles
+ */
+void MakeRandomMap(uint32_t seed, int wallChance)
+{
+	SetRndSeed(seed);
+	for (int x = 0; x < MAXDUNX; x++) {
+		for (int y = 0; y < MAXDUNY; y++) {
+			dPiece[x][y] = GenerateRnd(100) < wallChance ? 1 : 0;
+			dObject[x][y] = 0;
+			Occupied[x][y] = GenerateRnd(100) < 5;
+		}
+	}
+	nSolidTable[0] = false;
+	nSolidTable[1] = true;
+	InvalidatePathCache();
+}
+
+/**
+ * @brief Leaves an empty map for the other tests
+ */
+void ClearMap()
+{
+	memset(dPiece, 0, sizeof(dPiece));
+	InvalidatePathCache();
+}
+
+bool IsTileFree(Point position)
+{
+	return position.x >= 0 && position.x < MAXDUNX && position.y >= 0 && position.y < MAXDUNY
+	    && !Occupied[position.x][position.y] && IsTileWalkable(position);
+}
+
+Point RandomPositionNear(Point center, int range)
+{
+	return { clamp(center.x + GenerateRnd(2 * range + 1) - range, 0, MAXDUNX - 1), clamp(center.y + GenerateRnd(2 * range + 1) - range, 0, MAXDUNY - 1) };
+}
+
+} // namespace
+
+TEST(PathCacheTest, MightFindPathKeepsEverySolvableSearch)
+{
+	for (uint32_t seed = 1; seed <= 8; seed++) {
+		MakeRandomMap(seed, 40);
+		int8_t path[MAX_PATH_LENGTH];
+		int rejected = 0;
+		for (int i = 0; i < 400; i++) {
+			// A few destinations shared by many searches, like a pack of monsters chasing the players
+			const Point destination = RandomPositionNear({ 56, 56 }, 2);
+			const Point start = RandomPositionNear(destination, 30);
+			const int length = FindPath(IsTileFree, start, destination, path);
+			if (MightFindPath(start, destination))
+				continue;
+			rejected++;
+			ASSERT_EQ(length, 0) << "MightFindPath rejected the path from " << start << " to " << destination << " with seed " << seed;
+		}
+		EXPECT_GT(rejected, 0) << "Nothing was rejected with seed " << seed << ", the comparison is meaningless";
+	}
+	ClearMap();
+}
+
+TEST(PathCacheTest, MightFindPathFollowsMapChanges)
+{
+	MakeRandomMap(1, 0);
+	const Point destination { 50, 50 };
+	const Point start { 40, 50 };
+	EXPECT_TRUE(MightFindPath(start, destination));
+
+	// Wall in the destination
+	for (int x = 46; x <= 54; x++) {
+		for (int y = 46; y <= 54; y++) {
+			dPiece[x][y] = std::max(abs(x - 50), abs(y - 50)) == 4 ? 1 : 0;
+		}
+	}
+	InvalidatePathCache();
+	EXPECT_FALSE(MightFindPath(start, destination));
+	EXPECT_TRUE(MightFindPath({ 48, 50 }, destination));
+	ClearMap();
+}
+
+TEST(PathCacheTest, CachedPathMatchesFindPath)
+{
+	for (uint32_t seed = 1; seed <= 8; seed++) {
+		MakeRandomMap(seed, 25);
+		CachedPath cache;
+		Point start { 56, 56 };
+		Point destination = RandomPositionNear(start, 12);
+		int8_t path[MAX_PATH_LENGTH];
+		int8_t expectedPath[MAX_PATH_LENGTH];
+		int found = 0;
+		int lastLength = 0;
+		for (int i = 0; i < 400; i++) {
+			// Mostly repeated searches, with the occupied tiles changing around them
+			switch (GenerateRnd(8)) {
+			case 0:
+				start = RandomPositionNear({ 56, 56 }, 4);
+				break;
+			case 1:
+				destination = RandomPositionNear(start, 12);
+				break;
+			case 2: {
+				const Point tile = RandomPositionNear(start, 6);
+				Occupied[tile.x][tile.y] = !Occupied[tile.x][tile.y];
+			} break;
+			case 3:
+				// Block the path found last time, short of the destination
+				if (lastLength > 1) {
+					Point tile = start;
+					const int steps = 1 + GenerateRnd(lastLength - 1);
+					for (int step = 0; step < steps; step++)
+						tile += StepDisplacements[path[step]];
+					Occupied[tile.x][tile.y] = true;
+				}
+				break;
+			default:
+				break;
+			}
+			const int expectedLength = FindPath(IsTileFree, start, destination, expectedPath);
+			const int length = cache.FindPath(IsTileFree, 0, start, destination, path);
+			ASSERT_EQ(length, expectedLength) << "Wrong path length for a path from " << start << " to " << destination << " with seed " << seed;
+			for (int step = 0; step < length; step++)
+				ASSERT_EQ(path[step], expectedPath[step]) << "Path step " << step << " differs for a path from " << start << " to " << destination << " with seed " << seed;
+			if (length > 0)
+				found++;
+			lastLength = length;
+		}
+		EXPECT_GT(found, 0) << "No paths found with seed " << seed << ", the comparison is meaningless";
+	}
+	ClearMap();
+}
+
+} // namespace devilution
@@ -1,10 +1,14 @@
 #include <gtest/gtest.h>
 
+#include <array>
+
+#include "engine/random.hpp"
 #include "path.h"
 
 // The following headers are included to access globals used in functions that have not been isolated yet.
 #include "gendung.h"
 #include "objects.h"
+#include "utils/stdcompat/algorithm.hpp"
 
 namespace devilution {
 
@@ -138,6 +142,311 @@ TEST(PathTest, FindPath)
 	CheckPath({ 8, 8 }, { 12, 20 }, { 7, 7, 7, 7, 4, 4, 4, 4, 4, 4, 4, 4 });
 }
 
+namespace reference {
+namespace {
+
+/* FindPath as it was when the frontier and visited nodes were linear linked lists, to check the indexed search finds the same paths */
+
+PATHNODE *path_2_nodes;
+PATHNODE *GetNode1(Point targetPosition)
+{
+	PATHNODE *result = path_2_nodes->NextNode;
+	while (result != nullptr) {
+		if (result->position == targetPosition)
+			return result;
+		result = result->NextNode;
+	}
+	return nullptr;
+}
+
+void NextNode(PATHNODE *pPath)
+{
+	if (path_2_nodes->NextNode == nullptr) {
+		path_2_nodes->NextNode = pPath;
+		return;
+	}
+
+	PATHNODE *current = path_2_nodes;
+	PATHNODE *next = path_2_nodes->NextNode;
+	int f = pPath->f;
+	while (next != nullptr && next->f < f) {
+		current = next;
+		next = next->NextNode;
+	}
+	pPath->NextNode = next;
+	current->NextNode = pPath;
+}
+
+PATHNODE *pnode_ptr;
+PATHNODE *GetNode2(Point targetPosition)
+{
+	PATHNODE *result = pnode_ptr->NextNode;
+	while (result != nullptr) {
+		if (result->position == targetPosition)
+			return result;
+		result = result->NextNode;
+	}
+	return nullptr;
+}
+
+PATHNODE *GetNextPath()
+{
+	PATHNODE *result = path_2_nodes->NextNode;
+	if (result == nullptr) {
+		return result;
+	}
+
+	path_2_nodes->NextNode = result->NextNode;
+	result->NextNode = pnode_ptr->NextNode;
+	pnode_ptr->NextNode = result;
+	return result;
+}
+
+constexpr size_t MAXPATHNODES = 300;
+
+PATHNODE path_nodes[MAXPATHNODES];
+uint32_t gdwCurNodes;
+PATHNODE *NewStep()
+{
+	if (gdwCurNodes >= MAXPATHNODES)
+		return nullptr;
+
+	PATHNODE *newNode = &path_nodes[gdwCurNodes];
+	gdwCurNodes++;
+	memset(newNode, 0, sizeof(PATHNODE));
+	return newNode;
+}
+
+PATHNODE *pnode_tblptr[MAXPATHNODES];
+uint32_t gdwCurPathStep;
+void PushActiveStep(PATHNODE *pPath)
+{
+	assert(gdwCurPathStep < MAXPATHNODES);
+	pnode_tblptr[gdwCurPathStep] = pPath;
+	gdwCurPathStep++;
+}
+
+PATHNODE *PopActiveStep()
+{
+	gdwCurPathStep--;
+	return pnode_tblptr[gdwCurPathStep];
+}
+
+int CheckEqual(Point startPosition, Point destinationPosition)
+{
+	if (startPosition.x == destinationPosition.x || startPosition.y == destinationPosition.y)
+		return 2;
+
+	return 3;
+}
+
+void SetCoords(PATHNODE *pPath)
+{
+	PushActiveStep(pPath);
+	// while there are path nodes to check
+	while (gdwCurPathStep > 0) {
+		PATHNODE *pathOld = PopActiveStep();
+		for (auto *pathAct : pathOld->Child) {
+			if (pathAct == nullptr)
+				break;
+
+			if (pathOld->g + CheckEqual(pathOld->position, pathAct->position) < pathAct->g) {
+				if (path_solid_pieces(pathOld->position, pathAct->position)) {
+					pathAct->Parent = pathOld;
+					pathAct->g = pathOld->g + CheckEqual(pathOld->position, pathAct->position);
+					pathAct->f = pathAct->g + pathAct->h;
+					PushActiveStep(pathAct);
+				}
+			}
+		}
+	}
+}
+
+int8_t GetPathDirection(Point startPosition, Point destinationPosition)
+{
+	constexpr int8_t PathDirections[9] = { 5, 1, 6, 2, 0, 3, 8, 4, 7 };
+	return PathDirections[3 * (destinationPosition.y - startPosition.y) + 4 + destinationPosition.x - startPosition.x];
+}
+
+int GetHeuristicCost(Point startPosition, Point destinationPosition)
+{
+	// see path_check_equal for why this is times 2
+	return 2 * startPosition.ManhattanDistance(destinationPosition);
+}
+
+bool ParentPath(PATHNODE *pPath, Point candidatePosition, Point destinationPosition)
+{
+	int nextG = pPath->g + CheckEqual(pPath->position, candidatePosition);
+
+	// 3 cases to consider
+	// case 1: (dx,dy) is already on the frontier
+	PATHNODE *dxdy = GetNode1(candidatePosition);
+	if (dxdy != nullptr) {
+		int i;
+		for (i = 0; i < 8; i++) {
+			if (pPath->Child[i] == nullptr)
+				break;
+		}
+		pPath->Child[i] = dxdy;
+		if (nextG < dxdy->g) {
+			if (path_solid_pieces(pPath->position, candidatePosition)) {
+				// we'll explore it later, just update
+				dxdy->Parent = pPath;
+				dxdy->g = nextG;
+				dxdy->f = nextG + dxdy->h;
+			}
+		}
+	} else {
+		// case 2: (dx,dy) was already visited
+		dxdy = GetNode2(candidatePosition);
+		if (dxdy != nullptr) {
+			int i;
+			for (i = 0; i < 8; i++) {
+				if (pPath->Child[i] == nullptr)
+					break;
+			}
+			pPath->Child[i] = dxdy;
+			if (nextG < dxdy->g && path_solid_pieces(pPath->position, candidatePosition)) {
+				// update the node
+				dxdy->Parent = pPath;
+				dxdy->g = nextG;
+				dxdy->f = nextG + dxdy->h;
+				// already explored, so re-update others starting from that node
+				SetCoords(dxdy);
+			}
+		} else {
+			// case 3: (dx,dy) is totally new
+			dxdy = NewStep();
+			if (dxdy == nullptr)
+				return false;
+			dxdy->Parent = pPath;
+			dxdy->g = nextG;
+			dxdy->h = GetHeuristicCost(candidatePosition, destinationPosition);
+			dxdy->f = nextG + dxdy->h;
+			dxdy->position = candidatePosition;
+			// add it to the frontier
+			NextNode(dxdy);
+
+			int i;
+			for (i = 0; i < 8; i++) {
+				if (pPath->Child[i] == nullptr)
+					break;
+			}
+			pPath->Child[i] = dxdy;
+		}
+	}
+	return true;
+}
+
+bool GetPath(const std::function<bool(Point)> &posOk, PATHNODE *pPath, Point destination)
+{
+	for (auto dir : PathDirs) {
+		Point tile = pPath->position + dir;
+		bool ok = posOk(tile);
+		if ((ok && path_solid_pieces(pPath->position, tile)) || (!ok && tile == destination)) {
+			if (!ParentPath(pPath, tile, destination))
+				return false;
+		}
+	}
+
+	return true;
+}
+
+int FindPath(const std::function<bool(Point)> &posOk, Point startPosition, Point destinationPosition, int8_t path[MAX_PATH_LENGTH])
+{
+	static int8_t pnodeVals[MAX_PATH_LENGTH];
+
+	// clear all nodes, create root nodes for the visited/frontier linked lists
+	gdwCurNodes = 0;
+	path_2_nodes = NewStep();
+	pnode_ptr = NewStep();
+	gdwCurPathStep = 0;
+	PATHNODE *pathStart = NewStep();
+	pathStart->g = 0;
+	pathStart->h = GetHeuristicCost(startPosition, destinationPosition);
+	pathStart->f = pathStart->h + pathStart->g;
+	pathStart->position = startPosition;
+	path_2_nodes->NextNode = pathStart;
+	// A* search until we find (dx,dy) or fail
+	PATHNODE *nextNode;
+	while ((nextNode = GetNextPath()) != nullptr) {
+		// reached the end, success!
+		if (nextNode->position == destinationPosition) {
+			PATHNODE *current = nextNode;
+			int pathLength = 0;
+			while (current->Parent != nullptr) {
+				if (pathLength >= MAX_PATH_LENGTH)
+					break;
+				pnodeVals[pathLength++] = GetPathDirection(current->Parent->position, current->position);
+				current = current->Parent;
+			}
+			if (pathLength != MAX_PATH_LENGTH) {
+				int i;
+				for (i = 0; i < pathLength; i++)
+					path[i] = pnodeVals[pathLength - i - 1];
+				return i;
+			}
+			return 0;
+		}
+		// ran out of nodes, abort!
+		if (!GetPath(posOk, nextNode, destinationPosition))
+			return 0;
+	}
+	// frontier is empty, no path!
+	return 0;
+}
+
+} // namespace
+} // namespace reference
+
+/**
+ * @brief Compares FindPath with the linked list search on a random map, from the start to every tile in range
+ */
+void CheckPathsMatchReference(uint32_t seed, int wallChance)
+{
+	SetRndSeed(seed);
+	std::array<std::array<bool, MAXDUNY>, MAXDUNX> walkable;
+	for (int x = 0; x < MAXDUNX; x++) {
+		for (int y = 0; y < MAXDUNY; y++) {
+			walkable[x][y] = GenerateRnd(100) >= wallChance;
+			// Solid pieces also keep paths from cutting corners
+			dPiece[x][y] = walkable[x][y] ? 0 : 1;
+		}
+	}
+	nSolidTable[0] = false;
+	nSolidTable[1] = true;
+	const auto posOk = [&walkable](Point position) {
+		return position.x >= 0 && position.x < MAXDUNX && position.y >= 0 && position.y < MAXDUNY && walkable[position.x][position.y];
+	};
+
+	const Point start { 2 + GenerateRnd(MAXDUNX - 4), 2 + GenerateRnd(MAXDUNY - 4) };
+	int8_t path[MAX_PATH_LENGTH];
+	int8_t expectedPath[MAX_PATH_LENGTH];
+	int found = 0;
+	for (int i = 0; i < 300; i++) {
+		// Mostly nearby targets like monsters chasing a player, some far enough away to run out of nodes
+		const int range = i % 10 == 0 ? 40 : 12;
+		const Point destination { clamp(start.x + GenerateRnd(2 * range + 1) - range, 0, MAXDUNX - 1), clamp(start.y + GenerateRnd(2 * range + 1) - range, 0, MAXDUNY - 1) };
+		const int expectedLength = reference::FindPath(posOk, start, destination, expectedPath);
+		const int length = FindPath(posOk, start, destination, path);
+		ASSERT_EQ(length, expectedLength) << "Wrong path length for a path from " << start << " to " << destination << " with seed " << seed;
+		for (int step = 0; step < length; step++)
+			ASSERT_EQ(path[step], expectedPath[step]) << "Path step " << step << " differs for a path from " << start << " to " << destination << " with seed " << seed;
+		if (length > 0)
+			found++;
+	}
+	EXPECT_GT(found, 0) << "No paths found with seed " << seed << ", the comparison is meaningless";
+}
+
+TEST(PathTest, FindPathMatchesReference)
+{
+	for (uint32_t seed = 1; seed <= 8; seed++) {
+		CheckPathsMatchReference(seed, 0);
+		CheckPathsMatchReference(seed, 20);
+		CheckPathsMatchReference(seed, 35);
+	}
+}
+
 TEST(PathTest, Walkable)
 {
 	dPiece[5][5] = 0;
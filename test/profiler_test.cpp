@@ -0,0 +1,102 @@
+#include <gtest/gtest.h>
+
+#include <sstream>
+
+#include "utils/profiler.h"
+
+using namespace devilution;
+using namespace devilution::profiler;
+
+namespace {
+
+/** @brief Records a tick where ProcessMonsters takes the given number of microseconds */
+void RecordTick(TickProfiler &profiler, uint64_t start, uint32_t monsterTime)
+{
+	profiler.BeginSample(start);
+	profiler.BeginPhase(TickPhase::ProcessPlayers, start);
+	profiler.BeginPhase(TickPhase::ProcessMonsters, start + 1000);
+	profiler.EndPhase(start + 1000 + monsterTime * 1000);
+	profiler.EndSample(start + 2000 + monsterTime * 1000);
+}
+
+} // namespace
+
+TEST(Profiler, PhaseStats)
+{
+	TickProfiler profiler(1000);
+	for (uint32_t i = 1; i <= 100; i++)
+		RecordTick(profiler, i * 1000000ULL, i);
+
+	EXPECT_EQ(profiler.Size(), 100);
+
+	PhaseStats players = profiler.Stats(TickPhase::ProcessPlayers, 100);
+	EXPECT_EQ(players.samples, 100);
+	EXPECT_FLOAT_EQ(players.min, 1);
+	EXPECT_FLOAT_EQ(players.avg, 1);
+
+	PhaseStats monsters = profiler.Stats(TickPhase::ProcessMonsters, 100);
+	EXPECT_EQ(monsters.samples, 100);
+	EXPECT_FLOAT_EQ(monsters.min, 1);
+	EXPECT_FLOAT_EQ(monsters.avg, 50.5F);
+	EXPECT_FLOAT_EQ(monsters.p99, 99);
+
+	PhaseStats objects = profiler.Stats(TickPhase::ProcessObjects, 100);
+	EXPECT_EQ(objects.samples, 0);
+
+	PhaseStats tick = profiler.TotalStats(10);
+	EXPECT_EQ(tick.samples, 10);
+	EXPECT_FLOAT_EQ(tick.min, 93);
+}
+
+TEST(Profiler, RingBufferKeepsNewestTicks)
+{
+	TickProfiler profiler(10);
+	for (uint32_t i = 1; i <= 25; i++)
+		RecordTick(profiler, i * 1000000ULL, i);
+
+	EXPECT_EQ(profiler.Size(), 10);
+	PhaseStats monsters = profiler.Stats(TickPhase::ProcessMonsters, 100);
+	EXPECT_EQ(monsters.samples, 10);
+	EXPECT_FLOAT_EQ(monsters.min, 16);
+}
+
+TEST(Profiler, ChromeTrace)
+{
+	TickProfiler profiler(10);
+	RecordTick(profiler, 5000000, 3);
+
+	std::stringstream trace;
+	bool first = true;
+	profiler.WriteTraceEvents(trace, "GameTick", 1, first);
+	const std::string json = trace.str();
+
+	EXPECT_FALSE(first);
+	EXPECT_NE(json.find("{\"name\":\"GameTick\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":5000.0,\"dur\":5.0}"), std::string::npos);
+	EXPECT_NE(json.find("{\"name\":\"ProcessMonsters\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":5001.0,\"dur\":3.0}"), std::string::npos);
+	EXPECT_EQ(json.find("ProcessObjects"), std::string::npos);
+}
+
+TEST(Profiler, ScopedRenderStages)
+{
+	FrameProfiler profiler(10);
+	profiler.BeginSample(1000000);
+	profiler.AddPhaseTime(RenderStage::Cursor, 1000000, 1002000);
+	profiler.AddPhaseTime(RenderStage::Floor, 1002000, 1010000);
+	profiler.AddPhaseTime(RenderStage::Cursor, 1010000, 1013000);
+	profiler.EndSample(1020000);
+
+	EXPECT_EQ(profiler.SampleDuration(0), 20000);
+	EXPECT_EQ(profiler.PhaseDuration(0, RenderStage::Floor), 8000);
+	EXPECT_EQ(profiler.PhaseDuration(0, RenderStage::Cursor), 5000);
+	EXPECT_EQ(profiler.PhaseDuration(0, RenderStage::Present), 0);
+	EXPECT_EQ(profiler.Stats(RenderStage::Present, 10).samples, 0);
+
+	std::stringstream csv;
+	profiler.WriteCsv(csv);
+	std::string header;
+	std::string line;
+	std::getline(csv, header);
+	std::getline(csv, line);
+	EXPECT_EQ(header, "start_us,total_us,Floor_us,Dungeon_us,Zoom_us,Automap_us,ItemLabels_us,Panels_us,Cursor_us,TextureUpload_us,Present_us");
+	EXPECT_EQ(line, "0,20,8,0,0,0,0,0,5,0,0");
+}
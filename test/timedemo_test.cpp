@@ -0,0 +1,51 @@
+#include <gtest/gtest.h>
+
+#include <sstream>
+
+#include "utils/timedemo.h"
+
+using namespace devilution;
+using namespace devilution::timedemo;
+
+TEST(Timedemo, Percentiles)
+{
+	std::vector<uint32_t> durations;
+	for (uint32_t i = 100; i >= 1; i--)
+		durations.push_back(i * 1000);
+
+	Percentiles percentiles = CalculatePercentiles(durations);
+	EXPECT_EQ(percentiles.samples, 100);
+	EXPECT_FLOAT_EQ(percentiles.p50, 50);
+	EXPECT_FLOAT_EQ(percentiles.p95, 95);
+	EXPECT_FLOAT_EQ(percentiles.p99, 99);
+	EXPECT_FLOAT_EQ(percentiles.max, 100);
+}
+
+TEST(Timedemo, PercentilesOfSingleSample)
+{
+	Percentiles percentiles = CalculatePercentiles({ 2500 });
+	EXPECT_EQ(percentiles.samples, 1);
+	EXPECT_FLOAT_EQ(percentiles.p50, 2.5F);
+	EXPECT_FLOAT_EQ(percentiles.p99, 2.5F);
+	EXPECT_FLOAT_EQ(percentiles.max, 2.5F);
+
+	EXPECT_EQ(CalculatePercentiles({}).samples, 0);
+}
+
+TEST(Timedemo, Json)
+{
+	Result result {};
+	result.demo = "demo_0.dmo";
+	result.version = "1.2.3";
+	result.ticks = 40;
+	result.frames = 100;
+	result.seconds = 2;
+	result.frameTime = CalculatePercentiles({ 10000, 20000 });
+	result.peakRss = 1234;
+
+	std::stringstream json;
+	WriteJson(json, result);
+	EXPECT_EQ(json.str(), "{\"demo\":\"demo_0.dmo\",\"version\":\"1.2.3\",\"ticks\":40,\"frames\":100,\"seconds\":2.000,\"fps\":50.0,"
+	                      "\"frame_ms\":{\"samples\":2,\"p50\":10.000,\"p95\":20.000,\"p99\":20.000,\"max\":20.000},"
+	                      "\"tick_ms\":{\"samples\":0,\"p50\":0.000,\"p95\":0.000,\"p99\":0.000,\"max\":0.000},\"peak_rss_kb\":1234}");
+}